@@ -0,0 +1,94 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include "Benchmark.h"
+#include <iostream>
+#include <utils/StopWatch.h>
+#include <utils/json/JsonArray.h>
+#include <utils/json/JsonObject.h>
+#include <version.h>
+
+using namespace rsp::utils;
+using namespace rsp::utils::json;
+
+namespace rsp::bench
+{
+
+void Benchmark::Run(const std::string &arName, int aWidth, int aHeight, int64_t aPixelsPerOp, const std::function<void()> &arFunction)
+{
+    measure(Result{arName, mLabel, aWidth, aHeight, 0, 0, 0, aPixelsPerOp}, arFunction);
+
+    const Result &r = mResults.back();
+    std::cerr << arName << (mLabel.empty() ? "" : " ") << mLabel << " " << aWidth << "x" << aHeight << ": "
+              << (static_cast<double>(r.mNanoSeconds) / static_cast<double>(r.mIterations)) << " ns/op" << std::endl;
+}
+
+void Benchmark::Run(const std::string &arName, int64_t aParameter, int64_t aPixelsPerOp, const std::function<void()> &arFunction)
+{
+    measure(Result{arName, mLabel, 0, 0, aParameter, 0, 0, aPixelsPerOp}, arFunction);
+
+    const Result &r = mResults.back();
+    std::cerr << arName << (mLabel.empty() ? "" : " ") << mLabel << " " << aParameter << ": "
+              << (static_cast<double>(r.mNanoSeconds) / static_cast<double>(r.mIterations)) << " ns/op" << std::endl;
+}
+
+void Benchmark::measure(Result aResult, const std::function<void()> &arFunction)
+{
+    const int64_t min_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mMinTime).count();
+
+    arFunction(); // Warm up caches and lazy initialization
+
+    int64_t iterations = 0;
+    int64_t batch = 1;
+    int64_t elapsed = 0;
+    while (elapsed < min_ns) {
+        StopWatch sw;
+        for (int64_t i = 0; i < batch; i++) {
+            arFunction();
+        }
+        elapsed += sw.Elapsed<std::chrono::nanoseconds>();
+        iterations += batch;
+        batch *= 2;
+    }
+
+    aResult.mIterations = iterations;
+    aResult.mNanoSeconds = elapsed;
+    mResults.push_back(std::move(aResult));
+}
+
+std::string Benchmark::ToJson() const
+{
+    JsonObject root;
+    root.Add("library", new JsonValue("rsp-core-lib"));
+    root.Add("version", new JsonValue(rsp::get_library_version()));
+    root.Add("min_time_ms", new JsonValue(static_cast<int64_t>(mMinTime.count())));
+
+    JsonArray *results = new JsonArray();
+    for (const Result &r : mResults) {
+        double ns_per_op = static_cast<double>(r.mNanoSeconds) / static_cast<double>(r.mIterations);
+
+        JsonObject *entry = new JsonObject();
+        entry->Add("name", new JsonValue(r.mName));
+        entry->Add("label", new JsonValue(r.mLabel));
+        entry->Add("width", new JsonValue(r.mWidth));
+        entry->Add("height", new JsonValue(r.mHeight));
+        entry->Add("parameter", new JsonValue(r.mParameter));
+        entry->Add("iterations", new JsonValue(r.mIterations));
+        entry->Add("ns_per_op", new JsonValue(ns_per_op));
+        entry->Add("pixels_per_op", new JsonValue(r.mPixelsPerOp));
+        entry->Add("pixels_per_sec", new JsonValue(static_cast<double>(r.mPixelsPerOp) * 1e9 / ns_per_op));
+        results->Add(entry);
+    }
+    root.Add("results", results);
+
+    return root.Encode(true);
+}
+
+} // namespace rsp::bench
@@ -0,0 +1,108 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef BENCH_BENCHMARK_H_
+#define BENCH_BENCHMARK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rsp::bench
+{
+
+/**
+ * \class Benchmark
+ * \brief Minimal timing harness for the rendering micro benchmarks.
+ *
+ * Each case is called repeatedly, in batches of doubling size, until the
+ * minimum run time is reached. The results can be encoded as JSON.
+ */
+class Benchmark
+{
+  public:
+    struct Result {
+        std::string mName;
+        std::string mLabel;
+        int mWidth;
+        int mHeight;
+        int64_t mParameter;     // Case specific setting, e.g. a font size, 0 if not relevant
+        int64_t mIterations;
+        int64_t mNanoSeconds;
+        int64_t mPixelsPerOp;
+    };
+
+    Benchmark(std::chrono::milliseconds aMinTime = std::chrono::milliseconds(200))
+        : mMinTime(aMinTime),
+          mLabel(),
+          mResults()
+    {
+    }
+
+    /**
+     * Time a benchmark case.
+     *
+     * \param arName Name of the case
+     * \param aWidth Width of the canvas used, 0 if not relevant
+     * \param aHeight Height of the canvas used, 0 if not relevant
+     * \param aPixelsPerOp Pixels touched by each call, 0 if not relevant
+     * \param arFunction The operation to measure
+     */
+    void Run(const std::string &arName, int aWidth, int aHeight, int64_t aPixelsPerOp, const std::function<void()> &arFunction);
+
+    /**
+     * Time a benchmark case that does not draw on a canvas.
+     *
+     * \param arName Name of the case
+     * \param aParameter Setting the case depends on, e.g. a font size
+     * \param aPixelsPerOp Pixels produced by each call, 0 if not relevant
+     * \param arFunction The operation to measure
+     */
+    void Run(const std::string &arName, int64_t aParameter, int64_t aPixelsPerOp, const std::function<void()> &arFunction);
+
+    /**
+     * Set a label stored with the following results, e.g. the pixel format used.
+     *
+     * \param arLabel
+     */
+    void SetLabel(const std::string &arLabel)
+    {
+        mLabel = arLabel;
+    }
+
+    /**
+     * Get all results in the order they were measured.
+     *
+     * \return vector of Result
+     */
+    const std::vector<Result>& GetResults() const
+    {
+        return mResults;
+    }
+
+    /**
+     * Encode the results as a JSON document.
+     *
+     * \return std::string
+     */
+    std::string ToJson() const;
+
+  protected:
+    std::chrono::milliseconds mMinTime;
+    std::string mLabel;
+    std::vector<Result> mResults;
+
+    void measure(Result aResult, const std::function<void()> &arFunction);
+};
+
+} // namespace rsp::bench
+
+#endif // BENCH_BENCHMARK_H_
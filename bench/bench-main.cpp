@@ -0,0 +1,286 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <graphics/MemoryCanvas.h>
+#include <graphics/primitives/Bitmap.h>
+#include <graphics/primitives/Font.h>
+#include <graphics/primitives/Text.h>
+#include <graphics/primitives/freetype/GlyphCache.h>
+#include <graphics/primitives/raster/BmpLoader.h>
+#include <graphics/primitives/raster/PngLoader.h>
+#include <graphics/primitives/raster/RawLoader.h>
+#include <graphics/kernels/TransformKernels.h>
+#include "Benchmark.h"
+
+using namespace rsp::graphics;
+using namespace rsp::bench;
+
+#ifndef BENCH_ASSET_DIR
+#define BENCH_ASSET_DIR "."
+#endif
+
+static const std::string cImageDir = BENCH_ASSET_DIR "/testImages/";
+static const char *cFontFile = BENCH_ASSET_DIR "/fonts/Exo2-VariableFont_wght.ttf";
+static const char *cFontName = "Exo 2";
+static const char *cText = "The quick brown fox jumps over the lazy dog 0123456789";
+
+static void canvasBenchmarks(Benchmark &arBench, int aWidth, int aHeight, BufferedCanvas::PixelFormats aFormat)
+{
+    const Color color(0x20, 0x80, 0xE0, 0xFF);
+    MemoryCanvas canvas(aWidth, aHeight, 0, aFormat);
+    canvas.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color::Black);
+
+    arBench.Run("DrawLine", aWidth, aHeight, std::max(aWidth, aHeight), [&]() {
+        canvas.DrawLine(Point(0, 0), Point(aWidth - 1, aHeight - 1), color);
+    });
+
+    const Rect rect(aWidth / 4, aHeight / 4, aWidth / 2, aHeight / 2);
+    arBench.Run("DrawRectangle filled", aWidth, aHeight, int64_t(rect.GetWidth() + 1) * (rect.GetHeight() + 1), [&]() {
+        canvas.DrawRectangle(rect, color, true);
+    });
+    arBench.Run("DrawRectangle outline", aWidth, aHeight, 2 * (rect.GetWidth() + rect.GetHeight() + 2), [&]() {
+        canvas.DrawRectangle(rect, color, false);
+    });
+
+    // The midpoint algorithm sets about 4 * sqrt(2) * radius pixels
+    const int radius = std::min(aWidth, aHeight) / 3;
+    arBench.Run("DrawCircle", aWidth, aHeight, radius * 5657 / 1000, [&]() {
+        canvas.DrawCircle(Point(aWidth / 2, aHeight / 2), radius, color);
+    });
+
+    for (const char *name : { "testImage.bmp", "Asset3.bmp" }) {
+        Bitmap bitmap(cImageDir + name);
+        int64_t pixels = int64_t(std::min(aWidth, bitmap.GetWidth())) * std::min(aHeight, bitmap.GetHeight());
+        arBench.Run(std::string("DrawImage ") + name, aWidth, aHeight, pixels, [&]() {
+            canvas.DrawImage(Point(0, 0), bitmap);
+        });
+    }
+
+    Text text(cFontName, cText);
+    text.GetFont().SetSize(std::max(12, aHeight / 20));
+    text.SetArea(Rect(0, 0, aWidth, aHeight)).Reload();
+    int64_t text_pixels = 0;
+    for (const Glyph &glyph : text.GetGlyphs()) {
+        text_pixels += int64_t(glyph.mWidth) * glyph.mHeight;
+    }
+    arBench.Run("DrawText", aWidth, aHeight, text_pixels, [&]() {
+        canvas.DrawText(text, color);
+    });
+    text.SetCached().Reload();
+    arBench.Run("DrawText cached", aWidth, aHeight, text_pixels, [&]() {
+        canvas.DrawText(text, color);
+    });
+
+    const int64_t screen = int64_t(aWidth) * aHeight;
+    const Rect all(0, 0, aWidth, aHeight);
+    arBench.Run("SwapBuffer NoOp", aWidth, aHeight, 0, [&]() {
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::NoOp);
+    });
+    arBench.Run("SwapBuffer Clear", aWidth, aHeight, screen, [&]() {
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Clear, color);
+    });
+    // A full screen dirty region forces the copy of the entire buffer
+    arBench.Run("SwapBuffer Copy", aWidth, aHeight, screen, [&]() {
+        canvas.Invalidate(all);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+    });
+    arBench.Run("SwapBuffer Copy dirty 1/16", aWidth, aHeight, screen / 16, [&]() {
+        canvas.Invalidate(Rect(0, 0, aWidth / 4, aHeight / 4));
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+    });
+}
+
+static void loaderBenchmarks(Benchmark &arBench)
+{
+    for (const char *name : { "testImage.bmp", "Asset3.bmp", "Asset2WithAlpha.bmp" }) {
+        Bitmap bitmap(cImageDir + name);
+        BmpLoader loader;
+        std::vector<uint32_t> pixels;
+        arBench.Run(std::string("BmpLoader::LoadImg ") + name, bitmap.GetWidth(), bitmap.GetHeight(),
+            int64_t(bitmap.GetWidth()) * bitmap.GetHeight(), [&]() {
+                loader.LoadImg(cImageDir + name, pixels);
+            });
+    }
+
+    Bitmap png(cImageDir + "testImage.png");
+    PngLoader png_loader;
+    std::vector<uint32_t> png_pixels;
+    arBench.Run("PngLoader::LoadImg testImage.png", png.GetWidth(), png.GetHeight(),
+        int64_t(png.GetWidth()) * png.GetHeight(), [&]() {
+            png_loader.LoadImg(cImageDir + "testImage.png", png_pixels);
+        });
+
+    // Raw assets are mapped, and only verified against their CRC
+    const std::string raw_name = (std::filesystem::temp_directory_path() / "bench-Asset3.raw").string();
+    Bitmap asset(cImageDir + "Asset3.bmp");
+    RawLoader::Save(raw_name, asset.GetPixels().data(), asset.GetWidth(), asset.GetHeight());
+    RawLoader raw_loader;
+    arBench.Run("RawLoader::MapImg Asset3.raw", asset.GetWidth(), asset.GetHeight(),
+        int64_t(asset.GetWidth()) * asset.GetHeight(), [&]() {
+            raw_loader.MapImg(raw_name);
+        });
+    std::filesystem::remove(raw_name);
+
+    // Later loads of the same file share the pixels decoded by the first
+    Bitmap cached(cImageDir + "Asset3.bmp");
+    arBench.Run("Bitmap cached Asset3.bmp", cached.GetWidth(), cached.GetHeight(),
+        int64_t(cached.GetWidth()) * cached.GetHeight(), [&]() {
+            Bitmap bitmap(cImageDir + "Asset3.bmp");
+        });
+}
+
+static void transformBenchmarks(Benchmark &arBench)
+{
+    Bitmap asset(cImageDir + "Asset3.bmp");
+    int width = asset.GetWidth();
+    int height = asset.GetHeight();
+
+    for (auto method : { std::make_pair("nearest", Canvas::ScaleMethods::Nearest),
+                         std::make_pair("bilinear", Canvas::ScaleMethods::Bilinear) }) {
+        for (int percent : { 50, 150 }) {
+            int w = width * percent / 100;
+            int h = height * percent / 100;
+            arBench.Run(std::string("Bitmap::Scale ") + method.first + " " + std::to_string(percent) + "%", w, h,
+                int64_t(w) * h, [&]() {
+                    asset.Scale(w, h, method.second);
+                });
+        }
+    }
+
+    for (auto rotation : { std::make_pair("90", Canvas::Rotations::Clockwise90),
+                           std::make_pair("180", Canvas::Rotations::Clockwise180) }) {
+        arBench.Run(std::string("Bitmap::Rotate ") + rotation.first, width, height,
+            int64_t(width) * height, [&]() {
+                asset.Rotate(rotation.second);
+            });
+    }
+
+    // Presentation on a rotated display, without allocation
+    std::vector<uint32_t> display(asset.GetPixels().size());
+    for (unsigned turns : { 1u, 2u, 3u }) {
+        arBench.Run("TransformKernels::Rotate " + std::to_string(turns * 90), width, height,
+            int64_t(width) * height, [&]() {
+                TransformKernels::Rotate(display.data(), std::size_t(turns == 2 ? width : height), asset.GetPixels().data(),
+                    std::size_t(width), std::size_t(width), std::size_t(height), turns);
+            });
+    }
+}
+
+static void fontBenchmarks(Benchmark &arBench)
+{
+    for (int size : { 16, 48 }) {
+        Font font(cFontName);
+        font.SetSize(size);
+        int64_t glyph_pixels = 0;
+        for (const Glyph &glyph : font.MeasureGlyphs(cText)) {
+            glyph_pixels += int64_t(glyph.mWidth) * glyph.mHeight;
+        }
+
+        arBench.Run("Font::MakeGlyphs cached", size, glyph_pixels, [&]() {
+            font.MakeGlyphs(cText);
+        });
+        arBench.Run("Font::MakeGlyphs uncached", size, glyph_pixels, [&]() {
+            GlyphCache::Get().Clear();
+            font.MakeGlyphs(cText);
+        });
+    }
+}
+
+static bool parseFormat(const std::string &arValue, std::vector<std::pair<std::string, BufferedCanvas::PixelFormats>> &arFormats)
+{
+    for (auto &format : { std::make_pair(std::string("XRGB8888"), BufferedCanvas::PixelFormats::XRGB8888),
+                          std::make_pair(std::string("RGB888"), BufferedCanvas::PixelFormats::RGB888),
+                          std::make_pair(std::string("RGB565"), BufferedCanvas::PixelFormats::RGB565) }) {
+        if (format.first == arValue) {
+            arFormats.push_back(format);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseSize(const std::string &arValue, std::vector<std::pair<int, int>> &arSizes)
+{
+    std::size_t pos = arValue.find('x');
+    if (pos == std::string::npos) {
+        return false;
+    }
+    int w = std::atoi(arValue.substr(0, pos).c_str());
+    int h = std::atoi(arValue.substr(pos + 1).c_str());
+    if ((w <= 0) || (h <= 0)) {
+        return false;
+    }
+    arSizes.emplace_back(w, h);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::pair<int, int>> sizes;
+    std::vector<std::pair<std::string, BufferedCanvas::PixelFormats>> formats;
+    std::string output;
+    int min_time = 200;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if ((arg == "--size") && (i + 1 < argc) && parseSize(argv[i + 1], sizes)) {
+            i++;
+        }
+        else if ((arg == "--format") && (i + 1 < argc) && parseFormat(argv[i + 1], formats)) {
+            i++;
+        }
+        else if ((arg == "--min-time") && (i + 1 < argc)) {
+            min_time = std::max(1, std::atoi(argv[++i]));
+        }
+        else if ((arg == "--output") && (i + 1 < argc)) {
+            output = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--size WxH]... [--format XRGB8888|RGB888|RGB565]... [--min-time ms] [--output file.json]" << std::endl;
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes = { {320, 240}, {800, 480}, {1920, 1080} };
+    }
+    if (formats.empty()) {
+        parseFormat("XRGB8888", formats);
+    }
+
+    Font::RegisterFont(cFontFile);
+    Benchmark bench{std::chrono::milliseconds(min_time)};
+
+    for (auto &format : formats) {
+        bench.SetLabel(format.first);
+        for (auto &size : sizes) {
+            canvasBenchmarks(bench, size.first, size.second, format.second);
+        }
+    }
+    bench.SetLabel("");
+    loaderBenchmarks(bench);
+    transformBenchmarks(bench);
+    fontBenchmarks(bench);
+
+    if (output.empty()) {
+        std::cout << bench.ToJson() << std::endl;
+    }
+    else {
+        std::ofstream(output) << bench.ToJson() << std::endl;
+    }
+
+    return 0;
+}
@@ -10,18 +10,33 @@
 #ifndef BUFFEREDCANVAS_H
 #define BUFFEREDCANVAS_H
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include "graphics/DirtyRegion.h"
+#include "graphics/FrameStatistics.h"
 #include "graphics/primitives/Canvas.h"
 
 namespace rsp::graphics
 {
+namespace PixelKernels {
+struct Table;
+}
+
 /**
  * BufferedCanvas interface class
  *
  * Abstract class with function declarations for buffering operations.
+ * Implements the pixel operations on two equally sized buffers in one of
+ * the supported pixel formats, where rows are mStride bytes apart.
  */
 class BufferedCanvas : public Canvas
 {
   public:
+    BufferedCanvas();
+    BufferedCanvas(const BufferedCanvas &) = delete;
+    BufferedCanvas& operator=(const BufferedCanvas &) = delete;
     virtual ~BufferedCanvas()
     {
     }
@@ -31,7 +46,8 @@ class BufferedCanvas : public Canvas
      * In case of double buffer support, these values can control
      * the content of the new buffer:
      *  NoOp:  No initialization of the buffer is performed
-     *  Copy:  The current view content is copied int new buffer
+     *  Copy:  The current view content is copied int new buffer,
+     *         only the dirty region is copied if the buffers were in sync
      *  Clear: The new buffer is filled with the background color.
      */
     enum class SwapOperations {
@@ -41,12 +57,145 @@ class BufferedCanvas : public Canvas
     };
     virtual void SwapBuffer(const SwapOperations aSwapOp = SwapOperations::Copy, Color aColor = Color::Black) = 0;
 
-  protected:
-    virtual void clear(Color aColor) = 0;
-    virtual void copy() = 0;
+    /**
+     * Enumerated PixelFormats
+     *
+     * Memory layout of the pixels in the buffers, named from the most
+     * significant bit of the little endian pixel value:
+     *  XRGB8888: 32 bit pixels, the top byte is not used by the display
+     *  RGB888:   24 bit pixels, 3 bytes without padding
+     *  RGB565:   16 bit pixels
+     */
+    enum class PixelFormats {
+        XRGB8888,
+        RGB888,
+        RGB565
+    };
+
+    PixelFormats GetPixelFormat() const
+    {
+        return mPixelFormat;
+    }
+
+    void SetPixel(const Point &aPoint, const Color aColor) override;
+
+    uint32_t GetPixel(const Point &aPoint, const bool aFront = false) const override;
+
+    /**
+     * Add the given area, clipped to the canvas, to the dirty region.
+     *
+     * \param arRect
+     */
+    void Invalidate(const Rect &arRect) override
+    {
+        mDirtyRegion.Add(arRect.Intersection(Rect(0, 0, mWidth, mHeight)));
+    }
+
+    /**
+     * Get the areas modified since the last buffer swap.
+     * Can be used to adjust the merge threshold of the region.
+     *
+     * \return Reference to DirtyRegion
+     */
+    DirtyRegion& GetDirtyRegion()
+    {
+        return mDirtyRegion;
+    }
+
+    /**
+     * Start or stop recording the timing and size of each frame.
+     * Statistics recorded so far are kept when disabled, and dropped when enabled again.
+     * Must be called from the thread swapping the buffers.
+     *
+     * \param aEnable
+     */
+    void EnableFrameStatistics(bool aEnable = true);
+
+    bool IsFrameStatisticsEnabled() const
+    {
+        return mFrameStatisticsEnabled;
+    }
 
+    /**
+     * Get the frame statistics, can be queried from any thread.
+     * The object lives as long as the canvas, also while recording is disabled.
+     *
+     * \return Reference to FrameStatistics
+     */
+    const FrameStatistics& GetFrameStatistics() const
+    {
+        return mFrameStatistics;
+    }
+
+  protected:
     uint8_t *mpFrontBuffer = nullptr;
     uint8_t *mpBackBuffer = nullptr;
+    std::size_t mStride = 0; // Bytes from one row to the next
+    DirtyRegion mDirtyRegion{};
+    bool mBuffersInSync = false;
+    PixelFormats mPixelFormat = PixelFormats::XRGB8888;
+    const PixelKernels::Table *mpPixelKernels = nullptr;
+    FrameStatistics mFrameStatistics{};
+    std::atomic<bool> mFrameStatisticsEnabled{false};
+    uint64_t mPixelsTouched = 0; // Pixels written to the back buffer in this frame
+    std::chrono::steady_clock::time_point mFrameStart{};
+    std::chrono::steady_clock::time_point mSwapStart{};
+    uint64_t mSwapDirtyArea = 0;
+
+    inline uint8_t* pixelAddress(uint8_t *apBuffer, int aX, int aY) const
+    {
+        return apBuffer + static_cast<long>(aX) * mBytesPerPixel + static_cast<long>(aY) * static_cast<long>(mStride);
+    }
+
+    /**
+     * Mark the start of a buffer swap for the frame statistics.
+     * Must be called first thing in SwapBuffer, the swap ends with prepareBackBuffer.
+     */
+    void beginSwap();
+
+    /**
+     * Initialize the back buffer after the buffers have been swapped,
+     * according to the swap operation.
+     *
+     * \param aSwapOp
+     * \param aColor
+     */
+    void prepareBackBuffer(SwapOperations aSwapOp, Color aColor);
+
+    /**
+     * Select the pixel format of the buffers. Must be called before
+     * anything is drawn, as it also sets mBytesPerPixel.
+     *
+     * \param aFormat
+     */
+    void setPixelFormat(PixelFormats aFormat);
+
+    /**
+     * Let this canvas draw into the back buffer of another canvas,
+     * e.g. to render parts of it from several threads with separate
+     * clip areas. Must be called again after every buffer swap.
+     *
+     * \param arOther
+     */
+    void shareBackBuffer(const BufferedCanvas &arOther);
+
+    /**
+     * Move the pixels written by this canvas to the frame statistics of
+     * the canvas whose back buffer it shares, and reset the count here.
+     *
+     * \param arOther
+     */
+    void forwardPixelsTouched(BufferedCanvas &arOther);
+
+    virtual void clear(Color aColor);
+    virtual void copy();
+    virtual void copyRect(const Rect &arRect);
+    void fillPixel(int aX, int aY, const Color &arColor) override;
+    void blitRow(int aX, int aY, const uint32_t *apPixels, int aLength) override;
+    void fillHSpan(int aX, int aY, int aLength, const Color &arColor) override;
+    void fillVSpan(int aX, int aY, int aLength, const Color &arColor) override;
+    void blendMaskRow(int aX, int aY, const uint8_t *apCoverage, int aLength, const Color &arColor) override;
+    void plotLine(const Raster::Line &arLine, const Color &arColor) override;
 };
 
 } // namespace rsp::graphics
@@ -0,0 +1,97 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef DIRTYREGION_H
+#define DIRTYREGION_H
+
+#include <vector>
+#include "graphics/primitives/Rect.h"
+
+namespace rsp::graphics
+{
+
+/**
+ * \class DirtyRegion
+ * \brief Collection of rectangles covering the areas modified since last buffer swap.
+ *
+ * Rectangles are merged when the merged result costs at most MergeThreshold
+ * pixels more than the two rectangles on their own. If more than MaxRects
+ * rectangles are collected, the region collapses into its bounding rectangle.
+ */
+class DirtyRegion
+{
+  public:
+    static constexpr int cDefaultMergeThreshold = 1024;
+    static constexpr std::size_t cDefaultMaxRects = 16;
+
+    DirtyRegion(int aMergeThreshold = cDefaultMergeThreshold, std::size_t aMaxRects = cDefaultMaxRects);
+
+    /**
+     * Add a rectangle to the region.
+     *
+     * \param arRect
+     */
+    void Add(const Rect &arRect);
+
+    /**
+     * Remove all rectangles from the region.
+     */
+    void Clear();
+
+    /**
+     * Check if region contains any modified pixels.
+     *
+     * \return bool
+     */
+    bool IsEmpty() const { return mRects.empty(); }
+
+    /**
+     * Get the list of rectangles in the region.
+     * Rectangles that could not be merged may still overlap.
+     *
+     * \return const reference to vector of Rect
+     */
+    const std::vector<Rect>& GetRects() const { return mRects; }
+
+    /**
+     * Get the bounding rectangle of the entire region.
+     *
+     * \return Rect
+     */
+    Rect GetBoundingRect() const;
+
+    /**
+     * Get the number of pixels covered by the rectangles in the region.
+     *
+     * \return int
+     */
+    int GetArea() const;
+
+    /**
+     * Get the number of extra pixels allowed when merging two rectangles.
+     *
+     * \return int
+     */
+    int GetMergeThreshold() const { return mMergeThreshold; }
+    /**
+     * Set the number of extra pixels allowed when merging two rectangles.
+     *
+     * \param aPixels
+     * \return Reference to this for fluent calls.
+     */
+    DirtyRegion& SetMergeThreshold(int aPixels) { mMergeThreshold = aPixels; return *this; }
+
+  protected:
+    std::vector<Rect> mRects{};
+    int mMergeThreshold;
+    std::size_t mMaxRects;
+};
+
+} // namespace rsp::graphics
+#endif // DIRTYREGION_H
@@ -0,0 +1,146 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef DISPLAYLIST_H
+#define DISPLAYLIST_H
+
+#include <cstdint>
+#include <vector>
+#include "graphics/DirtyRegion.h"
+#include "graphics/primitives/Canvas.h"
+
+namespace rsp::graphics
+{
+
+/**
+ * \class DisplayList
+ * \brief Recording of drawing operations that can be replayed on any canvas.
+ *
+ * Operations are stored as small plain commands with the area they affect,
+ * so a static screen can be recorded once and replayed cheaply, and the
+ * damage of a frame can be found without drawing it.
+ *
+ * Bitmaps and texts are recorded by reference, they must outlive the list.
+ */
+class DisplayList
+{
+  public:
+    enum class Operations : uint8_t {
+        Line,
+        Circle,
+        Rectangle,
+        FilledRectangle,
+        Image,
+        Text
+    };
+
+    /**
+     * Recorded operation. The affected area is Left, Top, Right, Bottom with
+     * right and bottom exclusive. The arguments depend on the operation:
+     *  - Line: from A,B to C,D
+     *  - Circle: center A,B with radius C
+     *  - Image: source rectangle top left A,B, size and destination is the area
+     *  - Rectangle and FilledRectangle use the area only
+     */
+    struct Command {
+        int32_t mLeft;
+        int32_t mTop;
+        int32_t mRight;
+        int32_t mBottom;
+        int32_t mA;
+        int32_t mB;
+        int32_t mC;
+        int32_t mD;
+        uint32_t mColor;
+        uint32_t mResource;
+        Operations mOperation;
+        Canvas::BlendModes mBlendMode;
+    };
+
+    /**
+     * Set the blend mode used by the following operations.
+     *
+     * \param aMode
+     */
+    void SetBlendMode(Canvas::BlendModes aMode)
+    {
+        mBlendMode = aMode;
+    }
+
+    void DrawCircle(const Point &arCenter, int aRadius, const Color &arColor);
+    void DrawLine(const Point &arA, const Point &arB, const Color &arColor);
+    void DrawRectangle(const Rect &arRect, const Color &arColor, bool aFilled = false);
+    void DrawImage(const Point &arLeftTop, const Bitmap &arBitmap);
+    void DrawImage(const Point &arLeftTop, const Bitmap &arBitmap, const Rect &arSourceRect);
+    void DrawText(const Text &arText, const Color &arColor);
+
+    /**
+     * Draw all recorded operations on the given canvas in recorded order.
+     * The blend mode of the canvas is restored afterwards.
+     *
+     * \param arCanvas
+     */
+    void Replay(Canvas &arCanvas) const;
+
+    /**
+     * Rewrite the list into fewer operations with the same result:
+     *  - Operations fully covered by a later opaque fill or copied image are dropped
+     *  - Consecutive fills of the same color sharing an edge are merged
+     *  - Images are moved next to earlier draws of the same bitmap, when
+     *    nothing in between overlaps them
+     */
+    void Optimize();
+
+    /**
+     * Add the areas affected by the recorded operations to the region.
+     *
+     * \param arRegion
+     */
+    void AddDamage(DirtyRegion &arRegion) const;
+
+    /**
+     * Drop all recorded operations.
+     */
+    void Clear();
+
+    /**
+     * Get the recorded operations.
+     *
+     * \return const reference to vector of Command
+     */
+    const std::vector<Command>& GetCommands() const
+    {
+        return mCommands;
+    }
+
+    /**
+     * Get the number of recorded operations.
+     *
+     * \return std::size_t
+     */
+    std::size_t GetCommandCount() const
+    {
+        return mCommands.size();
+    }
+
+  protected:
+    Canvas::BlendModes mBlendMode = Canvas::BlendModes::Copy;
+    std::vector<Command> mCommands{};
+    std::vector<const Bitmap*> mBitmaps{};
+    std::vector<const Text*> mTexts{};
+
+    void record(Operations aOperation, const Rect &arArea, const Color &arColor,
+        int32_t aA = 0, int32_t aB = 0, int32_t aC = 0, int32_t aD = 0, uint32_t aResource = 0);
+    void cullCovered();
+    void mergeFills();
+    void groupImages();
+};
+
+} // namespace rsp::graphics
+#endif // DISPLAYLIST_H
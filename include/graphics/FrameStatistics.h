@@ -0,0 +1,153 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rsp::graphics
+{
+
+/**
+ * \class FrameStatistics
+ * \brief Timing and size of the frames drawn on a canvas.
+ *
+ * The canvas records one entry per buffer swap from the render thread.
+ * All queries are lock free and can be made from any thread while
+ * frames are recorded, e.g. by a diagnostics service.
+ *
+ * Times are kept in log linear histograms with 16 buckets per power of
+ * two, so percentiles are within 1/16 of the true value. The most recent
+ * frames are kept in a ring buffer as well.
+ */
+class FrameStatistics
+{
+  public:
+    static constexpr std::size_t cRecentFrames = 256;
+
+    /**
+     * Measurements of one frame. Times are in microseconds.
+     */
+    struct Frame {
+        uint64_t mNumber;
+        uint64_t mDrawTime;     // From the end of the previous swap to the start of this one
+        uint64_t mSwapTime;     // Duration of the buffer swap
+        uint64_t mPixels;       // Number of pixels written to the back buffer
+        uint64_t mDirtyArea;    // Number of pixels in the dirty region
+    };
+
+    enum class Timings {
+        Draw,
+        Swap,
+        Frame  // Draw and swap
+    };
+
+    struct Summary {
+        uint64_t mCount;
+        uint64_t mP50;
+        uint64_t mP95;
+        uint64_t mP99;
+        uint64_t mMax;
+    };
+
+    FrameStatistics() = default;
+    FrameStatistics(const FrameStatistics &) = delete;
+    FrameStatistics& operator=(const FrameStatistics &) = delete;
+
+    /**
+     * Record a frame. Must only be called from one thread.
+     * The frame number is assigned by this call.
+     *
+     * \param arFrame
+     */
+    void Record(const Frame &arFrame);
+
+    /**
+     * Get the number of frames recorded since the last reset.
+     *
+     * \return uint64_t
+     */
+    uint64_t GetFrameCount() const;
+
+    /**
+     * Get the time below which the given fraction of the frames fall.
+     *
+     * \param aTiming Which time to look at
+     * \param aFraction Value from 0.0 to 1.0, e.g. 0.99 for the 99th percentile
+     * \return uint64_t Time in microseconds, 0 if no frames are recorded
+     */
+    uint64_t GetPercentile(Timings aTiming, double aFraction) const;
+
+    /**
+     * Get the most common percentiles and the maximum for a time.
+     *
+     * \param aTiming
+     * \return Summary
+     */
+    Summary GetSummary(Timings aTiming) const;
+
+    /**
+     * Get the most recent frames, oldest first.
+     *
+     * \return vector of Frame
+     */
+    std::vector<Frame> GetRecentFrames() const;
+
+    /**
+     * Encode the summaries and the recent frames as a JSON document.
+     *
+     * \param aPrettyPrint
+     * \return std::string
+     */
+    std::string ToJson(bool aPrettyPrint = false) const;
+
+    /**
+     * Forget all recorded frames. Should not be called while frames are recorded.
+     */
+    void Reset();
+
+  protected:
+    static constexpr unsigned cSubBucketBits = 4;
+    static constexpr unsigned cSubBuckets = 1u << cSubBucketBits;
+    static constexpr unsigned cMaxExponent = 39; // About 6 days in microseconds
+    static constexpr std::size_t cBuckets = (cMaxExponent - cSubBucketBits + 2) * cSubBuckets;
+
+    struct Histogram {
+        std::array<std::atomic<uint64_t>, cBuckets> mCounts{};
+        std::atomic<uint64_t> mCount{0};
+        std::atomic<uint64_t> mMax{0};
+
+        void Add(uint64_t aValue);
+        uint64_t GetPercentile(double aFraction) const;
+        void Reset();
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> mNumber{0};
+        std::atomic<uint64_t> mDrawTime{0};
+        std::atomic<uint64_t> mSwapTime{0};
+        std::atomic<uint64_t> mPixels{0};
+        std::atomic<uint64_t> mDirtyArea{0};
+    };
+
+    std::array<Histogram, 3> mHistograms{};
+    std::array<Slot, cRecentFrames> mRing{};
+    std::atomic<uint64_t> mWritten{0};
+
+    static std::size_t bucketIndex(uint64_t aValue);
+    static uint64_t bucketHighest(std::size_t aIndex);
+};
+
+} // namespace rsp::graphics
+#endif // FRAMESTATISTICS_H
@@ -10,7 +10,13 @@
 #ifndef FRAMEBUFFERCANVAS_H
 #define FRAMEBUFFERCANVAS_H
 
+#include <array>
+#include <condition_variable>
+#include <cstdint>
 #include <linux/fb.h>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "graphics/BufferedCanvas.h"
 #include "graphics/primitives/Canvas.h"
@@ -21,30 +27,93 @@ namespace rsp::graphics
 class Framebuffer : public BufferedCanvas
 {
   public:
-    Framebuffer(const char *apDevPath = nullptr);
+    /**
+     * Enumerated PresentModes
+     *
+     * How finished frames are brought to the display:
+     *  Synchronous: Two buffers, SwapBuffer pans the display itself.
+     *  Threaded:    Three buffers, a presenter thread pans to the newest
+     *               finished frame, so SwapBuffer does not wait for the
+     *               display. A finished frame that was not shown before
+     *               the next one is finished, is skipped.
+     */
+    enum class PresentModes {
+        Synchronous,
+        Threaded
+    };
+
+    /**
+     * Open a framebuffer device.
+     *
+     * With a rotation, the canvas is the logical screen as the user sees it,
+     * e.g. portrait on a landscape panel. It is drawn in two XRGB8888 buffers
+     * in memory, and SwapBuffer writes the areas changed since each display
+     * buffer was last written, rotated and converted to the display format.
+     *
+     * \param apDevPath Path of the device, /dev/fb0 is used if not given or if it can not be opened
+     * \param aPresentMode How frames are presented
+     * \param aWaitForVSync Wait for vertical sync after panning. Synchronous mode waits inside SwapBuffer,
+     *                      Threaded mode waits in the presenter thread so SwapBuffer does not block on it.
+     * \param aRotation Clockwise rotation of the canvas content on the display
+     */
+    Framebuffer(const char *apDevPath = nullptr, PresentModes aPresentMode = PresentModes::Synchronous, bool aWaitForVSync = false,
+        Rotations aRotation = Rotations::None);
     virtual ~Framebuffer();
 
-    inline void SetPixel(const Point &aPoint, const Color aColor)
+    void SwapBuffer(const SwapOperations aSwapOp = SwapOperations::Copy, Color aColor = Color::Black) override;
+
+    PresentModes GetPresentMode() const
     {
-        if (!IsInsideScreen(aPoint)) {
-            return;
-        }
-        long location = (aPoint.mX + static_cast<int>(mVariableInfo.xoffset)) * (static_cast<int>(mVariableInfo.bits_per_pixel) / 8) + aPoint.mY * static_cast<int>(mFixedInfo.line_length);
-        *(reinterpret_cast<uint32_t *>(mpBackBuffer + location)) = aColor;
+        return mPresentMode;
     }
 
-    uint32_t GetPixel(const Point &aPoint, const bool aFront = false) const;
-
-    void SwapBuffer(const SwapOperations aSwapOp = SwapOperations::Copy, Color aColor = Color::Black);
+    Rotations GetRotation() const
+    {
+        return mRotation;
+    }
 
   protected:
+    static constexpr int cNoBuffer = -1;
+
     int mFramebufferFile;
     int mTtyFb = 0;
     struct fb_fix_screeninfo mFixedInfo {};
     struct fb_var_screeninfo mVariableInfo {};
 
-    void clear(Color aColor);
-    void copy();
+    PresentModes mPresentMode;
+    bool mWaitForVSync;
+    std::array<uint8_t*, 3> mBuffers{};
+    std::array<uint64_t, 3> mBufferFrames{}; // Number of the frame held by each buffer
+    uint64_t mFrame = 0;
+    int mBackIndex = 1;
+    DirtyRegion mPreviousDirtyRegion{};
+    bool mPreviousInSync = false;
+
+    // Presenter thread state, guarded by mMutex
+    std::thread mPresenter{};
+    std::mutex mMutex{};
+    std::condition_variable mWake{};
+    std::condition_variable mPresented{};
+    int mPending = cNoBuffer;
+    int mPresenting = cNoBuffer;
+    int mDisplayed = 0;
+    bool mStop = false;
+
+    // Rotated presentation
+    Rotations mRotation;
+    PixelFormats mDisplayFormat = PixelFormats::XRGB8888;
+    std::size_t mDisplayStride = 0;
+    std::vector<uint32_t> mLogicalPixels{};       // Front and back buffer of the canvas
+    std::array<DirtyRegion, 3> mStaleRegions{};   // Areas of each display buffer not showing the back buffer
+    std::vector<uint32_t> mRotatedPixels{};       // Strip of rotated pixels, for display formats other than XRGB8888
+
+    void pan(int aIndex);
+    void presenterLoop();
+    void swapThreaded(SwapOperations aSwapOp, Color aColor);
+    void selectBuffers(int aFront, int aBack);
+    void presentRotated(int aIndex);
+    void rotateRect(const Rect &arRect, uint8_t *apDisplay);
+    Rect displayRect(const Rect &arRect) const;
 };
 
 } // namespace rsp::graphics
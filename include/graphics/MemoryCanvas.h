@@ -0,0 +1,80 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef MEMORYCANVAS_H
+#define MEMORYCANVAS_H
+
+#include <string>
+#include <vector>
+#include "graphics/BufferedCanvas.h"
+
+namespace rsp::graphics
+{
+
+/**
+ * \class MemoryCanvas
+ * \brief Double buffered canvas in heap memory, without any display hardware.
+ *
+ * Behaves like the Framebuffer, so the full render pipeline can run on
+ * machines without a framebuffer device, e.g. for tests and benchmarks.
+ * Every presented frame can optionally be written to a BMP file.
+ */
+class MemoryCanvas : public BufferedCanvas
+{
+  public:
+    /**
+     * Construct a canvas of the given size.
+     *
+     * \param aWidth
+     * \param aHeight
+     * \param aStride Bytes from one row to the next, 0 for the smallest multiple of 4 bytes
+     * \param aFormat Pixel format of the buffers
+     */
+    MemoryCanvas(int aWidth, int aHeight, std::size_t aStride = 0, PixelFormats aFormat = PixelFormats::XRGB8888);
+
+    void SwapBuffer(const SwapOperations aSwapOp = SwapOperations::Copy, Color aColor = Color::Black) override;
+
+    /**
+     * Write each presented frame to a BMP file.
+     * The file name is formatted with the frame number, e.g. "frame%04d.bmp".
+     * An empty string stops the dumping.
+     *
+     * \param arFileNamePattern
+     */
+    void SetFrameDump(const std::string &arFileNamePattern)
+    {
+        mFrameDumpPattern = arFileNamePattern;
+    }
+
+    /**
+     * Get the number of frames presented by SwapBuffer.
+     *
+     * \return int
+     */
+    int GetFrameCount() const
+    {
+        return mFrameCount;
+    }
+
+    /**
+     * Write the content of a buffer to a 24 bit BMP file.
+     *
+     * \param arFileName
+     * \param aFront Set to write the front buffer, otherwise the back buffer
+     */
+    void SaveBmp(const std::string &arFileName, bool aFront = true) const;
+
+  protected:
+    std::vector<uint8_t> mBuffers;
+    std::string mFrameDumpPattern{};
+    int mFrameCount = 0;
+};
+
+} // namespace rsp::graphics
+#endif // MEMORYCANVAS_H
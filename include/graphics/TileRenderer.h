@@ -0,0 +1,153 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef TILERENDERER_H
+#define TILERENDERER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "graphics/BufferedCanvas.h"
+
+namespace rsp::graphics
+{
+
+/**
+ * \class TileRenderer
+ * \brief Records drawing operations and rasterizes them tile by tile on a pool of threads.
+ *
+ * The drawing operations are recorded instead of executed. Render bins
+ * them by the screen tiles they touch, and the tiles are then drawn in
+ * parallel, each thread clipped to the tile it works on. Operations are
+ * drawn in recorded order within each tile, so the result is the same as
+ * drawing directly on the canvas.
+ *
+ * Bitmaps and texts are recorded by reference, they must stay unchanged
+ * until Render returns.
+ */
+class TileRenderer
+{
+  public:
+    static constexpr int cDefaultTileSize = 64;
+
+    /**
+     * Create a renderer for the given canvas.
+     *
+     * \param arCanvas Canvas to render into
+     * \param aWorkers Number of worker threads, the calling thread also renders. 0 renders on the calling thread only.
+     * \param aTileSize Width and height of the tiles in pixels
+     */
+    TileRenderer(BufferedCanvas &arCanvas, unsigned aWorkers = GetDefaultWorkerCount(), int aTileSize = cDefaultTileSize);
+    ~TileRenderer();
+
+    TileRenderer(const TileRenderer &) = delete;
+    TileRenderer& operator=(const TileRenderer &) = delete;
+
+    /**
+     * Set the blend mode used by the following operations.
+     *
+     * \param aMode
+     */
+    void SetBlendMode(Canvas::BlendModes aMode)
+    {
+        mBlendMode = aMode;
+    }
+
+    void DrawCircle(const Point &arCenter, int aRadius, const Color &arColor);
+    void DrawLine(const Point &arA, const Point &arB, const Color &arColor);
+    void DrawRectangle(const Rect &arRect, const Color &arColor, bool aFilled = false);
+    void DrawImage(const Point &arLeftTop, const Bitmap &arBitmap);
+    void DrawImage(const Point &arLeftTop, const Bitmap &arBitmap, const Rect &arSourceRect);
+    void DrawText(const Text &arText, const Color &arColor);
+
+    /**
+     * Rasterize all recorded operations into the back buffer of the canvas,
+     * inside its current clip area, and clear the recording.
+     * The drawn areas are invalidated on the canvas.
+     */
+    void Render();
+
+    /**
+     * Drop all recorded operations without drawing them.
+     */
+    void Clear();
+
+    /**
+     * Get the number of recorded operations.
+     *
+     * \return std::size_t
+     */
+    std::size_t GetCommandCount() const
+    {
+        return mCommands.size();
+    }
+
+    /**
+     * Get the number of worker threads.
+     *
+     * \return unsigned
+     */
+    unsigned GetWorkerCount() const
+    {
+        return static_cast<unsigned>(mWorkers.size());
+    }
+
+    /**
+     * The default is one worker less than the number of cores,
+     * as the thread calling Render also renders tiles.
+     *
+     * \return unsigned
+     */
+    static unsigned GetDefaultWorkerCount();
+
+  protected:
+    struct Command {
+        Rect mBounds;
+        Canvas::BlendModes mBlendMode;
+        std::function<void(Canvas&)> mDraw;
+    };
+
+    struct Tile {
+        Rect mArea;
+        std::vector<uint32_t> mCommands;
+    };
+
+    class TileCanvas;
+
+    BufferedCanvas &mrCanvas;
+    int mTileSize;
+    Canvas::BlendModes mBlendMode = Canvas::BlendModes::Copy;
+    std::vector<Command> mCommands{};
+    std::vector<Tile> mTiles{};
+    std::vector<std::unique_ptr<TileCanvas>> mTileCanvases{};
+
+    std::vector<std::thread> mWorkers{};
+    std::mutex mMutex{};
+    std::condition_variable mWake{};
+    std::condition_variable mDone{};
+    uint64_t mGeneration = 0;
+    unsigned mBusy = 0;
+    bool mStop = false;
+    std::atomic<std::size_t> mNextTile{0};
+    std::exception_ptr mError{};
+
+    void record(const Rect &arBounds, std::function<void(Canvas&)> aDraw);
+    void binCommands(const Rect &arClip);
+    void renderTiles(TileCanvas &arCanvas);
+    void workerLoop(std::size_t aIndex);
+};
+
+} // namespace rsp::graphics
+#endif // TILERENDERER_H
@@ -11,11 +11,13 @@
 #define BITMAP_H
 
 #include <graphics/primitives/Canvas.h>
+#include <graphics/primitives/ImageCache.h>
 #include <graphics/primitives/raster/ImgLoader.h>
 #include <memory>
 
 #include <functional>
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -28,13 +30,16 @@ namespace rsp::graphics
  * The Bitmap is an object wrapper around raster images.
  * Various raster image formats can be implemented by descending specialized loaders
  * from the ImgLoader class and adding those to the GetRasterLoader method.
+ *
+ * Bitmaps loaded from the same file, and copies of bitmaps, share their pixel
+ * storage until one of them is drawn on, which gives it a private copy.
  */
 class Bitmap : public Canvas
 {
   public:
     static std::unordered_map<std::string, std::function<std::shared_ptr<ImgLoader>()>> filetypeMap;
     /**
-     * Load bitmap from given file.
+     * Load bitmap from given file, through the process wide ImageCache.
      *
      * \param aImgName
      */
@@ -65,11 +70,30 @@ class Bitmap : public Canvas
             return;
         }
         uint32_t location = static_cast<uint32_t>((mWidth * aPoint.mY) + aPoint.mX);
-        mImagePixels[location] = aColor;
+        writablePixels()[location] = aColor;
     }
 
     uint32_t GetPixel(const Point &aPoint, const bool aFront = false) const;
 
+    /**
+     * Make a scaled copy of the bitmap.
+     *
+     * \param aWidth
+     * \param aHeight
+     * \param aMethod
+     * \return Bitmap
+     */
+    Bitmap Scale(int aWidth, int aHeight, ScaleMethods aMethod = ScaleMethods::Bilinear) const;
+
+    /**
+     * Make a rotated copy of the bitmap.
+     * Width and height are swapped by quarter and three quarter turns.
+     *
+     * \param aRotation
+     * \return Bitmap
+     */
+    Bitmap Rotate(Rotations aRotation) const;
+
     /**
      * Get the height of the bitmap.
      *
@@ -91,18 +115,42 @@ class Bitmap : public Canvas
     }
 
     /**
-     * Get a read only reference to the pixel data.
+     * Get a read only view of the pixel data.
      *
-     * \return const std::vector<uint32_t>&
+     * \return std::span<const uint32_t>
      */
-    const std::vector<uint32_t> &GetPixels() const
+    std::span<const uint32_t> GetPixels() const
     {
-        return mImagePixels;
+        return { mpImagePixels.get(), static_cast<std::size_t>(mWidth) * static_cast<std::size_t>(mHeight) };
     }
 
   protected:
-    std::shared_ptr<ImgLoader> GetRasterLoader(const std::string aFileExtension);
-    std::vector<uint32_t> mImagePixels{ }; // Pointer?
+    static std::shared_ptr<ImgLoader> GetRasterLoader(const std::string aFileExtension);
+    static ImageCache::Image decode(const std::string &arFileName);
+
+    /**
+     * Get the pixel storage for writing, copying it first if it is shared
+     * or not owned by bitmaps.
+     */
+    uint32_t* writablePixels()
+    {
+        if (!mPrivatePixels || (mpImagePixels.use_count() > 1)) {
+            makePrivate();
+        }
+        return const_cast<uint32_t*>(mpImagePixels.get());
+    }
+    void makePrivate();
+
+    void fillPixel(int aX, int aY, const Color &arColor) override;
+    void blitRow(int aX, int aY, const uint32_t *apPixels, int aLength) override;
+    void fillHSpan(int aX, int aY, int aLength, const Color &arColor) override;
+    void fillVSpan(int aX, int aY, int aLength, const Color &arColor) override;
+    void blendMaskRow(int aX, int aY, const uint8_t *apCoverage, int aLength, const Color &arColor) override;
+    void plotLine(const Raster::Line &arLine, const Color &arColor) override;
+    // Owned by a vector or a memory mapped file
+    std::shared_ptr<const uint32_t> mpImagePixels;
+    // True if the owner is a vector created by a bitmap, which may be written when not shared
+    bool mPrivatePixels = false;
 };
 
 } // namespace rsp::graphics
@@ -11,9 +11,11 @@
 #ifndef CANVAS_H
 #define CANVAS_H
 
+#include <vector>
 #include "Color.h"
 #include "Text.h"
 #include "Point.h"
+#include "Raster.h"
 #include "Rect.h"
 
 namespace rsp::graphics
@@ -28,6 +30,35 @@ class Bitmap;
 class Canvas
 {
   public:
+    /**
+     * How drawn pixels are combined with the pixels already on the canvas.
+     * The alpha channel of the drawn color is used as opacity, where 0xFF is opaque.
+     */
+    enum class BlendModes {
+        Copy,                    /**< Overwrite the destination, alpha is ignored */
+        SourceOver,              /**< Straight alpha: dst = src * a + dst * (1 - a) */
+        PremultipliedSourceOver, /**< Color channels are already multiplied by alpha: dst = src + dst * (1 - a) */
+        Additive                 /**< dst = dst + src * a, saturated */
+    };
+
+    /**
+     * How the pixels of scaled images are sampled.
+     */
+    enum class ScaleMethods {
+        Nearest,  /**< Nearest source pixel, keeps hard edges */
+        Bilinear  /**< Interpolated between the four nearest source pixels */
+    };
+
+    /**
+     * Clockwise rotations in quarter turns.
+     */
+    enum class Rotations {
+        None,
+        Clockwise90,
+        Clockwise180,
+        Clockwise270
+    };
+
     Canvas()
         : mHeight(0), mWidth(0), mBytesPerPixel(0) {}
     Canvas(int aHeight, int aWidth, int aBytesPerPixel)
@@ -88,8 +119,33 @@ class Canvas
      */
     void DrawImage(const Point &arLeftTop, const Bitmap &arBitmap);
 
+    /**
+     * Copies part of the bitmap content into the canvas.
+     * The top left corner of arSourceRect is placed at arLeftTop. This is handy for sprite sheets.
+     *
+     * \param arLeftTop
+     * \param arBitmap
+     * \param arSourceRect Area of the bitmap to copy
+     */
+    void DrawImage(const Point &arLeftTop, const Bitmap &arBitmap, const Rect &arSourceRect);
+
+    /**
+     * Scales the bitmap to fill the destination rectangle while copying it into the canvas.
+     * Only the visible part of the destination is sampled, no scaled copy of the bitmap is made.
+     *
+     * \param arDestination Area the whole bitmap is scaled to
+     * \param arBitmap
+     * \param aMethod
+     */
+    void DrawImage(const Rect &arDestination, const Bitmap &arBitmap, ScaleMethods aMethod = ScaleMethods::Bilinear);
+
     /**
      * Draws the given Text object in the given color on the canvas.
+     * The glyph coverage is used as opacity, giving anti aliased edges.
+     * In BlendModes::Copy mode the alpha channel of the color is ignored.
+     * Cached text is drawn from its coverage surface in one pass, in Copy mode or with
+     * an opaque color in the SourceOver modes. Otherwise it is drawn glyph by glyph,
+     * as overlapping glyphs would blend differently.
      *
      * \param aRect
      * \param arColor
@@ -123,6 +179,64 @@ class Canvas
      */
     virtual inline void SetPixel(const Point &, const Color) = 0;
 
+    /**
+     * Restrict the drawing primitives to the given area.
+     *
+     * The area is intersected with the currently active clip area,
+     * so nested calls can only narrow it down.
+     * Every call must be matched by a call to PopClipRect.
+     *
+     * \param arRect
+     */
+    void PushClipRect(const Rect &arRect);
+
+    /**
+     * Restore the clip area that was active before the last call to PushClipRect.
+     */
+    void PopClipRect();
+
+    /**
+     * Get the area the drawing primitives are currently restricted to.
+     * Without any pushed area this is the entire canvas.
+     *
+     * \return Rect
+     */
+    Rect GetClipRect() const;
+
+    /**
+     * Set how the drawing primitives combine pixels with the canvas content.
+     * The default is BlendModes::Copy.
+     *
+     * \param aMode
+     */
+    void SetBlendMode(BlendModes aMode)
+    {
+        mBlendMode = aMode;
+    }
+
+    /**
+     * Get the active blend mode.
+     *
+     * \return BlendModes
+     */
+    BlendModes GetBlendMode() const
+    {
+        return mBlendMode;
+    }
+
+    /**
+     * Mark an area of the canvas as modified.
+     *
+     * The drawing primitives and SetPixel call this automatically, it is only
+     * needed after modifying the pixels by other means.
+     * The default implementation does nothing.
+     *
+     * \param arRect
+     */
+    virtual void Invalidate(const Rect &/*arRect*/)
+    {
+    }
+
     /**
      * Get the width of the canvas.
      *
@@ -168,20 +282,120 @@ class Canvas
     int mHeight;
     int mWidth;
     int mBytesPerPixel;
+    std::vector<Rect> mClipStack{};
+    BlendModes mBlendMode = BlendModes::Copy;
 
-    inline void plot4Points(int aCenterX, int aCenterY, int aX, int aY, const Color &arColor)
-    {
-        SetPixel(Point(aCenterX + aX, aCenterY + aY), arColor);
-        SetPixel(Point(aCenterX - aX, aCenterY + aY), arColor);
-        SetPixel(Point(aCenterX + aX, aCenterY - aY), arColor);
-        SetPixel(Point(aCenterX - aX, aCenterY - aY), arColor);
-    }
+    /**
+     * Plot the runs of all eight octants of a circle, where the
+     * octant runs from aY0 to aY1 at the same radius.
+     */
+    void plotCircleRuns(int aCenterX, int aCenterY, int aRadius, int aY0, int aY1, const Color &arColor);
 
-    inline void plot8Points(int aCenterX, int aCenterY, int aX, int aY, const Color &arColor)
-    {
-        plot4Points(aCenterX, aCenterY, aX, aY, arColor);
-        plot4Points(aCenterX, aCenterY, aY, aX, arColor);
-    }
+    /**
+     * Bresenham line along the major axis, with the step range clipped to the
+     * given area before any pixel is plotted. Both deltas must be non-zero.
+     * If aSwapped is set, major is the Y axis.
+     */
+    void rasterLine(int aMajor, int aMinor, int aDeltaMajor, int aDeltaMinor, int aMajorLow, int aMajorHigh,
+                    int aMinorLow, int aMinorHigh, bool aSwapped, const Color &arColor);
+
+    /**
+     * Plot the pixels of a line that is known to be inside the canvas.
+     * Canvases with direct pixel access should override this, passing an
+     * inlined pixel store to Raster::ForEachLinePixel.
+     *
+     * \param arLine
+     * \param arColor
+     */
+    virtual void plotLine(const Raster::Line &arLine, const Color &arColor);
+
+    /**
+     * Draw a horizontal run of aLength pixels starting at aX, aY.
+     * The run is clipped to the clip area once, before it is passed on to fillHSpan.
+     *
+     * \param aX
+     * \param aY
+     * \param aLength
+     * \param arColor
+     */
+    void drawHSpan(int aX, int aY, int aLength, const Color &arColor);
+
+    /**
+     * Draw a vertical run of aLength pixels starting at aX, aY.
+     * The run is clipped to the clip area once, before it is passed on to fillVSpan.
+     *
+     * \param aX
+     * \param aY
+     * \param aLength
+     * \param arColor
+     */
+    void drawVSpan(int aX, int aY, int aLength, const Color &arColor);
+
+    /**
+     * Set a single pixel that is known to be inside the canvas.
+     * Canvases with direct pixel access should override this with an unchecked version.
+     *
+     * \param aX
+     * \param aY
+     * \param arColor
+     */
+    virtual void fillPixel(int aX, int aY, const Color &arColor);
+
+    /**
+     * Copy a row of ARGB pixels to a horizontal run that is known to be inside the canvas.
+     * Canvases with direct pixel access should override this with a faster version.
+     *
+     * \param aX
+     * \param aY
+     * \param apPixels
+     * \param aLength
+     */
+    virtual void blitRow(int aX, int aY, const uint32_t *apPixels, int aLength);
+
+    /**
+     * Fill a horizontal run of pixels that is known to be inside the canvas.
+     * Canvases with direct pixel access should override this with a faster version.
+     *
+     * \param aX
+     * \param aY
+     * \param aLength
+     * \param arColor
+     */
+    virtual void fillHSpan(int aX, int aY, int aLength, const Color &arColor);
+
+    /**
+     * Fill a vertical run of pixels that is known to be inside the canvas.
+     * Canvases with direct pixel access should override this with a faster version.
+     *
+     * \param aX
+     * \param aY
+     * \param aLength
+     * \param arColor
+     */
+    virtual void fillVSpan(int aX, int aY, int aLength, const Color &arColor);
+
+    /**
+     * Blend a color onto a horizontal run that is known to be inside the canvas,
+     * with the alpha of the color scaled by 8 bit coverage values, e.g. from anti aliased glyphs.
+     * Canvases with direct pixel access should override this with a faster version.
+     *
+     * \param aX
+     * \param aY
+     * \param apCoverage
+     * \param aLength
+     * \param arColor
+     */
+    virtual void blendMaskRow(int aX, int aY, const uint8_t *apCoverage, int aLength, const Color &arColor);
+
+    /**
+     * Combine a pixel with the canvas content at aX, aY according to the blend mode.
+     *
+     * \param aX
+     * \param aY
+     * \param aColor
+     * \return Resulting pixel value
+     */
+    uint32_t blendPixel(int aX, int aY, uint32_t aColor) const;
 };
 
 } // namespace rsp::graphics
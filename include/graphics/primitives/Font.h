@@ -33,9 +33,14 @@ public:
     FontException(const std::string &arMsg) : rsp::utils::CoreException(arMsg.c_str()) {};
 };
 
+class GlyphAtlas;
+
 /**
  * \class Glyph
- * \brief A data class holding all the pixel data of a unicode glyph.
+ * \brief A data class describing a unicode glyph and where its coverage pixels are stored.
+ *
+ * The coverage pixels live in a shared GlyphAtlas. mWidth is the layout width
+ * including kerning, mBitmapWidth is the width of the coverage bitmap.
  */
 class Glyph
 {
@@ -43,7 +48,18 @@ public:
     Glyph() {}
     Glyph(void* apFace);
 
-    std::vector<uint8_t> mPixels { };
+    /**
+     * Get pointer to the first coverage value of a row in the glyph bitmap.
+     *
+     * \param aRow
+     * \return Pointer to mBitmapWidth coverage values
+     */
+    const uint8_t* GetCoverage(int aRow) const;
+
+    std::shared_ptr<const GlyphAtlas> mpAtlas { };
+    int mAtlasLeft = 0;
+    int mAtlasTop = 0;
+    int mBitmapWidth = 0;
     uint32_t mSymbolUnicode = 0;
 
     int mTop = 0;
@@ -106,6 +122,16 @@ public:
      */
     std::vector<Glyph> MakeGlyphs(const std::string &arText, int aLineSpacing = 0) const;
 
+    /**
+     * Get the size and position of the glyphs for the given string, without rendering them.
+     * The glyphs are laid out exactly as with MakeGlyphs, but have no coverage pixels.
+     *
+     * \param arText
+     * \param aLineSpacing
+     * \return
+     */
+    std::vector<Glyph> MeasureGlyphs(const std::string &arText, int aLineSpacing = 0) const;
+
     /**
      * Get the family name of the font.
      *
@@ -25,6 +25,7 @@ public:
     virtual ~FontRawInterface() {};
 
     virtual std::vector<Glyph> MakeGlyphs(const std::string &arText, int aLineSpacing) = 0;
+    virtual std::vector<Glyph> MeasureGlyphs(const std::string &arText, int aLineSpacing) = 0;
     virtual std::string GetFamilyName() const = 0;
     virtual void SetSize(int aWidthPx, int aHeightPx) = 0;
 
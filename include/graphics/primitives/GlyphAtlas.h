@@ -0,0 +1,84 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef INCLUDE_GRAPHICS_PRIMITIVES_GLYPHATLAS_H_
+#define INCLUDE_GRAPHICS_PRIMITIVES_GLYPHATLAS_H_
+
+#include <cstdint>
+#include <vector>
+#include "Point.h"
+
+namespace rsp::graphics {
+
+/**
+ * \class GlyphAtlas
+ * \brief One contiguous 8 bit coverage surface holding many rasterized glyphs.
+ *
+ * Glyphs are packed onto horizontal shelves. A glyph goes onto the shelf
+ * that fits it best, a new shelf is opened below the others when none fit.
+ * Space is never reclaimed, a full atlas is replaced by a new one.
+ */
+class GlyphAtlas
+{
+public:
+    static constexpr int cDefaultSize = 256;
+
+    GlyphAtlas(int aWidth = cDefaultSize, int aHeight = cDefaultSize);
+
+    /**
+     * Copy a coverage bitmap into the atlas.
+     *
+     * \param apPixels Coverage values, one byte per pixel
+     * \param aWidth
+     * \param aHeight
+     * \param aPitch Number of bytes between rows in apPixels, negative if the rows are stored bottom up
+     * \param arPosition Receives the top left corner of the bitmap inside the atlas
+     * \return False if there is no room left for the bitmap
+     */
+    bool Insert(const uint8_t *apPixels, int aWidth, int aHeight, int aPitch, Point &arPosition);
+
+    /**
+     * Get pointer to the coverage value at aX, aY. Rows are GetWidth() bytes apart.
+     *
+     * \param aX
+     * \param aY
+     * \return Pointer to coverage value
+     */
+    const uint8_t* GetPixels(int aX, int aY) const
+    {
+        return mPixels.data() + static_cast<std::size_t>(aY * mWidth + aX);
+    }
+
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+
+    /**
+     * Get the number of pixels occupied by glyphs.
+     *
+     * \return int
+     */
+    int GetUsedArea() const { return mUsedArea; }
+
+protected:
+    struct Shelf {
+        int mTop;
+        int mHeight;
+        int mUsedWidth;
+    };
+
+    int mWidth;
+    int mHeight;
+    int mUsedArea = 0;
+    std::vector<Shelf> mShelves{};
+    std::vector<uint8_t> mPixels;
+};
+
+} /* namespace rsp::graphics */
+
+#endif /* INCLUDE_GRAPHICS_PRIMITIVES_GLYPHATLAS_H_ */
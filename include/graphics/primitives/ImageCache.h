@@ -0,0 +1,116 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace rsp::graphics
+{
+
+/**
+ * \class ImageCache
+ * \brief Process wide cache of decoded image files.
+ *
+ * Images are identified by file name, modification time and size, so a
+ * changed file is decoded again. The pixel storage is shared by the cache
+ * and all bitmaps loaded from the file, and is never written while shared;
+ * bitmaps copy it before drawing on it.
+ *
+ * The cache holds at most the budget of pixel bytes, evicting the least
+ * recently used images. Evicted images stay alive for as long as bitmaps
+ * use them.
+ */
+class ImageCache
+{
+  public:
+    static constexpr std::size_t cDefaultBudget = 32 * 1024 * 1024;
+
+    /**
+     * Decoded image. The pixels are never written, and are owned by
+     * a vector or a memory mapped file.
+     */
+    struct Image {
+        std::shared_ptr<const uint32_t> mpPixels{};
+        int mWidth = 0;
+        int mHeight = 0;
+    };
+
+    /**
+     * Get the cache shared by all bitmaps.
+     *
+     * \return ImageCache
+     */
+    static ImageCache& Get();
+
+    ImageCache(std::size_t aBudget = cDefaultBudget);
+
+    /**
+     * Get the decoded image of a file, decoding it on a miss.
+     * Decoding is done without holding the cache lock, and failures
+     * are passed on to the caller without being cached.
+     *
+     * \param arFileName
+     * \param arDecoder Function decoding the file
+     * \return Image
+     */
+    Image Load(const std::string &arFileName, const std::function<Image(const std::string&)> &arDecoder);
+
+    /**
+     * Remove all images. The statistics are kept.
+     */
+    void Clear();
+
+    /**
+     * Set the maximum number of pixel bytes held by the cache.
+     * Images larger than the budget are not cached.
+     *
+     * \param aBytes
+     */
+    void SetBudget(std::size_t aBytes);
+    std::size_t GetBudget() const;
+
+    std::size_t GetSize() const;
+    std::size_t GetMemoryUsage() const;
+
+    std::size_t GetHits() const;
+    std::size_t GetMisses() const;
+    void ResetStatistics();
+
+  protected:
+    struct Entry {
+        std::string mFileName{};
+        int64_t mModified = 0;  // Nanoseconds
+        int64_t mFileSize = 0;
+        std::size_t mBytes = 0;
+        Image mImage{};
+    };
+    typedef std::list<Entry> List_t;
+
+    mutable std::mutex mMutex{};
+    std::size_t mBudget;
+    std::size_t mUsage = 0;
+    std::size_t mHits = 0;
+    std::size_t mMisses = 0;
+    List_t mEntries{}; // Most recently used first
+    std::unordered_map<std::string, List_t::iterator> mIndex{};
+
+    void erase(List_t::iterator aIt);
+    void evict(std::size_t aBudget);
+};
+
+} // namespace rsp::graphics
+#endif // IMAGECACHE_H
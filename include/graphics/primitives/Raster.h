@@ -0,0 +1,112 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <cstdint>
+
+/**
+ * Raster algorithms as templates over the operation that plots the result.
+ *
+ * A surface with direct pixel access passes a lambda writing its own pixels,
+ * so the compiler can inline the pixel store into the stepping loop.
+ */
+namespace rsp::graphics::Raster {
+
+/**
+ * A Bresenham line along its major axis, already clipped to the visible pixels.
+ */
+struct Line {
+    int mMajor;            // Major coordinate of the first pixel
+    int mMinor;            // Minor coordinate of the first pixel
+    int mMajorStep;        // Direction along the major axis, 1 or -1
+    int mMinorStep;        // Direction along the minor axis, 1 or -1
+    int64_t mError;        // Accumulated error at the first pixel
+    int64_t mMajorLength;  // Absolute delta along the major axis
+    int64_t mMinorLength;  // Absolute delta along the minor axis
+    int64_t mCount;        // Number of pixels
+    bool mSwapped;         // Set if the major axis is Y
+};
+
+template <class F>
+inline void stepLine(const Line &arLine, F &arPlot)
+{
+    int major = arLine.mMajor;
+    int minor = arLine.mMinor;
+    int64_t error = arLine.mError;
+
+    for (int64_t i = 0; i < arLine.mCount; i++) {
+        arPlot(major, minor);
+        error += arLine.mMinorLength;
+        if (error >= arLine.mMajorLength) {
+            error -= arLine.mMajorLength;
+            minor += arLine.mMinorStep;
+        }
+        major += arLine.mMajorStep;
+    }
+}
+
+/**
+ * Call aPlot(x, y) for each pixel of the line.
+ *
+ * \param arLine
+ * \param aPlot
+ */
+template <class F>
+inline void ForEachLinePixel(const Line &arLine, F aPlot)
+{
+    if (arLine.mSwapped) {
+        auto swapped = [&aPlot](int aMajor, int aMinor) { aPlot(aMinor, aMajor); };
+        stepLine(arLine, swapped);
+    }
+    else {
+        stepLine(arLine, aPlot);
+    }
+}
+
+/**
+ * Midpoint circle, where the pixels plotted at the same radius form straight
+ * runs in each octant. Calls aRun(radius, y0, y1) for each run in the first
+ * octant, the caller mirrors it into the other seven.
+ *
+ * \param aRadius
+ * \param aRun
+ */
+template <class F>
+inline void ForEachCircleRun(int aRadius, F aRun)
+{
+    int error = -aRadius;
+    int y = 0;
+    int run_start = 0;
+
+    while (aRadius >= y) {
+        int radius = aRadius;
+        int run_end = y;
+        error += y;
+        y++;
+        error += y;
+
+        bool new_radius = (error >= 0);
+        if (new_radius) {
+            error += -aRadius;
+            aRadius--;
+            error += -aRadius;
+        }
+
+        if (new_radius || (aRadius < y)) {
+            aRun(radius, run_start, run_end);
+            run_start = y;
+        }
+    }
+}
+
+} // namespace rsp::graphics::Raster
+
+#endif // RASTER_H
@@ -175,6 +175,46 @@ class Rect
      */
     bool IsHit(const Point &arPoint) const;
 
+    /**
+     * Determines if the Rect covers no pixels at all.
+     *
+     * \return bool
+     */
+    bool IsEmpty() const;
+
+    /**
+     * Determines if the given Rect shares any pixels with this Rect.
+     *
+     * \param arRect
+     * \return bool
+     */
+    bool Intersects(const Rect &arRect) const;
+
+    /**
+     * Get the area covered by both this and the given Rect.
+     * An empty Rect is returned if they do not intersect.
+     *
+     * \param arRect
+     * \return Rect
+     */
+    Rect Intersection(const Rect &arRect) const;
+
+    /**
+     * Get the smallest Rect covering both this and the given Rect.
+     * Empty Rects do not contribute to the result.
+     *
+     * \param arRect
+     * \return Rect
+     */
+    Rect Union(const Rect &arRect) const;
+
+    /**
+     * Get the number of pixels covered by the Rect.
+     *
+     * \return int
+     */
+    int GetArea() const;
+
     void VerifyDimensions() const;
 
   protected:
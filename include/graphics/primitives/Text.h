@@ -11,7 +11,9 @@
 #ifndef INCLUDE_GRAPHICS_PRIMITIVES_TEXT_H_
 #define INCLUDE_GRAPHICS_PRIMITIVES_TEXT_H_
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "Font.h"
 #include "Rect.h"
 
@@ -30,6 +32,17 @@ namespace rsp::graphics {
 class Text
 {
 public:
+    /**
+     * \brief Coverage of all glyphs in the text, rendered into one 8 bit surface.
+     *
+     * mArea is relative to the text area. mCoverage holds one value per pixel, row by row.
+     */
+    struct Surface
+    {
+        Rect mArea{};
+        std::vector<uint8_t> mCoverage{};
+    };
+
     enum class HAlign : uint8_t {
         Left,
         Center,
@@ -74,7 +87,7 @@ public:
      * \param arValue
      * \return Reference to this for fluent calls.
      */
-    Text& SetValue(const std::string &arValue) { mValue = arValue; return *this; }
+    Text& SetValue(const std::string &arValue) { mValue = arValue; invalidateSurface(); return *this; }
 
     /**
      * Getter for the area where the text is drawn on a canvas.
@@ -88,7 +101,7 @@ public:
      * \param arRect
      * \return Reference to this for fluent calls.
      */
-    Text& SetArea(const Rect &arRect) { mArea = arRect; return *this; }
+    Text& SetArea(const Rect &arRect) { mArea = arRect; invalidateSurface(); return *this; }
 
     /**
      * Returns a reference to the internal font object.
@@ -110,7 +123,7 @@ public:
      * \param aValue
      * \return Reference to this for fluent calls.
      */
-    Text& SetScaleToFit(bool aValue = true) { mScaleToFit = aValue; return *this; }
+    Text& SetScaleToFit(bool aValue = true) { mScaleToFit = aValue; invalidateSurface(); return *this; }
 
     /**
      * Get the current value of the line spacing.
@@ -125,7 +138,7 @@ public:
      * \param aSpacing
      * \return Reference to this for fluent calls.
      */
-    Text& SetLineSpacing(int aSpacing) { mLineSpacing = aSpacing; return *this; }
+    Text& SetLineSpacing(int aSpacing) { mLineSpacing = aSpacing; invalidateSurface(); return *this; }
 
     /**
      * Get the number of lines in the text content.
@@ -147,7 +160,7 @@ public:
      * \param aVAlign
      * \return Reference to this for fluent calls.
      */
-    Text& SetVAlignment(VAlign aVAlign) { mVAlign = aVAlign; return *this; }
+    Text& SetVAlignment(VAlign aVAlign) { mVAlign = aVAlign; invalidateSurface(); return *this; }
 
     /**
      * Get the current horizontal alignment setting.
@@ -161,7 +174,7 @@ public:
      * \param aHAlign
      * \return Reference to this for fluent calls.
      */
-    Text& SetHAlignment(HAlign aHAlign) { mHAlign = aHAlign; return *this; }
+    Text& SetHAlignment(HAlign aHAlign) { mHAlign = aHAlign; invalidateSurface(); return *this; }
 
     /**
      * Reload all glyphs based on the current settings.
@@ -177,6 +190,31 @@ public:
      */
     const std::vector<Glyph>& GetGlyphs() const { return mGlyphs; }
 
+    /**
+     * Get the current value of the Cached member.
+     *
+     * \return bool
+     */
+    bool GetCached() const { return mCached; }
+    /**
+     * Set the Cached member. If set the glyphs are rendered into a coverage surface
+     * on every Reload, so static text is drawn in a single pass.
+     * Canvas::DrawText only uses the surface where it gives the same result as the glyphs,
+     * see Canvas::DrawText.
+     * The surface is discarded when the content, area, alignment or font size or style changes.
+     *
+     * \param aValue
+     * \return Reference to this for fluent calls.
+     */
+    Text& SetCached(bool aValue = true);
+
+    /**
+     * Get the rendered coverage surface of the text.
+     *
+     * \return Pointer to Surface, or nullptr if the text is not cached or the surface is outdated.
+     */
+    const Surface* GetSurface() const;
+
     /**
      * Calculate the minimum bounding rectangle containing all the glyphs.
      *
@@ -196,7 +234,13 @@ protected:
     int mLineSpacing = 1;
     HAlign mHAlign = HAlign::Center;
     VAlign mVAlign = VAlign::Center;
+    bool mCached = false;
+    Surface mSurface{};
+    int mSurfaceFontSize = 0;
+    Font::Styles mSurfaceFontStyle = Font::Styles::Normal;
 
+    void invalidateSurface() { mSurface.mCoverage.clear(); }
+    void renderSurface();
     void scaleToFit();
     void loadGlyphs();
     void alignGlyphs();
@@ -11,7 +11,6 @@
 #define BMPLOADER_H
 
 #include <cstring>
-#include <fstream>
 #include <graphics/primitives/raster/ImgLoader.h>
 #include <iostream>
 #include <vector>
@@ -19,10 +18,18 @@
 namespace rsp::graphics
 {
 
+/**
+ * \class BmpLoader
+ * \brief Loader for uncompressed 24 and 32 bit BMP files.
+ *
+ * The file is memory mapped and each row is converted straight into the
+ * destination, in the row order of the file. 32 bit files with BI_BITFIELDS
+ * compression may use any channel masks.
+ */
 class BmpLoader : public ImgLoader
 {
   public:
-    std::vector<uint32_t> LoadImg(const std::string &aImgName);
+    void LoadImg(const std::string &aImgName, std::vector<uint32_t> &arPixels) override;
 
   protected:
     struct BitmapInfoHeader {
@@ -115,9 +122,8 @@ class BmpLoader : public ImgLoader
 
     uint16_t mBytesPerPixel = 0;
 
-    void ReadHeader(std::ifstream &arFile);
-    void ReadData(std::ifstream &arFile);
-    uint32_t ReadPixel(const std::vector<uint8_t> &aPixelRow, const size_t &aRowPtr);
+    void ReadHeader(const uint8_t *apData, std::size_t aSize);
+    void ReadData(const uint8_t *apData, std::size_t aSize, std::vector<uint32_t> &arPixels);
 };
 
 std::ostream& operator <<(std::ostream &os, const BmpLoader::BmpHeader_t &arHeader);
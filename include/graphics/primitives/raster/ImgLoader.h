@@ -10,8 +10,9 @@
 #ifndef IMGLOADER_H
 #define IMGLOADER_H
 
-#include <cstring>
-#include <iostream>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace rsp::graphics
@@ -21,11 +22,26 @@ class ImgLoader
 {
   public:
     virtual ~ImgLoader() = default;
-    virtual std::vector<uint32_t> LoadImg(const std::string &aImgName) = 0;
 
-    const std::vector<uint32_t> &GetPixels() const
+    /**
+     * Decode the given image file into 32 bit ARGB pixels, row by row from the top.
+     *
+     * \param arImgName File name
+     * \param arPixels Destination, resized to fit the image
+     */
+    virtual void LoadImg(const std::string &arImgName, std::vector<uint32_t> &arPixels) = 0;
+
+    /**
+     * Get the pixels of an image file already stored as 32 bit ARGB rows,
+     * without decoding or copying them. The returned pointer owns whatever
+     * keeps the pixels valid, e.g. a memory mapping of the file.
+     *
+     * \param arImgName File name
+     * \return Pointer to the first pixel, or null if the file must be loaded with LoadImg
+     */
+    virtual std::shared_ptr<const uint32_t> MapImg(const std::string &/*arImgName*/)
     {
-        return mImagePixels;
+        return {};
     }
 
     int GetHeight() const
@@ -38,7 +54,6 @@ class ImgLoader
     }
 
   protected:
-    std::vector<uint32_t> mImagePixels{ };
     int mHeight = 0;
     int mWidth = 0;
 };
@@ -10,55 +10,76 @@
 #ifndef PNGLOADER_H
 #define PNGLOADER_H
 
+#include <array>
 #include <graphics/primitives/raster/ImgLoader.h>
-#include <cstring>
-#include <iostream>
 #include <vector>
 
 namespace rsp::graphics
 {
 
+/**
+ * \class PngLoader
+ * \brief Loader for PNG files of all standard color types and bit depths.
+ *
+ * The file is memory mapped and the IDAT chunks are inflated as they are
+ * found, into a buffer holding a single row. Each completed row is
+ * unfiltered against the previous row and converted straight into the
+ * destination, so the inflated image is never held in memory as a whole.
+ *
+ * 16 bit samples are reduced to 8 bits. Palette, gray and RGB images are
+ * made transparent from the tRNS chunk, otherwise they are opaque.
+ * Ancillary chunks like gamma and color profiles are ignored.
+ */
 class PngLoader: public ImgLoader
 {
 public:
-    std::vector<uint32_t> LoadImg(const std::string &aImgName);
+    void LoadImg(const std::string &aImgName, std::vector<uint32_t> &arPixels) override;
 
 protected:
-    struct PLTE
-    {
-    } __attribute__((packed)); //To stop alignment;
-    struct IEND
-    {
-    } __attribute__((packed)); //To stop alignment;
-    struct IHDR
-    {
-        uint32_t width;
-        uint32_t height;
-        uint8_t bitDepth;
-        uint8_t colourType;
-        uint8_t compressionMethod;
-        uint8_t filterMethod;
-        uint8_t interlaceMethod;
-    } __attribute__((packed)); //To stop alignment
-    struct PNGChunk
-    {
-        uint32_t length = 0;
-        char type[4];
-        union
-        {
-            uint8_t *data = nullptr;
-            struct IHDR *ihdr;
-            struct PLTE *plte;
-            struct IEND *iend;
-        };
-        // A CRC value of type uint32_t is always appended to the chunk
-    } __attribute__((packed)); //To stop alignment
+    enum class ColorTypes : uint8_t {
+        Gray = 0,
+        Rgb = 2,
+        Palette = 3,
+        GrayAlpha = 4,
+        Rgba = 6
+    };
+
+    struct Header {
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint8_t mBitDepth;
+        ColorTypes mColorType;
+        bool mInterlaced;
+    };
+
+    class IdatDecoder;
+
+    static constexpr uint8_t cPngSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+    Header mHeader{};
+    std::array<uint32_t, 256> mPalette{};
+    std::size_t mPaletteSize = 0;
+    bool mHasColorKey = false;
+    std::array<uint16_t, 3> mColorKey{};
+
+    void ReadHeader(const uint8_t *apData, uint32_t aLength);
+    void ReadPalette(const uint8_t *apData, uint32_t aLength);
+    void ReadTransparency(const uint8_t *apData, uint32_t aLength);
 
-    uint8_t mPngSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    /**
+     * Get the number of samples in a pixel.
+     */
+    unsigned getChannels() const;
 
-    bool CheckSignature(const uint8_t *aSig, const uint8_t &aSize);
-    void ReadHeader(FILE *file);
-    void ReadData(FILE *file);
+    /**
+     * Convert an unfiltered row to ARGB.
+     *
+     * \param apRow Unfiltered row of samples
+     * \param aWidth Number of pixels in the row
+     * \param apDst First destination pixel
+     * \param aStep Distance between destination pixels, above 1 for interlaced passes
+     */
+    void convertRow(const uint8_t *apRow, std::size_t aWidth, uint32_t *apDst, std::size_t aStep) const;
 };
 
 }
@@ -0,0 +1,90 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef RAWLOADER_H
+#define RAWLOADER_H
+
+#include <graphics/BufferedCanvas.h>
+#include <graphics/primitives/raster/ImgLoader.h>
+#include <memory>
+#include <vector>
+
+namespace rsp::graphics
+{
+
+/**
+ * \class RawLoader
+ * \brief Loader for preprocessed image assets, ready for use without decoding.
+ *
+ * The file is a small header followed by the pixel rows in one of the
+ * display pixel formats. XRGB8888 files keep the alpha channel in the top
+ * byte, so files of that format without row padding are the pixel storage
+ * of a Bitmap as is: they are memory mapped and used without a copy.
+ * Other formats are converted to ARGB when loaded.
+ *
+ * The pixel data is verified against the CRC32 in the header.
+ * Raw files are written by Save, or the rsp-asset-convert tool.
+ */
+class RawLoader : public ImgLoader
+{
+  public:
+    static constexpr uint16_t cVersion = 1;
+    static constexpr uint32_t cDataOffset = 64;
+
+    /**
+     * File header, all fields are little endian.
+     */
+    struct RawHeader {
+        char mMagic[4];         // "RSPR"
+        uint16_t mVersion;
+        uint16_t mPixelFormat;  // BufferedCanvas::PixelFormats
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint32_t mStride;       // Number of bytes between rows
+        uint32_t mDataOffset;   // Offset of the first row from the start of the file
+        uint32_t mDataSize;     // Stride times height
+        uint32_t mDataCrc;      // Crc32 of the pixel data
+    } __attribute__((packed));
+
+    void LoadImg(const std::string &arImgName, std::vector<uint32_t> &arPixels) override;
+    std::shared_ptr<const uint32_t> MapImg(const std::string &arImgName) override;
+
+    /**
+     * Write ARGB pixels as a raw image file.
+     *
+     * \param arFileName
+     * \param apPixels Rows of ARGB pixels without padding
+     * \param aWidth
+     * \param aHeight
+     * \param aFormat Pixel format of the file
+     */
+    static void Save(const std::string &arFileName, const uint32_t *apPixels, int aWidth, int aHeight,
+        BufferedCanvas::PixelFormats aFormat = BufferedCanvas::PixelFormats::XRGB8888);
+
+  protected:
+    RawHeader mHeader{};
+
+    /**
+     * Read and validate the header of a raw image file, and convert it to host byte order.
+     *
+     * \param apData Start of the file
+     * \param aSize Size of the file
+     */
+    void ReadHeader(const uint8_t *apData, std::size_t aSize);
+
+    /**
+     * Check the pixel data against the CRC in the header read by ReadHeader.
+     *
+     * \param apData Start of the file
+     */
+    void VerifyData(const uint8_t *apData) const;
+};
+
+} // namespace rsp::graphics
+#endif // RAWLOADER_H
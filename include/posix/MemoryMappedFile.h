@@ -0,0 +1,94 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#ifndef SRC_POSIX_MEMORYMAPPEDFILE_H_
+#define SRC_POSIX_MEMORYMAPPEDFILE_H_
+
+#include <cstdint>
+#include <string>
+
+namespace rsp::posix
+{
+
+/**
+ * \class MemoryMappedFile
+ * \brief Read only mapping of an entire file into memory.
+ *
+ * The file contents are paged in by the OS as they are accessed,
+ * and pages are shared with all other mappings of the same file.
+ */
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile() {}
+    MemoryMappedFile(const std::string &arFileName);
+    virtual ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+    MemoryMappedFile(MemoryMappedFile &&arOther) noexcept;
+    MemoryMappedFile& operator=(MemoryMappedFile &&arOther) noexcept;
+
+    /**
+     * Map the given file, any previous mapping is released.
+     *
+     * \param arFileName
+     */
+    void Open(const std::string &arFileName);
+
+    /**
+     * Release the mapping.
+     */
+    void Close();
+
+    /**
+     * Check if a file is mapped.
+     *
+     * \return True if file is mapped.
+     */
+    bool IsOpen() const
+    {
+        return !mFileName.empty();
+    }
+
+    /**
+     * Get pointer to the file contents.
+     *
+     * \return Pointer to first byte, nullptr for an empty file.
+     */
+    const uint8_t* GetData() const
+    {
+        return mpData;
+    }
+
+    /**
+     * Get the size of the mapped file.
+     *
+     * \return Size in bytes
+     */
+    std::size_t GetSize() const
+    {
+        return mSize;
+    }
+
+    const std::string& GetFileName() const
+    {
+        return mFileName;
+    }
+
+protected:
+    std::string mFileName{};
+    const uint8_t *mpData = nullptr;
+    std::size_t mSize = 0;
+};
+
+} /* namespace rsp::posix */
+
+#endif /* SRC_POSIX_MEMORYMAPPEDFILE_H_ */
@@ -0,0 +1,302 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <algorithm>
+#include <graphics/BufferedCanvas.h>
+#include <graphics/kernels/BlendKernels.h>
+#include <graphics/kernels/PixelFormatTraits.h>
+#include <graphics/kernels/PixelKernels.h>
+#include <graphics/kernels/RowKernels.h>
+
+namespace rsp::graphics
+{
+
+/**
+ * Blend into a row of pixels in a format other than XRGB8888.
+ * The row is converted to ARGB in chunks, blended with the given
+ * function and converted back.
+ *
+ * \param arKernels Kernels for the pixel format
+ * \param apDst First pixel in the row
+ * \param aCount Number of pixels
+ * \param aBlend Called with a chunk of ARGB pixels, the offset of the chunk and its length
+ */
+template <class F>
+static void blendConverted(const PixelKernels::Table &arKernels, uint8_t *apDst, std::size_t aCount, F aBlend)
+{
+    uint32_t chunk[256];
+    for (std::size_t offset = 0; offset < aCount; offset += 256) {
+        std::size_t n = std::min<std::size_t>(256, aCount - offset);
+        uint8_t *dst = apDst + offset * arKernels.mBytesPerPixel;
+        arKernels.toArgb(chunk, dst, n);
+        aBlend(chunk, offset, n);
+        arKernels.fromArgb(dst, chunk, n);
+    }
+}
+
+/**
+ * Plot a line directly into a buffer of the given pixel format,
+ * with the pixel store inlined into the Bresenham loop.
+ */
+template <class Format>
+static void plotLineNative(uint8_t *apBuffer, std::size_t aStride, const Raster::Line &arLine, uint32_t aColor, Canvas::BlendModes aMode)
+{
+    auto address = [apBuffer, aStride](int aX, int aY) {
+        return apBuffer + static_cast<std::size_t>(aX) * Format::cBytes + static_cast<std::size_t>(aY) * aStride;
+    };
+
+    if (aMode == Canvas::BlendModes::Copy) {
+        Raster::ForEachLinePixel(arLine, [&](int aX, int aY) {
+            Format::Store(address(aX, aY), aColor);
+        });
+    }
+    else {
+        Raster::ForEachLinePixel(arLine, [&](int aX, int aY) {
+            uint8_t *pixel = address(aX, aY);
+            Format::Store(pixel, BlendKernels::BlendPixel(Format::Load(pixel), aColor, aMode));
+        });
+    }
+}
+
+BufferedCanvas::BufferedCanvas()
+{
+    setPixelFormat(PixelFormats::XRGB8888);
+}
+
+void BufferedCanvas::SetPixel(const Point &aPoint, const Color aColor)
+{
+    if (!IsInsideScreen(aPoint)) {
+        return;
+    }
+    mpPixelKernels->store(pixelAddress(mpBackBuffer, aPoint.GetX(), aPoint.GetY()), aColor);
+    mPixelsTouched++;
+    // Public entry point, so the pixel must survive a Copy swap without an explicit Invalidate
+    mDirtyRegion.Add(Rect(aPoint, 1, 1));
+}
+
+uint32_t BufferedCanvas::GetPixel(const Point &aPoint, const bool aFront) const
+{
+    if (!IsInsideScreen(aPoint)) {
+        return 0;
+    }
+    return mpPixelKernels->load(pixelAddress(aFront ? mpFrontBuffer : mpBackBuffer, aPoint.GetX(), aPoint.GetY()));
+}
+
+void BufferedCanvas::setPixelFormat(PixelFormats aFormat)
+{
+    mPixelFormat = aFormat;
+    mpPixelKernels = &PixelKernels::Get(aFormat);
+    mBytesPerPixel = static_cast<int>(mpPixelKernels->mBytesPerPixel);
+}
+
+void BufferedCanvas::shareBackBuffer(const BufferedCanvas &arOther)
+{
+    mWidth = arOther.mWidth;
+    mHeight = arOther.mHeight;
+    setPixelFormat(arOther.mPixelFormat);
+    mStride = arOther.mStride;
+    mpBackBuffer = arOther.mpBackBuffer;
+    mpFrontBuffer = arOther.mpFrontBuffer;
+}
+
+void BufferedCanvas::forwardPixelsTouched(BufferedCanvas &arOther)
+{
+    arOther.mPixelsTouched += mPixelsTouched;
+    mPixelsTouched = 0;
+}
+
+void BufferedCanvas::EnableFrameStatistics(bool aEnable)
+{
+    if (!aEnable) {
+        mFrameStatisticsEnabled = false;
+        return;
+    }
+    if (!mFrameStatisticsEnabled) {
+        mFrameStatistics.Reset();
+        mFrameStart = std::chrono::steady_clock::now();
+        mFrameStatisticsEnabled = true;
+    }
+}
+
+void BufferedCanvas::beginSwap()
+{
+    if (mFrameStatisticsEnabled) {
+        mSwapStart = std::chrono::steady_clock::now();
+        mSwapDirtyArea = static_cast<uint64_t>(mDirtyRegion.GetArea());
+    }
+}
+
+void BufferedCanvas::prepareBackBuffer(SwapOperations aSwapOp, Color aColor)
+{
+    switch (aSwapOp) {
+    case SwapOperations::Copy:
+        // If the back buffer held the previous frame, only the areas drawn since then differ.
+        if (mBuffersInSync) {
+            for (const Rect &r : mDirtyRegion.GetRects()) {
+                copyRect(r);
+            }
+        }
+        else {
+            copy();
+        }
+        mBuffersInSync = true;
+        break;
+
+    case SwapOperations::Clear:
+        clear(aColor);
+        mBuffersInSync = false;
+        break;
+
+    case SwapOperations::NoOp:
+    default:
+        mBuffersInSync = false;
+        break;
+    }
+    mDirtyRegion.Clear();
+
+    if (mFrameStatisticsEnabled) {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        auto now = std::chrono::steady_clock::now();
+        mFrameStatistics.Record(FrameStatistics::Frame{
+            0,
+            static_cast<uint64_t>(duration_cast<microseconds>(mSwapStart - mFrameStart).count()),
+            static_cast<uint64_t>(duration_cast<microseconds>(now - mSwapStart).count()),
+            mPixelsTouched,
+            mSwapDirtyArea
+        });
+        mFrameStart = now;
+    }
+    mPixelsTouched = 0;
+}
+
+void BufferedCanvas::clear(Color aColor)
+{
+    if (mPixelFormat == PixelFormats::XRGB8888) {
+        RowKernels::FillRect32(mpBackBuffer, mStride, aColor, static_cast<size_t>(mWidth), static_cast<size_t>(mHeight));
+        return;
+    }
+    uint8_t *row = mpBackBuffer;
+    for (int y = 0; y < mHeight; y++) {
+        mpPixelKernels->fill(row, aColor, static_cast<size_t>(mWidth));
+        row += mStride;
+    }
+}
+
+void BufferedCanvas::copy()
+{
+    copyRect(Rect(0, 0, mWidth, mHeight));
+}
+
+void BufferedCanvas::copyRect(const Rect &arRect)
+{
+    RowKernels::CopyRect(pixelAddress(mpBackBuffer, arRect.GetLeft(), arRect.GetTop()),
+                         pixelAddress(mpFrontBuffer, arRect.GetLeft(), arRect.GetTop()), mStride,
+                         static_cast<size_t>(arRect.GetWidth() * mBytesPerPixel), static_cast<size_t>(arRect.GetHeight()));
+}
+
+void BufferedCanvas::fillPixel(int aX, int aY, const Color &arColor)
+{
+    mPixelsTouched++;
+    uint8_t *pixel = pixelAddress(mpBackBuffer, aX, aY);
+    if (mPixelFormat == PixelFormats::XRGB8888) {
+        uint32_t *p = reinterpret_cast<uint32_t *>(pixel);
+        *p = BlendKernels::BlendPixel(*p, arColor, mBlendMode);
+        return;
+    }
+    mpPixelKernels->store(pixel, BlendKernels::BlendPixel(mpPixelKernels->load(pixel), arColor, mBlendMode));
+}
+
+void BufferedCanvas::blitRow(int aX, int aY, const uint32_t *apPixels, int aLength)
+{
+    mPixelsTouched += static_cast<uint64_t>(aLength);
+    uint8_t *dst = pixelAddress(mpBackBuffer, aX, aY);
+    if (mBlendMode == BlendModes::Copy) {
+        mpPixelKernels->fromArgb(dst, apPixels, static_cast<size_t>(aLength));
+    }
+    else if (mPixelFormat == PixelFormats::XRGB8888) {
+        BlendKernels::BlendRow(reinterpret_cast<uint32_t *>(dst), apPixels, static_cast<size_t>(aLength), mBlendMode);
+    }
+    else {
+        blendConverted(*mpPixelKernels, dst, static_cast<size_t>(aLength), [&](uint32_t *apChunk, std::size_t aOffset, std::size_t aCount) {
+            BlendKernels::BlendRow(apChunk, apPixels + aOffset, aCount, mBlendMode);
+        });
+    }
+}
+
+void BufferedCanvas::fillHSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    mPixelsTouched += static_cast<uint64_t>(aLength);
+    uint8_t *dst = pixelAddress(mpBackBuffer, aX, aY);
+    if (mBlendMode == BlendModes::Copy) {
+        mpPixelKernels->fill(dst, arColor, static_cast<size_t>(aLength));
+    }
+    else if (mPixelFormat == PixelFormats::XRGB8888) {
+        BlendKernels::BlendFill(reinterpret_cast<uint32_t *>(dst), arColor, static_cast<size_t>(aLength), mBlendMode);
+    }
+    else {
+        blendConverted(*mpPixelKernels, dst, static_cast<size_t>(aLength), [&](uint32_t *apChunk, std::size_t, std::size_t aCount) {
+            BlendKernels::BlendFill(apChunk, arColor, aCount, mBlendMode);
+        });
+    }
+}
+
+void BufferedCanvas::fillVSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    mPixelsTouched += static_cast<uint64_t>(aLength);
+    uint8_t *location = pixelAddress(mpBackBuffer, aX, aY);
+    uint32_t color = arColor;
+    if (mPixelFormat == PixelFormats::XRGB8888) {
+        for (int i = 0; i < aLength; i++) {
+            uint32_t *pixel = reinterpret_cast<uint32_t *>(location);
+            *pixel = BlendKernels::BlendPixel(*pixel, color, mBlendMode);
+            location += mStride;
+        }
+        return;
+    }
+    for (int i = 0; i < aLength; i++) {
+        mpPixelKernels->store(location, BlendKernels::BlendPixel(mpPixelKernels->load(location), color, mBlendMode));
+        location += mStride;
+    }
+}
+
+void BufferedCanvas::blendMaskRow(int aX, int aY, const uint8_t *apCoverage, int aLength, const Color &arColor)
+{
+    mPixelsTouched += static_cast<uint64_t>(aLength);
+    uint8_t *dst = pixelAddress(mpBackBuffer, aX, aY);
+    if (mPixelFormat == PixelFormats::XRGB8888) {
+        BlendKernels::BlendMask(reinterpret_cast<uint32_t *>(dst), apCoverage, arColor, static_cast<size_t>(aLength), mBlendMode);
+        return;
+    }
+    blendConverted(*mpPixelKernels, dst, static_cast<size_t>(aLength), [&](uint32_t *apChunk, std::size_t aOffset, std::size_t aCount) {
+        BlendKernels::BlendMask(apChunk, apCoverage + aOffset, arColor, aCount, mBlendMode);
+    });
+}
+
+void BufferedCanvas::plotLine(const Raster::Line &arLine, const Color &arColor)
+{
+    mPixelsTouched += static_cast<uint64_t>(arLine.mCount);
+    switch (mPixelFormat) {
+    case PixelFormats::RGB565:
+        plotLineNative<PixelKernels::Rgb565>(mpBackBuffer, mStride, arLine, arColor, mBlendMode);
+        break;
+
+    case PixelFormats::RGB888:
+        plotLineNative<PixelKernels::Rgb888>(mpBackBuffer, mStride, arLine, arColor, mBlendMode);
+        break;
+
+    case PixelFormats::XRGB8888:
+    default:
+        plotLineNative<PixelKernels::Xrgb8888>(mpBackBuffer, mStride, arLine, arColor, mBlendMode);
+        break;
+    }
+}
+
+} // namespace rsp::graphics
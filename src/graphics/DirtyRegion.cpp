@@ -0,0 +1,78 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <graphics/DirtyRegion.h>
+
+namespace rsp::graphics
+{
+
+DirtyRegion::DirtyRegion(int aMergeThreshold, std::size_t aMaxRects)
+    : mMergeThreshold(aMergeThreshold),
+      mMaxRects(aMaxRects)
+{
+}
+
+void DirtyRegion::Add(const Rect &arRect)
+{
+    if (arRect.IsEmpty()) {
+        return;
+    }
+
+    Rect r(arRect);
+    // Keep merging until the new rect no longer fits together with any existing rect.
+    bool merged;
+    do {
+        merged = false;
+        for (auto it = mRects.begin(); it != mRects.end(); ++it) {
+            Rect u = it->Union(r);
+            int overlap = it->Intersection(r).GetArea();
+            if ((u.GetArea() - (it->GetArea() + r.GetArea() - overlap)) <= mMergeThreshold) {
+                r = u;
+                mRects.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    }
+    while (merged);
+
+    mRects.push_back(r);
+
+    if (mRects.size() > mMaxRects) {
+        r = GetBoundingRect();
+        mRects.clear();
+        mRects.push_back(r);
+    }
+}
+
+void DirtyRegion::Clear()
+{
+    mRects.clear();
+}
+
+Rect DirtyRegion::GetBoundingRect() const
+{
+    Rect result(0, 0, 0, 0);
+    for (const Rect &r : mRects) {
+        result = result.Union(r);
+    }
+    return result;
+}
+
+int DirtyRegion::GetArea() const
+{
+    int result = 0;
+    for (const Rect &r : mRects) {
+        result += r.GetArea();
+    }
+    return result;
+}
+
+} // namespace rsp::graphics
@@ -0,0 +1,259 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <algorithm>
+#include <type_traits>
+#include <graphics/DisplayList.h>
+#include <graphics/primitives/Bitmap.h>
+#include <graphics/primitives/Text.h>
+
+namespace rsp::graphics
+{
+
+static_assert(std::is_trivially_copyable_v<DisplayList::Command>, "Display list commands must stay plain data");
+
+static Rect areaOf(const DisplayList::Command &arCommand)
+{
+    return Rect(Point(arCommand.mLeft, arCommand.mTop), Point(arCommand.mRight, arCommand.mBottom));
+}
+
+static bool contains(const DisplayList::Command &arOuter, const DisplayList::Command &arInner)
+{
+    return (arInner.mLeft >= arOuter.mLeft) && (arInner.mRight <= arOuter.mRight)
+        && (arInner.mTop >= arOuter.mTop) && (arInner.mBottom <= arOuter.mBottom);
+}
+
+static bool overlaps(const DisplayList::Command &arA, const DisplayList::Command &arB)
+{
+    return (arA.mLeft < arB.mRight) && (arB.mLeft < arA.mRight)
+        && (arA.mTop < arB.mBottom) && (arB.mTop < arA.mBottom);
+}
+
+/**
+ * Check if the command overwrites every pixel of its area,
+ * regardless of what was drawn before.
+ */
+static bool isOpaque(const DisplayList::Command &arCommand)
+{
+    using Operations = DisplayList::Operations;
+    using BlendModes = Canvas::BlendModes;
+
+    if (arCommand.mLeft >= arCommand.mRight || arCommand.mTop >= arCommand.mBottom) {
+        return false;
+    }
+    switch (arCommand.mOperation) {
+        case Operations::FilledRectangle:
+            if (arCommand.mBlendMode == BlendModes::Copy) {
+                return true;
+            }
+            return (arCommand.mBlendMode != BlendModes::Additive) && ((arCommand.mColor >> 24) == 0xFF);
+
+        case Operations::Image:
+            return (arCommand.mBlendMode == BlendModes::Copy);
+
+        default:
+            return false;
+    }
+}
+
+void DisplayList::DrawCircle(const Point &arCenter, int aRadius, const Color &arColor)
+{
+    if (aRadius < 0) {
+        return;
+    }
+    record(Operations::Circle,
+        Rect(arCenter.GetX() - aRadius, arCenter.GetY() - aRadius, 2 * aRadius + 1, 2 * aRadius + 1),
+        arColor, arCenter.GetX(), arCenter.GetY(), aRadius);
+}
+
+void DisplayList::DrawLine(const Point &arA, const Point &arB, const Color &arColor)
+{
+    record(Operations::Line,
+        Rect(Point(std::min(arA.GetX(), arB.GetX()), std::min(arA.GetY(), arB.GetY())),
+             Point(std::max(arA.GetX(), arB.GetX()) + 1, std::max(arA.GetY(), arB.GetY()) + 1)),
+        arColor, arA.GetX(), arA.GetY(), arB.GetX(), arB.GetY());
+}
+
+void DisplayList::DrawRectangle(const Rect &arRect, const Color &arColor, bool aFilled)
+{
+    record(aFilled ? Operations::FilledRectangle : Operations::Rectangle,
+        Rect(arRect.GetTopLeft(), arRect.GetWidth() + 1, arRect.GetHeight() + 1), arColor);
+}
+
+void DisplayList::DrawImage(const Point &arLeftTop, const Bitmap &arBitmap)
+{
+    DrawImage(arLeftTop, arBitmap, Rect(0, 0, arBitmap.GetWidth(), arBitmap.GetHeight()));
+}
+
+void DisplayList::DrawImage(const Point &arLeftTop, const Bitmap &arBitmap, const Rect &arSourceRect)
+{
+    // Record the source clipped to the bitmap, so the area is exact
+    Rect src = arSourceRect.Intersection(Rect(0, 0, arBitmap.GetWidth(), arBitmap.GetHeight()));
+    if (src.IsEmpty()) {
+        return;
+    }
+    Point dest(arLeftTop.GetX() + src.GetLeft() - arSourceRect.GetLeft(),
+               arLeftTop.GetY() + src.GetTop() - arSourceRect.GetTop());
+
+    auto it = std::find(mBitmaps.begin(), mBitmaps.end(), &arBitmap);
+    if (it == mBitmaps.end()) {
+        it = mBitmaps.insert(it, &arBitmap);
+    }
+    record(Operations::Image, Rect(dest, src.GetWidth(), src.GetHeight()), Color(0),
+        src.GetLeft(), src.GetTop(), 0, 0, static_cast<uint32_t>(it - mBitmaps.begin()));
+}
+
+void DisplayList::DrawText(const Text &arText, const Color &arColor)
+{
+    mTexts.push_back(&arText);
+    record(Operations::Text, arText.GetArea(), arColor, 0, 0, 0, 0, static_cast<uint32_t>(mTexts.size() - 1));
+}
+
+void DisplayList::Replay(Canvas &arCanvas) const
+{
+    Canvas::BlendModes mode = arCanvas.GetBlendMode();
+
+    for (const Command &cmd : mCommands) {
+        arCanvas.SetBlendMode(cmd.mBlendMode);
+        switch (cmd.mOperation) {
+            case Operations::Line:
+                arCanvas.DrawLine(Point(cmd.mA, cmd.mB), Point(cmd.mC, cmd.mD), Color(cmd.mColor));
+                break;
+
+            case Operations::Circle:
+                arCanvas.DrawCircle(Point(cmd.mA, cmd.mB), cmd.mC, Color(cmd.mColor));
+                break;
+
+            case Operations::Rectangle:
+            case Operations::FilledRectangle:
+                arCanvas.DrawRectangle(Rect(Point(cmd.mLeft, cmd.mTop), Point(cmd.mRight - 1, cmd.mBottom - 1)),
+                    Color(cmd.mColor), cmd.mOperation == Operations::FilledRectangle);
+                break;
+
+            case Operations::Image:
+                arCanvas.DrawImage(Point(cmd.mLeft, cmd.mTop), *mBitmaps[cmd.mResource],
+                    Rect(cmd.mA, cmd.mB, cmd.mRight - cmd.mLeft, cmd.mBottom - cmd.mTop));
+                break;
+
+            default: // Operations::Text
+                arCanvas.DrawText(*mTexts[cmd.mResource], Color(cmd.mColor));
+                break;
+        }
+    }
+
+    arCanvas.SetBlendMode(mode);
+}
+
+void DisplayList::Optimize()
+{
+    cullCovered();
+    mergeFills();
+    groupImages();
+}
+
+void DisplayList::AddDamage(DirtyRegion &arRegion) const
+{
+    for (const Command &cmd : mCommands) {
+        arRegion.Add(areaOf(cmd));
+    }
+}
+
+void DisplayList::Clear()
+{
+    mCommands.clear();
+    mBitmaps.clear();
+    mTexts.clear();
+}
+
+void DisplayList::record(Operations aOperation, const Rect &arArea, const Color &arColor,
+    int32_t aA, int32_t aB, int32_t aC, int32_t aD, uint32_t aResource)
+{
+    mCommands.push_back(Command{arArea.GetLeft(), arArea.GetTop(), arArea.GetRight(), arArea.GetBottom(),
+        aA, aB, aC, aD, static_cast<uint32_t>(arColor), aResource, aOperation, mBlendMode});
+}
+
+void DisplayList::cullCovered()
+{
+    // Walk backwards, collecting the opaque areas drawn later on
+    std::vector<const Command*> occluders;
+    std::vector<Command> kept;
+    kept.reserve(mCommands.size());
+
+    for (auto it = mCommands.rbegin(); it != mCommands.rend(); ++it) {
+        bool covered = std::any_of(occluders.begin(), occluders.end(),
+            [it](const Command *apOccluder) { return contains(*apOccluder, *it); });
+        if (covered) {
+            continue;
+        }
+        kept.push_back(*it);
+        if (isOpaque(*it)) {
+            occluders.push_back(&*it);
+        }
+    }
+
+    std::reverse(kept.begin(), kept.end());
+    mCommands.swap(kept);
+}
+
+void DisplayList::mergeFills()
+{
+    std::vector<Command> merged;
+    merged.reserve(mCommands.size());
+
+    for (const Command &cmd : mCommands) {
+        if (!merged.empty()) {
+            Command &last = merged.back();
+            bool same = (cmd.mOperation == Operations::FilledRectangle) && (last.mOperation == Operations::FilledRectangle)
+                && (cmd.mColor == last.mColor) && (cmd.mBlendMode == last.mBlendMode);
+            bool rows = (cmd.mTop == last.mTop) && (cmd.mBottom == last.mBottom)
+                && ((cmd.mLeft == last.mRight) || (cmd.mRight == last.mLeft));
+            bool columns = (cmd.mLeft == last.mLeft) && (cmd.mRight == last.mRight)
+                && ((cmd.mTop == last.mBottom) || (cmd.mBottom == last.mTop));
+            if (same && (rows || columns)) {
+                last.mLeft = std::min(last.mLeft, cmd.mLeft);
+                last.mTop = std::min(last.mTop, cmd.mTop);
+                last.mRight = std::max(last.mRight, cmd.mRight);
+                last.mBottom = std::max(last.mBottom, cmd.mBottom);
+                continue;
+            }
+        }
+        merged.push_back(cmd);
+    }
+
+    mCommands.swap(merged);
+}
+
+void DisplayList::groupImages()
+{
+    std::vector<Command> grouped;
+    grouped.reserve(mCommands.size());
+
+    for (const Command &cmd : mCommands) {
+        auto insert_at = grouped.end();
+        if (cmd.mOperation == Operations::Image) {
+            // Operations that do not overlap can be drawn in any order
+            for (auto it = grouped.end(); it != grouped.begin(); --it) {
+                const Command &previous = *(it - 1);
+                if ((previous.mOperation == Operations::Image) && (previous.mResource == cmd.mResource)) {
+                    insert_at = it;
+                    break;
+                }
+                if (overlaps(previous, cmd)) {
+                    break;
+                }
+            }
+        }
+        grouped.insert(insert_at, cmd);
+    }
+
+    mCommands.swap(grouped);
+}
+
+} // namespace rsp::graphics
@@ -0,0 +1,201 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <graphics/FrameStatistics.h>
+#include <utils/json/JsonArray.h>
+#include <utils/json/JsonObject.h>
+
+using namespace rsp::utils::json;
+
+namespace rsp::graphics
+{
+
+std::size_t FrameStatistics::bucketIndex(uint64_t aValue)
+{
+    // Values below cSubBuckets have a bucket each, above that each power
+    // of two is split into cSubBuckets buckets.
+    if (aValue < cSubBuckets) {
+        return static_cast<std::size_t>(aValue);
+    }
+    unsigned exponent = static_cast<unsigned>(std::bit_width(aValue)) - 1;
+    if (exponent > cMaxExponent) {
+        return cBuckets - 1;
+    }
+    unsigned shift = exponent - cSubBucketBits;
+    uint64_t sub = (aValue >> shift) & (cSubBuckets - 1);
+    return static_cast<std::size_t>((exponent - cSubBucketBits + 1) * cSubBuckets + sub);
+}
+
+uint64_t FrameStatistics::bucketHighest(std::size_t aIndex)
+{
+    if (aIndex < cSubBuckets) {
+        return aIndex;
+    }
+    unsigned shift = static_cast<unsigned>(aIndex / cSubBuckets) - 1;
+    uint64_t lowest = (cSubBuckets + aIndex % cSubBuckets) << shift;
+    return lowest + (uint64_t(1) << shift) - 1;
+}
+
+void FrameStatistics::Histogram::Add(uint64_t aValue)
+{
+    mCounts[bucketIndex(aValue)].fetch_add(1, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = mMax.load(std::memory_order_relaxed);
+    while ((aValue > max) && !mMax.compare_exchange_weak(max, aValue, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t FrameStatistics::Histogram::GetPercentile(double aFraction) const
+{
+    uint64_t count = mCount.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return 0;
+    }
+    aFraction = std::clamp(aFraction, 0.0, 1.0);
+    uint64_t rank = std::max(uint64_t(1), static_cast<uint64_t>(std::ceil(aFraction * static_cast<double>(count))));
+
+    uint64_t max = mMax.load(std::memory_order_relaxed);
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < cBuckets - 1; i++) {
+        seen += mCounts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucketHighest(i), max);
+        }
+    }
+    // The last bucket also holds all values too large for the others
+    return max;
+}
+
+void FrameStatistics::Histogram::Reset()
+{
+    for (std::atomic<uint64_t> &count : mCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    mCount.store(0, std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+}
+
+void FrameStatistics::Record(const Frame &arFrame)
+{
+    uint64_t number = mWritten.load(std::memory_order_relaxed) + 1;
+
+    mHistograms[static_cast<std::size_t>(Timings::Draw)].Add(arFrame.mDrawTime);
+    mHistograms[static_cast<std::size_t>(Timings::Swap)].Add(arFrame.mSwapTime);
+    mHistograms[static_cast<std::size_t>(Timings::Frame)].Add(arFrame.mDrawTime + arFrame.mSwapTime);
+
+    // The number is cleared while the slot is written, so readers can detect torn entries
+    Slot &slot = mRing[(number - 1) % cRecentFrames];
+    slot.mNumber.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.mDrawTime.store(arFrame.mDrawTime, std::memory_order_relaxed);
+    slot.mSwapTime.store(arFrame.mSwapTime, std::memory_order_relaxed);
+    slot.mPixels.store(arFrame.mPixels, std::memory_order_relaxed);
+    slot.mDirtyArea.store(arFrame.mDirtyArea, std::memory_order_relaxed);
+    slot.mNumber.store(number, std::memory_order_release);
+
+    mWritten.store(number, std::memory_order_release);
+}
+
+uint64_t FrameStatistics::GetFrameCount() const
+{
+    return mWritten.load(std::memory_order_acquire);
+}
+
+uint64_t FrameStatistics::GetPercentile(Timings aTiming, double aFraction) const
+{
+    return mHistograms[static_cast<std::size_t>(aTiming)].GetPercentile(aFraction);
+}
+
+FrameStatistics::Summary FrameStatistics::GetSummary(Timings aTiming) const
+{
+    const Histogram &histogram = mHistograms[static_cast<std::size_t>(aTiming)];
+    return Summary{
+        histogram.mCount.load(std::memory_order_relaxed),
+        histogram.GetPercentile(0.50),
+        histogram.GetPercentile(0.95),
+        histogram.GetPercentile(0.99),
+        histogram.mMax.load(std::memory_order_relaxed)
+    };
+}
+
+std::vector<FrameStatistics::Frame> FrameStatistics::GetRecentFrames() const
+{
+    uint64_t last = mWritten.load(std::memory_order_acquire);
+    uint64_t first = (last > cRecentFrames) ? last - cRecentFrames + 1 : 1;
+
+    std::vector<Frame> result;
+    result.reserve(static_cast<std::size_t>(last - first + 1));
+    for (uint64_t number = first; number <= last; number++) {
+        const Slot &slot = mRing[(number - 1) % cRecentFrames];
+        if (slot.mNumber.load(std::memory_order_acquire) != number) {
+            continue;
+        }
+        Frame frame{
+            number,
+            slot.mDrawTime.load(std::memory_order_relaxed),
+            slot.mSwapTime.load(std::memory_order_relaxed),
+            slot.mPixels.load(std::memory_order_relaxed),
+            slot.mDirtyArea.load(std::memory_order_relaxed)
+        };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Skip entries overwritten by newer frames while they were read
+        if (slot.mNumber.load(std::memory_order_relaxed) == number) {
+            result.push_back(frame);
+        }
+    }
+    return result;
+}
+
+std::string FrameStatistics::ToJson(bool aPrettyPrint) const
+{
+    static const char* cNames[] = { "draw_us", "swap_us", "frame_us" };
+
+    JsonObject root;
+    root.Add("frames", new JsonValue(GetFrameCount()));
+    for (std::size_t i = 0; i < mHistograms.size(); i++) {
+        Summary summary = GetSummary(static_cast<Timings>(i));
+        JsonObject *entry = new JsonObject();
+        entry->Add("p50", new JsonValue(summary.mP50));
+        entry->Add("p95", new JsonValue(summary.mP95));
+        entry->Add("p99", new JsonValue(summary.mP99));
+        entry->Add("max", new JsonValue(summary.mMax));
+        root.Add(cNames[i], entry);
+    }
+
+    JsonArray *recent = new JsonArray();
+    for (const Frame &frame : GetRecentFrames()) {
+        JsonObject *entry = new JsonObject();
+        entry->Add("frame", new JsonValue(frame.mNumber));
+        entry->Add("draw_us", new JsonValue(frame.mDrawTime));
+        entry->Add("swap_us", new JsonValue(frame.mSwapTime));
+        entry->Add("pixels", new JsonValue(frame.mPixels));
+        entry->Add("dirty_area", new JsonValue(frame.mDirtyArea));
+        recent->Add(entry);
+    }
+    root.Add("recent", recent);
+
+    return root.Encode(aPrettyPrint);
+}
+
+void FrameStatistics::Reset()
+{
+    for (Histogram &histogram : mHistograms) {
+        histogram.Reset();
+    }
+    for (Slot &slot : mRing) {
+        slot.mNumber.store(0, std::memory_order_relaxed);
+    }
+    mWritten.store(0, std::memory_order_release);
+}
+
+} // namespace rsp::graphics
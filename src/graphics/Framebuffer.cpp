@@ -10,22 +10,33 @@
 
 #include <graphics/Framebuffer.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
 #include <linux/kd.h>
 #include <sys/ioctl.h>
+#include <string>
 #include <sys/mman.h>
 #include <thread>
 #include <unistd.h>
+#include <graphics/kernels/PixelKernels.h>
+#include <graphics/kernels/TransformKernels.h>
+#include <utils/CoreException.h>
 #include <utils/ExceptionHelper.h>
 
 namespace rsp::graphics
 {
 
-Framebuffer::Framebuffer(const char *apDevPath)
-    : mFramebufferFile(-1)
+// Display rows converted at a time in rotated presentation
+static constexpr int cStripRows = 32;
+
+Framebuffer::Framebuffer(const char *apDevPath, PresentModes aPresentMode, bool aWaitForVSync, Rotations aRotation)
+    : mFramebufferFile(-1),
+      mPresentMode(aPresentMode),
+      mWaitForVSync(aWaitForVSync),
+      mRotation(aRotation)
 {
     if (apDevPath) {
         mFramebufferFile = open(apDevPath, O_RDWR);
@@ -49,13 +60,35 @@ Framebuffer::Framebuffer(const char *apDevPath)
     // set Canvas specific variables
     mWidth = static_cast<int>(mVariableInfo.xres);
     mHeight = static_cast<int>(mVariableInfo.yres);
-    mBytesPerPixel = static_cast<int>(mVariableInfo.bits_per_pixel / 8);
+    switch (mVariableInfo.bits_per_pixel) {
+        case 16:
+            setPixelFormat(PixelFormats::RGB565);
+            break;
+        case 24:
+            setPixelFormat(PixelFormats::RGB888);
+            break;
+        case 32:
+            setPixelFormat(PixelFormats::XRGB8888);
+            break;
+        default:
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Unsupported framebuffer pixel format: " + std::to_string(mVariableInfo.bits_per_pixel) + " bits per pixel");
+    }
     std::clog << "Framebuffer opened. Width=" << mWidth << " Height=" << mHeight << " BytesPerPixel=" << mBytesPerPixel << std::endl;
 
-    // set yres_virtual for double buffering
-    mVariableInfo.yres_virtual = mVariableInfo.yres * 2;
+    // set yres_virtual for double or triple buffering
+    unsigned buffer_count = (mPresentMode == PresentModes::Threaded) ? 3 : 2;
+    mVariableInfo.yres_virtual = mVariableInfo.yres * buffer_count;
     if (ioctl(mFramebufferFile, FBIOPUT_VSCREENINFO, &mVariableInfo) == -1) {
-        THROW_SYSTEM("Framebuffer ioctl FBIOPUT_VSCREENINFO failed");
+        if (buffer_count == 2) {
+            THROW_SYSTEM("Framebuffer ioctl FBIOPUT_VSCREENINFO failed");
+        }
+        std::clog << "Framebuffer has no room for three buffers, presenting synchronously" << std::endl;
+        mPresentMode = PresentModes::Synchronous;
+        buffer_count = 2;
+        mVariableInfo.yres_virtual = mVariableInfo.yres * buffer_count;
+        if (ioctl(mFramebufferFile, FBIOPUT_VSCREENINFO, &mVariableInfo) == -1) {
+            THROW_SYSTEM("Framebuffer ioctl FBIOPUT_VSCREENINFO failed");
+        }
     }
 
     // stop the console from drawing ontop of this programs graphics
@@ -69,22 +102,58 @@ Framebuffer::Framebuffer(const char *apDevPath)
     // calculate size of screen
     unsigned long screensize = static_cast<unsigned long>(mVariableInfo.yres) * mFixedInfo.line_length;
 
-    mpFrontBuffer = static_cast<uint8_t *>(mmap(0, static_cast<size_t>(screensize * 2), PROT_READ | PROT_WRITE, MAP_SHARED, mFramebufferFile, static_cast<off_t>(0)));
-    if (mpFrontBuffer == reinterpret_cast<uint8_t *>(-1)) /*MAP_FAILED*/ {
+    uint8_t *mapping = static_cast<uint8_t *>(mmap(0, static_cast<size_t>(screensize * buffer_count), PROT_READ | PROT_WRITE, MAP_SHARED, mFramebufferFile, static_cast<off_t>(0)));
+    if (mapping == reinterpret_cast<uint8_t *>(-1)) /*MAP_FAILED*/ {
         THROW_SYSTEM("Framebuffer shared memory mapping failed");
     }
 
-    mpBackBuffer = mpFrontBuffer + screensize;
+    // Let the buffer pointers point to the first visible pixel
+    mapping += mVariableInfo.xoffset * (mVariableInfo.bits_per_pixel / 8);
+    for (unsigned i = 0; i < buffer_count; i++) {
+        mBuffers[i] = mapping + i * screensize;
+    }
+    mStride = mFixedInfo.line_length;
+
+    mDisplayed = static_cast<int>(mVariableInfo.yoffset / mVariableInfo.yres);
+    if (mDisplayed >= static_cast<int>(buffer_count)) {
+        mDisplayed = 0;
+    }
+    mBackIndex = (mDisplayed + 1) % static_cast<int>(buffer_count);
+    mpFrontBuffer = mBuffers[static_cast<std::size_t>(mDisplayed)];
+    mpBackBuffer = mBuffers[static_cast<std::size_t>(mBackIndex)];
 
-    if (mVariableInfo.yoffset > 0) {
-        uint8_t *tmp = mpFrontBuffer;
-        mpFrontBuffer = mpBackBuffer;
-        mpBackBuffer = tmp;
+    if (mRotation != Rotations::None) {
+        // Draw in memory buffers in the logical orientation
+        mDisplayFormat = mPixelFormat;
+        mDisplayStride = mStride;
+        setPixelFormat(PixelFormats::XRGB8888);
+        if ((mRotation == Rotations::Clockwise90) || (mRotation == Rotations::Clockwise270)) {
+            std::swap(mWidth, mHeight);
+        }
+        std::size_t pixels = static_cast<std::size_t>(mWidth) * static_cast<std::size_t>(mHeight);
+        mLogicalPixels.assign(2 * pixels, 0);
+        mStride = static_cast<std::size_t>(mWidth) * sizeof(uint32_t);
+        mpFrontBuffer = reinterpret_cast<uint8_t*>(mLogicalPixels.data());
+        mpBackBuffer = reinterpret_cast<uint8_t*>(mLogicalPixels.data() + pixels);
+        std::clog << "Framebuffer rotated " << 90 * static_cast<int>(mRotation) << " degrees. Width=" << mWidth << " Height=" << mHeight << std::endl;
+    }
+
+    if (mPresentMode == PresentModes::Threaded) {
+        mPresenter = std::thread(&Framebuffer::presenterLoop, this);
     }
 }
 
 Framebuffer::~Framebuffer()
 {
+    // Let the presenter show the last frame and stop
+    if (mPresenter.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mWake.notify_one();
+        mPresenter.join();
+    }
     // At exit we MUST release the tty again
     if (mTtyFb > 0) {
         if (ioctl(mTtyFb, KDSETMODE, KD_TEXT) == -1) {
@@ -100,73 +169,207 @@ Framebuffer::~Framebuffer()
 
 void Framebuffer::SwapBuffer(const SwapOperations aSwapOp, Color aColor)
 {
-    // swap buffer
-    if (mVariableInfo.yoffset == 0) {
-        mVariableInfo.yoffset = mVariableInfo.yres;
-    } else {
-        mVariableInfo.yoffset = 0;
+    beginSwap();
+    if (mRotation != Rotations::None) {
+        presentRotated(mBackIndex);
     }
-    // Pan to back buffer
-    if (ioctl(mFramebufferFile, FBIOPAN_DISPLAY, &mVariableInfo) == -1) {
-        std::cout << "ioctl FBIOPAN_DISPLAY failed errno:" << strerror(errno) << std::endl;
+    if (mPresentMode == PresentModes::Threaded) {
+        swapThreaded(aSwapOp, aColor);
+        return;
     }
 
+    // Pan to back buffer
+    pan(mBackIndex);
+
     // update pointers
-    uint8_t *tmp = mpFrontBuffer;
-    mpFrontBuffer = mpBackBuffer;
-    mpBackBuffer = tmp;
+    mDisplayed = mBackIndex;
+    mBackIndex = 1 - mBackIndex;
+    selectBuffers(mDisplayed, mBackIndex);
+
+    prepareBackBuffer(aSwapOp, aColor);
+}
 
-    switch (aSwapOp) {
-    case SwapOperations::Copy:
-        copy();
-        break;
+void Framebuffer::selectBuffers(int aFront, int aBack)
+{
+    if (mRotation == Rotations::None) {
+        mpFrontBuffer = mBuffers[static_cast<std::size_t>(aFront)];
+        mpBackBuffer = mBuffers[static_cast<std::size_t>(aBack)];
+    }
+    else {
+        // The display buffers are only written by presentRotated
+        std::swap(mpFrontBuffer, mpBackBuffer);
+    }
+}
 
-    case SwapOperations::Clear:
-        clear(aColor);
-        break;
+void Framebuffer::presentRotated(int aIndex)
+{
+    // The back buffer differs from the front buffer in the dirty region, or anywhere if not in sync
+    std::size_t buffer_count = (mPresentMode == PresentModes::Threaded) ? 3 : 2;
+    for (std::size_t i = 0; i < buffer_count; i++) {
+        DirtyRegion &stale = mStaleRegions[i];
+        if (mBuffersInSync) {
+            for (const Rect &r : mDirtyRegion.GetRects()) {
+                stale.Add(r);
+            }
+        }
+        else {
+            stale.Add(Rect(0, 0, mWidth, mHeight));
+        }
+    }
 
-    case SwapOperations::NoOp:
-    default:
-        break;
+    DirtyRegion &stale = mStaleRegions[static_cast<std::size_t>(aIndex)];
+    for (const Rect &r : stale.GetRects()) {
+        rotateRect(r, mBuffers[static_cast<std::size_t>(aIndex)]);
     }
+    stale.Clear();
 }
 
-uint32_t Framebuffer::GetPixel(const Point &aPoint, const bool aFront) const
+void Framebuffer::rotateRect(const Rect &arRect, uint8_t *apDisplay)
 {
-    if (!IsInsideScreen(aPoint)) {
-        return 0;
+    unsigned turns = static_cast<unsigned>(mRotation);
+    const uint32_t *src = reinterpret_cast<const uint32_t*>(pixelAddress(mpBackBuffer, arRect.GetLeft(), arRect.GetTop()));
+    std::size_t src_stride = static_cast<std::size_t>(mWidth);
+    Rect target = displayRect(arRect);
+
+    if (mDisplayFormat == PixelFormats::XRGB8888) {
+        uint32_t *dst = reinterpret_cast<uint32_t*>(apDisplay + static_cast<std::size_t>(target.GetTop()) * mDisplayStride) + target.GetLeft();
+        TransformKernels::Rotate(dst, mDisplayStride / sizeof(uint32_t), src, src_stride,
+            static_cast<std::size_t>(arRect.GetWidth()), static_cast<std::size_t>(arRect.GetHeight()), turns);
+        return;
     }
-    long location = (aPoint.mX + static_cast<int>(mVariableInfo.xoffset)) * static_cast<int>(mVariableInfo.bits_per_pixel / 8) + aPoint.mY * static_cast<int>(mFixedInfo.line_length);
-    if (aFront) {
-        return *(reinterpret_cast<uint32_t *>(mpFrontBuffer + location));
-    } else {
-        return *(reinterpret_cast<uint32_t *>(mpBackBuffer + location));
+
+    // Other formats are rotated into a strip of display rows at a time, then converted
+    const PixelKernels::Table &kernels = PixelKernels::Get(mDisplayFormat);
+    bool odd = (turns & 1) != 0;
+    int length = odd ? arRect.GetWidth() : arRect.GetHeight();
+    for (int offset = 0; offset < length; offset += cStripRows) {
+        int rows = std::min(cStripRows, length - offset);
+        Rect strip = odd ? Rect(arRect.GetLeft() + offset, arRect.GetTop(), rows, arRect.GetHeight())
+                         : Rect(arRect.GetLeft(), arRect.GetTop() + offset, arRect.GetWidth(), rows);
+        Rect strip_target = displayRect(strip);
+        std::size_t width = static_cast<std::size_t>(strip_target.GetWidth());
+        mRotatedPixels.resize(width * static_cast<std::size_t>(rows));
+        TransformKernels::Rotate(mRotatedPixels.data(), width,
+            reinterpret_cast<const uint32_t*>(pixelAddress(mpBackBuffer, strip.GetLeft(), strip.GetTop())), src_stride,
+            static_cast<std::size_t>(strip.GetWidth()), static_cast<std::size_t>(strip.GetHeight()), turns);
+
+        uint8_t *dst = apDisplay + static_cast<std::size_t>(strip_target.GetTop()) * mDisplayStride
+            + static_cast<std::size_t>(strip_target.GetLeft()) * kernels.mBytesPerPixel;
+        for (std::size_t y = 0; y < static_cast<std::size_t>(rows); y++, dst += mDisplayStride) {
+            kernels.fromArgb(dst, mRotatedPixels.data() + y * width, width);
+        }
+    }
+}
+
+Rect Framebuffer::displayRect(const Rect &arRect) const
+{
+    switch (mRotation) {
+        case Rotations::Clockwise90:
+            return Rect(mHeight - arRect.GetBottom(), arRect.GetLeft(), arRect.GetHeight(), arRect.GetWidth());
+
+        case Rotations::Clockwise180:
+            return Rect(mWidth - arRect.GetRight(), mHeight - arRect.GetBottom(), arRect.GetWidth(), arRect.GetHeight());
+
+        case Rotations::Clockwise270:
+            return Rect(arRect.GetTop(), mWidth - arRect.GetRight(), arRect.GetHeight(), arRect.GetWidth());
+
+        case Rotations::None:
+        default:
+            return arRect;
+    }
+}
+
+void Framebuffer::pan(int aIndex)
+{
+    mVariableInfo.yoffset = mVariableInfo.yres * static_cast<unsigned>(aIndex);
+    if (ioctl(mFramebufferFile, FBIOPAN_DISPLAY, &mVariableInfo) == -1) {
+        std::cout << "ioctl FBIOPAN_DISPLAY failed errno:" << strerror(errno) << std::endl;
+    }
+    if (mWaitForVSync) {
+        uint32_t crtc = 0;
+        if (ioctl(mFramebufferFile, FBIO_WAITFORVSYNC, &crtc) == -1) {
+            std::clog << "ioctl FBIO_WAITFORVSYNC failed errno:" << strerror(errno) << ", no longer waiting for vsync" << std::endl;
+            mWaitForVSync = false;
+        }
     }
 }
 
-void Framebuffer::clear(Color aColor)
+void Framebuffer::presenterLoop()
 {
-    long x, y;
-    // draw to back buffer
-    //     std::cout << "Clearing buffer" << std::endl;
-    for (y = 0; y < mVariableInfo.yres; y++) {
-        for (x = 0; x < mVariableInfo.xres; x++) {
-            long location = (x + mVariableInfo.xoffset) * (mVariableInfo.bits_per_pixel / 8) + y * mFixedInfo.line_length;
-            *(reinterpret_cast<uint32_t *>(mpBackBuffer + location)) = aColor;
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        mWake.wait(lock, [this]() { return mStop || (mPending != cNoBuffer); });
+        if (mPending == cNoBuffer) {
+            return;
         }
+        int index = mPending;
+        mPending = cNoBuffer;
+        mPresenting = index;
+
+        lock.unlock();
+        pan(index);
+        lock.lock();
+
+        // The previously displayed buffer is no longer scanned out
+        mDisplayed = index;
+        mPresenting = cNoBuffer;
+        mPresented.notify_all();
     }
 }
 
-void Framebuffer::copy()
+void Framebuffer::swapThreaded(SwapOperations aSwapOp, Color aColor)
 {
-    long x, y;
-    // copy front buffer to back buffer
-    for (y = 0; y < mVariableInfo.yres; y++) {
-        for (x = 0; x < mVariableInfo.xres; x++) {
-            long location = (x + mVariableInfo.xoffset) * (mVariableInfo.bits_per_pixel / 8) + y * mFixedInfo.line_length;
-            *(reinterpret_cast<uint32_t *>(mpBackBuffer + location)) = *(reinterpret_cast<uint32_t *>(mpFrontBuffer + location));
+    int finished = mBackIndex;
+    mBufferFrames[static_cast<std::size_t>(finished)] = ++mFrame;
+
+    int next = cNoBuffer;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mPending != cNoBuffer) {
+            // The presenter did not get to the previous frame, skip it
+            next = mPending;
+        }
+        else {
+            // Only waits if a pan is in progress, as then all three buffers are in use
+            mPresented.wait(lock, [this, finished, &next]() {
+                for (int i = 0; i < 3; i++) {
+                    if ((i != finished) && (i != mDisplayed) && (i != mPresenting)) {
+                        next = i;
+                        return true;
+                    }
+                }
+                return false;
+            });
         }
+        mPending = finished;
     }
+    mWake.notify_one();
+
+    mBackIndex = next;
+    selectBuffers(finished, next);
+    if (mRotation != Rotations::None) {
+        // The canvas buffers are double buffered, independent of the display buffers
+        prepareBackBuffer(aSwapOp, aColor);
+        return;
+    }
+
+    // The new back buffer holds the frame before the one just finished, or an older one.
+    // Bring it up to date from the dirty regions of the frames it missed.
+    DirtyRegion dirty = mDirtyRegion;
+    bool in_sync = mBuffersInSync;
+    uint64_t age = mFrame - mBufferFrames[static_cast<std::size_t>(next)];
+    if ((age == 2) && mPreviousInSync) {
+        for (const Rect &r : mPreviousDirtyRegion.GetRects()) {
+            mDirtyRegion.Add(r);
+        }
+    }
+    else if (age != 1) {
+        mBuffersInSync = false;
+    }
+    mPreviousDirtyRegion = dirty;
+    mPreviousInSync = in_sync;
+
+    prepareBackBuffer(aSwapOp, aColor);
 }
 
 } // namespace rsp::graphics
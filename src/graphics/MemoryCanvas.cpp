@@ -0,0 +1,92 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <algorithm>
+#include <graphics/MemoryCanvas.h>
+#include <graphics/kernels/PixelKernels.h>
+#include <posix/FileIO.h>
+#include <utils/CoreException.h>
+#include <utils/ExceptionHelper.h>
+#include <utils/StrUtils.h>
+
+namespace rsp::graphics
+{
+
+MemoryCanvas::MemoryCanvas(int aWidth, int aHeight, std::size_t aStride, PixelFormats aFormat)
+    : BufferedCanvas(),
+      mBuffers()
+{
+    mWidth = aWidth;
+    mHeight = aHeight;
+    setPixelFormat(aFormat);
+    mStride = aStride ? aStride : (static_cast<std::size_t>(aWidth * mBytesPerPixel) + 3) & ~std::size_t(3);
+    if ((aWidth <= 0) || (aHeight <= 0) || (mStride < static_cast<std::size_t>(aWidth * mBytesPerPixel)) || (mStride % 4)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid MemoryCanvas dimensions");
+    }
+
+    std::size_t size = mStride * static_cast<std::size_t>(aHeight);
+    mBuffers.resize(size * 2, 0);
+    mpFrontBuffer = mBuffers.data();
+    mpBackBuffer = mBuffers.data() + size;
+}
+
+void MemoryCanvas::SwapBuffer(const SwapOperations aSwapOp, Color aColor)
+{
+    beginSwap();
+    std::swap(mpFrontBuffer, mpBackBuffer);
+    mFrameCount++;
+
+    if (!mFrameDumpPattern.empty()) {
+        SaveBmp(rsp::utils::StrUtils::Format(mFrameDumpPattern.c_str(), mFrameCount));
+    }
+
+    prepareBackBuffer(aSwapOp, aColor);
+}
+
+void MemoryCanvas::SaveBmp(const std::string &arFileName, bool aFront) const
+{
+    const uint32_t row_size = (static_cast<uint32_t>(mWidth) * 3 + 3) & ~3u;
+    const uint32_t data_size = row_size * static_cast<uint32_t>(mHeight);
+
+    // BITMAPFILEHEADER followed by a BITMAPINFOHEADER, all little endian
+    uint8_t header[54] = { 'B', 'M' };
+    auto put32 = [&header](std::size_t aOffset, uint32_t aValue) {
+        for (std::size_t i = 0; i < 4; i++) {
+            header[aOffset + i] = static_cast<uint8_t>(aValue >> (8 * i));
+        }
+    };
+    put32(2, sizeof(header) + data_size);
+    put32(10, sizeof(header));
+    put32(14, 40);
+    put32(18, static_cast<uint32_t>(mWidth));
+    put32(22, static_cast<uint32_t>(mHeight)); // Positive height, rows are stored bottom up
+    header[26] = 1;  // Planes
+    header[28] = 24; // Bits per pixel
+    put32(34, data_size);
+
+    rsp::posix::FileIO file(arFileName, std::ios_base::out | std::ios_base::trunc, 0664);
+    file.Write(header, sizeof(header));
+
+    const uint8_t *buffer = aFront ? mpFrontBuffer : mpBackBuffer;
+    std::vector<uint8_t> row(row_size, 0);
+    std::vector<uint32_t> pixels(static_cast<std::size_t>(mWidth));
+    // Rows are stored bottom up
+    for (std::size_t y = static_cast<std::size_t>(mHeight); y > 0; y--) {
+        mpPixelKernels->toArgb(pixels.data(), buffer + (y - 1) * mStride, pixels.size());
+        for (std::size_t x = 0; x < pixels.size(); x++) {
+            row[x * 3 + 0] = static_cast<uint8_t>(pixels[x]);
+            row[x * 3 + 1] = static_cast<uint8_t>(pixels[x] >> 8);
+            row[x * 3 + 2] = static_cast<uint8_t>(pixels[x] >> 16);
+        }
+        file.Write(row.data(), row.size());
+    }
+}
+
+} // namespace rsp::graphics
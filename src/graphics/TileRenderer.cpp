@@ -0,0 +1,257 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <algorithm>
+#include <graphics/TileRenderer.h>
+#include <graphics/primitives/Bitmap.h>
+#include <utils/CoreException.h>
+#include <utils/ExceptionHelper.h>
+
+namespace rsp::graphics
+{
+
+/**
+ * Canvas drawing into the back buffer of the target canvas, with its own
+ * clip stack and blend mode, so each thread can have one.
+ */
+class TileRenderer::TileCanvas : public BufferedCanvas
+{
+  public:
+    void Attach(const BufferedCanvas &arTarget, const Rect &arClip)
+    {
+        shareBackBuffer(arTarget);
+        mClipStack.clear();
+        PushClipRect(arClip);
+    }
+
+    void Detach(BufferedCanvas &arTarget)
+    {
+        forwardPixelsTouched(arTarget);
+    }
+
+    void SwapBuffer(const SwapOperations /*aSwapOp*/, Color /*aColor*/) override
+    {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "A tile canvas can not swap buffers");
+    }
+
+    void Invalidate(const Rect &/*arRect*/) override
+    {
+        // The renderer invalidates the target canvas
+    }
+};
+
+unsigned TileRenderer::GetDefaultWorkerCount()
+{
+    unsigned cores = std::thread::hardware_concurrency();
+    return (cores > 1) ? cores - 1 : 0;
+}
+
+TileRenderer::TileRenderer(BufferedCanvas &arCanvas, unsigned aWorkers, int aTileSize)
+    : mrCanvas(arCanvas),
+      mTileSize(aTileSize)
+{
+    if (aTileSize <= 0) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Tile size must be positive");
+    }
+
+    for (unsigned i = 0; i <= aWorkers; i++) {
+        mTileCanvases.push_back(std::make_unique<TileCanvas>());
+    }
+    for (unsigned i = 0; i < aWorkers; i++) {
+        mWorkers.emplace_back(&TileRenderer::workerLoop, this, i + 1);
+    }
+}
+
+TileRenderer::~TileRenderer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_all();
+    for (std::thread &worker : mWorkers) {
+        worker.join();
+    }
+}
+
+void TileRenderer::DrawCircle(const Point &arCenter, int aRadius, const Color &arColor)
+{
+    if (aRadius < 0) {
+        return;
+    }
+    record(Rect(arCenter.GetX() - aRadius, arCenter.GetY() - aRadius, 2 * aRadius + 1, 2 * aRadius + 1),
+        [=](Canvas &arCanvas) { arCanvas.DrawCircle(arCenter, aRadius, arColor); });
+}
+
+void TileRenderer::DrawLine(const Point &arA, const Point &arB, const Color &arColor)
+{
+    record(Rect(Point(std::min(arA.GetX(), arB.GetX()), std::min(arA.GetY(), arB.GetY())),
+                Point(std::max(arA.GetX(), arB.GetX()) + 1, std::max(arA.GetY(), arB.GetY()) + 1)),
+        [=](Canvas &arCanvas) { arCanvas.DrawLine(arA, arB, arColor); });
+}
+
+void TileRenderer::DrawRectangle(const Rect &arRect, const Color &arColor, bool aFilled)
+{
+    record(Rect(arRect.GetTopLeft(), arRect.GetWidth() + 1, arRect.GetHeight() + 1),
+        [=](Canvas &arCanvas) { arCanvas.DrawRectangle(arRect, arColor, aFilled); });
+}
+
+void TileRenderer::DrawImage(const Point &arLeftTop, const Bitmap &arBitmap)
+{
+    DrawImage(arLeftTop, arBitmap, Rect(0, 0, arBitmap.GetWidth(), arBitmap.GetHeight()));
+}
+
+void TileRenderer::DrawImage(const Point &arLeftTop, const Bitmap &arBitmap, const Rect &arSourceRect)
+{
+    const Bitmap *bitmap = &arBitmap;
+    record(Rect(arLeftTop, arSourceRect.GetWidth(), arSourceRect.GetHeight()),
+        [=](Canvas &arCanvas) { arCanvas.DrawImage(arLeftTop, *bitmap, arSourceRect); });
+}
+
+void TileRenderer::DrawText(const Text &arText, const Color &arColor)
+{
+    const Text *text = &arText;
+    record(arText.GetArea(), [=](Canvas &arCanvas) { arCanvas.DrawText(*text, arColor); });
+}
+
+void TileRenderer::Clear()
+{
+    mCommands.clear();
+}
+
+void TileRenderer::Render()
+{
+    if (mCommands.empty()) {
+        return;
+    }
+    Rect clip = mrCanvas.GetClipRect();
+    binCommands(clip);
+
+    for (auto &canvas : mTileCanvases) {
+        canvas->Attach(mrCanvas, clip);
+    }
+    mNextTile = 0;
+    mError = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBusy = static_cast<unsigned>(mWorkers.size());
+        mGeneration++;
+    }
+    mWake.notify_all();
+
+    renderTiles(*mTileCanvases[0]);
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]() { return mBusy == 0; });
+    }
+
+    for (auto &canvas : mTileCanvases) {
+        canvas->Detach(mrCanvas);
+    }
+
+    for (const Command &command : mCommands) {
+        mrCanvas.Invalidate(command.mBounds.Intersection(clip));
+    }
+    mCommands.clear();
+
+    if (mError) {
+        std::rethrow_exception(mError);
+    }
+}
+
+void TileRenderer::record(const Rect &arBounds, std::function<void(Canvas&)> aDraw)
+{
+    mCommands.push_back(Command{arBounds, mBlendMode, std::move(aDraw)});
+}
+
+void TileRenderer::binCommands(const Rect &arClip)
+{
+    int columns = (mrCanvas.GetWidth() + mTileSize - 1) / mTileSize;
+    int rows = (mrCanvas.GetHeight() + mTileSize - 1) / mTileSize;
+    if (mTiles.size() != static_cast<std::size_t>(columns * rows)) {
+        mTiles.clear();
+        for (int row = 0; row < rows; row++) {
+            for (int column = 0; column < columns; column++) {
+                mTiles.push_back(Tile{Rect(column * mTileSize, row * mTileSize, mTileSize, mTileSize), {}});
+            }
+        }
+    }
+    for (std::size_t i = 0; i < mTiles.size(); i++) {
+        int row = static_cast<int>(i) / columns;
+        int column = static_cast<int>(i) % columns;
+        mTiles[i].mArea = Rect(column * mTileSize, row * mTileSize, mTileSize, mTileSize).Intersection(arClip);
+        mTiles[i].mCommands.clear();
+    }
+
+    for (std::size_t i = 0; i < mCommands.size(); i++) {
+        Rect bounds = mCommands[i].mBounds.Intersection(arClip);
+        if (bounds.IsEmpty()) {
+            continue;
+        }
+        int last_column = (bounds.GetRight() - 1) / mTileSize;
+        int last_row = (bounds.GetBottom() - 1) / mTileSize;
+        for (int row = bounds.GetTop() / mTileSize; row <= last_row; row++) {
+            for (int column = bounds.GetLeft() / mTileSize; column <= last_column; column++) {
+                mTiles[static_cast<std::size_t>(row * columns + column)].mCommands.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+}
+
+void TileRenderer::renderTiles(TileCanvas &arCanvas)
+{
+    try {
+        for (std::size_t t = mNextTile++; t < mTiles.size(); t = mNextTile++) {
+            const Tile &tile = mTiles[t];
+            if (tile.mCommands.empty() || tile.mArea.IsEmpty()) {
+                continue;
+            }
+            arCanvas.PushClipRect(tile.mArea);
+            for (uint32_t index : tile.mCommands) {
+                const Command &command = mCommands[index];
+                arCanvas.SetBlendMode(command.mBlendMode);
+                command.mDraw(arCanvas);
+            }
+            arCanvas.PopClipRect();
+        }
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mError) {
+            mError = std::current_exception();
+        }
+        mNextTile = mTiles.size();
+    }
+}
+
+void TileRenderer::workerLoop(std::size_t aIndex)
+{
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        mWake.wait(lock, [this, generation]() { return mStop || (mGeneration != generation); });
+        if (mStop) {
+            return;
+        }
+        generation = mGeneration;
+
+        lock.unlock();
+        renderTiles(*mTileCanvases[aIndex]);
+        lock.lock();
+
+        if (--mBusy == 0) {
+            mDone.notify_one();
+        }
+    }
+}
+
+} // namespace rsp::graphics
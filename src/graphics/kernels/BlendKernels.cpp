@@ -0,0 +1,368 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include "BlendKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define BLEND_KERNELS_X86
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define BLEND_KERNELS_NEON
+#endif
+
+namespace rsp::graphics::BlendKernels {
+
+using Modes = Canvas::BlendModes;
+
+/**
+ * Common signature for row and fill kernels. Row kernels read apSrc, fill kernels use aColor.
+ */
+typedef void (*BlendFunc_t)(uint32_t *apDst, const uint32_t *apSrc, uint32_t aColor, std::size_t aCount);
+
+struct KernelTable {
+    BlendFunc_t row[4];
+    BlendFunc_t fill[4];
+};
+
+static constexpr uint32_t cAlphaMask = 0xFF000000;
+
+/**
+ * Rounded division by 255, exact for all products of two 8 bit values.
+ */
+static inline uint32_t div255(uint32_t aValue)
+{
+    aValue += 128;
+    return (aValue + (aValue >> 8)) >> 8;
+}
+
+template <Modes M>
+static inline uint32_t blendScalar(uint32_t aDst, uint32_t aSrc)
+{
+    uint32_t alpha = aSrc >> 24;
+    uint32_t inv_alpha = 255 - alpha;
+    uint32_t result = 0;
+
+    if constexpr (M != Modes::PremultipliedSourceOver) {
+        aSrc |= cAlphaMask;
+    }
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        uint32_t s = (aSrc >> shift) & 0xFF;
+        uint32_t d = (aDst >> shift) & 0xFF;
+        uint32_t c;
+        if constexpr (M == Modes::SourceOver) {
+            c = div255(s * alpha + d * inv_alpha);
+        }
+        else if constexpr (M == Modes::PremultipliedSourceOver) {
+            c = std::min(255u, s + div255(d * inv_alpha));
+        }
+        else {
+            c = std::min(255u, d + div255(s * alpha));
+        }
+        result |= c << shift;
+    }
+    return result;
+}
+
+template <Modes M, bool cFill>
+static void blendRowScalar(uint32_t *apDst, const uint32_t *apSrc, uint32_t aColor, std::size_t aCount)
+{
+    for (std::size_t i = 0; i < aCount; i++) {
+        apDst[i] = blendScalar<M>(apDst[i], cFill ? aColor : apSrc[i]);
+    }
+}
+
+static void copyRow(uint32_t *apDst, const uint32_t *apSrc, uint32_t /*aColor*/, std::size_t aCount)
+{
+    std::memmove(apDst, apSrc, aCount * sizeof(uint32_t));
+}
+
+static void copyFill(uint32_t *apDst, const uint32_t * /*apSrc*/, uint32_t aColor, std::size_t aCount)
+{
+    std::fill_n(apDst, aCount, aColor);
+}
+
+#ifdef BLEND_KERNELS_X86
+
+static inline __m128i div255Sse2(__m128i aValue)
+{
+    aValue = _mm_add_epi16(aValue, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(aValue, _mm_srli_epi16(aValue, 8)), 8);
+}
+
+/**
+ * Blend 4 pixels. Works on 2 pixels at a time, with one channel per 16 bit lane.
+ */
+template <Modes M>
+static inline __m128i blend4Sse2(__m128i aDst, __m128i aSrc)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c255 = _mm_set1_epi16(255);
+
+    __m128i a_lo = _mm_unpacklo_epi8(aSrc, zero);
+    __m128i a_hi = _mm_unpackhi_epi8(aSrc, zero);
+    a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a_lo, 0xFF), 0xFF);
+    a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a_hi, 0xFF), 0xFF);
+    __m128i ia_lo = _mm_sub_epi16(c255, a_lo);
+    __m128i ia_hi = _mm_sub_epi16(c255, a_hi);
+
+    if constexpr (M != Modes::PremultipliedSourceOver) {
+        aSrc = _mm_or_si128(aSrc, _mm_set1_epi32(static_cast<int>(cAlphaMask)));
+    }
+    __m128i s_lo = _mm_unpacklo_epi8(aSrc, zero);
+    __m128i s_hi = _mm_unpackhi_epi8(aSrc, zero);
+    __m128i d_lo = _mm_unpacklo_epi8(aDst, zero);
+    __m128i d_hi = _mm_unpackhi_epi8(aDst, zero);
+
+    if constexpr (M == Modes::SourceOver) {
+        __m128i lo = div255Sse2(_mm_add_epi16(_mm_mullo_epi16(s_lo, a_lo), _mm_mullo_epi16(d_lo, ia_lo)));
+        __m128i hi = div255Sse2(_mm_add_epi16(_mm_mullo_epi16(s_hi, a_hi), _mm_mullo_epi16(d_hi, ia_hi)));
+        return _mm_packus_epi16(lo, hi);
+    }
+    else if constexpr (M == Modes::PremultipliedSourceOver) {
+        __m128i lo = div255Sse2(_mm_mullo_epi16(d_lo, ia_lo));
+        __m128i hi = div255Sse2(_mm_mullo_epi16(d_hi, ia_hi));
+        return _mm_adds_epu8(aSrc, _mm_packus_epi16(lo, hi));
+    }
+    else {
+        __m128i lo = div255Sse2(_mm_mullo_epi16(s_lo, a_lo));
+        __m128i hi = div255Sse2(_mm_mullo_epi16(s_hi, a_hi));
+        return _mm_adds_epu8(aDst, _mm_packus_epi16(lo, hi));
+    }
+}
+
+template <Modes M, bool cFill>
+static void blendRowSse2(uint32_t *apDst, const uint32_t *apSrc, uint32_t aColor, std::size_t aCount)
+{
+    const __m128i color = _mm_set1_epi32(static_cast<int>(aColor));
+    std::size_t i = 0;
+    for (; (i + 4) <= aCount; i += 4) {
+        __m128i *dst = reinterpret_cast<__m128i*>(apDst + i);
+        __m128i src = cFill ? color : _mm_loadu_si128(reinterpret_cast<const __m128i*>(apSrc + i));
+        _mm_storeu_si128(dst, blend4Sse2<M>(_mm_loadu_si128(dst), src));
+    }
+    for (; i < aCount; i++) {
+        apDst[i] = blendScalar<M>(apDst[i], cFill ? aColor : apSrc[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+static inline __m256i div255Avx2(__m256i aValue)
+{
+    aValue = _mm256_add_epi16(aValue, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(aValue, _mm256_srli_epi16(aValue, 8)), 8);
+}
+
+/**
+ * Blend 8 pixels, same lane layout as the SSE2 version within each 128 bit half.
+ */
+template <Modes M>
+__attribute__((target("avx2")))
+static inline __m256i blend8Avx2(__m256i aDst, __m256i aSrc)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c255 = _mm256_set1_epi16(255);
+
+    __m256i a_lo = _mm256_unpacklo_epi8(aSrc, zero);
+    __m256i a_hi = _mm256_unpackhi_epi8(aSrc, zero);
+    a_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(a_lo, 0xFF), 0xFF);
+    a_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(a_hi, 0xFF), 0xFF);
+    __m256i ia_lo = _mm256_sub_epi16(c255, a_lo);
+    __m256i ia_hi = _mm256_sub_epi16(c255, a_hi);
+
+    if constexpr (M != Modes::PremultipliedSourceOver) {
+        aSrc = _mm256_or_si256(aSrc, _mm256_set1_epi32(static_cast<int>(cAlphaMask)));
+    }
+    __m256i s_lo = _mm256_unpacklo_epi8(aSrc, zero);
+    __m256i s_hi = _mm256_unpackhi_epi8(aSrc, zero);
+    __m256i d_lo = _mm256_unpacklo_epi8(aDst, zero);
+    __m256i d_hi = _mm256_unpackhi_epi8(aDst, zero);
+
+    if constexpr (M == Modes::SourceOver) {
+        __m256i lo = div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(s_lo, a_lo), _mm256_mullo_epi16(d_lo, ia_lo)));
+        __m256i hi = div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(s_hi, a_hi), _mm256_mullo_epi16(d_hi, ia_hi)));
+        return _mm256_packus_epi16(lo, hi);
+    }
+    else if constexpr (M == Modes::PremultipliedSourceOver) {
+        __m256i lo = div255Avx2(_mm256_mullo_epi16(d_lo, ia_lo));
+        __m256i hi = div255Avx2(_mm256_mullo_epi16(d_hi, ia_hi));
+        return _mm256_adds_epu8(aSrc, _mm256_packus_epi16(lo, hi));
+    }
+    else {
+        __m256i lo = div255Avx2(_mm256_mullo_epi16(s_lo, a_lo));
+        __m256i hi = div255Avx2(_mm256_mullo_epi16(s_hi, a_hi));
+        return _mm256_adds_epu8(aDst, _mm256_packus_epi16(lo, hi));
+    }
+}
+
+template <Modes M, bool cFill>
+__attribute__((target("avx2")))
+static void blendRowAvx2(uint32_t *apDst, const uint32_t *apSrc, uint32_t aColor, std::size_t aCount)
+{
+    const __m256i color = _mm256_set1_epi32(static_cast<int>(aColor));
+    std::size_t i = 0;
+    for (; (i + 8) <= aCount; i += 8) {
+        __m256i *dst = reinterpret_cast<__m256i*>(apDst + i);
+        __m256i src = cFill ? color : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(apSrc + i));
+        _mm256_storeu_si256(dst, blend8Avx2<M>(_mm256_loadu_si256(dst), src));
+    }
+    for (; i < aCount; i++) {
+        apDst[i] = blendScalar<M>(apDst[i], cFill ? aColor : apSrc[i]);
+    }
+}
+
+#endif /* BLEND_KERNELS_X86 */
+
+#ifdef BLEND_KERNELS_NEON
+
+static inline uint8x8_t div255Neon(uint16x8_t aValue)
+{
+    aValue = vaddq_u16(aValue, vdupq_n_u16(128));
+    return vmovn_u16(vshrq_n_u16(vaddq_u16(aValue, vshrq_n_u16(aValue, 8)), 8));
+}
+
+/**
+ * Blend 4 pixels, each 8 bit product is widened to 16 bit.
+ */
+template <Modes M>
+static inline uint32x4_t blend4Neon(uint32x4_t aDst, uint32x4_t aSrc)
+{
+    // Replicate the alpha value into all four bytes of each pixel
+    uint8x16_t a = vreinterpretq_u8_u32(vmulq_n_u32(vshrq_n_u32(aSrc, 24), 0x01010101));
+    uint8x16_t ia = vmvnq_u8(a);
+
+    if constexpr (M != Modes::PremultipliedSourceOver) {
+        aSrc = vorrq_u32(aSrc, vdupq_n_u32(cAlphaMask));
+    }
+    uint8x16_t s = vreinterpretq_u8_u32(aSrc);
+    uint8x16_t d = vreinterpretq_u8_u32(aDst);
+
+    if constexpr (M == Modes::SourceOver) {
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(s), vget_low_u8(a)), vget_low_u8(d), vget_low_u8(ia));
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(s), vget_high_u8(a)), vget_high_u8(d), vget_high_u8(ia));
+        return vreinterpretq_u32_u8(vcombine_u8(div255Neon(lo), div255Neon(hi)));
+    }
+    else if constexpr (M == Modes::PremultipliedSourceOver) {
+        uint16x8_t lo = vmull_u8(vget_low_u8(d), vget_low_u8(ia));
+        uint16x8_t hi = vmull_u8(vget_high_u8(d), vget_high_u8(ia));
+        return vreinterpretq_u32_u8(vqaddq_u8(s, vcombine_u8(div255Neon(lo), div255Neon(hi))));
+    }
+    else {
+        uint16x8_t lo = vmull_u8(vget_low_u8(s), vget_low_u8(a));
+        uint16x8_t hi = vmull_u8(vget_high_u8(s), vget_high_u8(a));
+        return vreinterpretq_u32_u8(vqaddq_u8(d, vcombine_u8(div255Neon(lo), div255Neon(hi))));
+    }
+}
+
+template <Modes M, bool cFill>
+static void blendRowNeon(uint32_t *apDst, const uint32_t *apSrc, uint32_t aColor, std::size_t aCount)
+{
+    const uint32x4_t color = vdupq_n_u32(aColor);
+    std::size_t i = 0;
+    for (; (i + 4) <= aCount; i += 4) {
+        uint32x4_t src = cFill ? color : vld1q_u32(apSrc + i);
+        vst1q_u32(apDst + i, blend4Neon<M>(vld1q_u32(apDst + i), src));
+    }
+    for (; i < aCount; i++) {
+        apDst[i] = blendScalar<M>(apDst[i], cFill ? aColor : apSrc[i]);
+    }
+}
+
+#endif /* BLEND_KERNELS_NEON */
+
+#define BLEND_TABLE(impl) KernelTable { \
+    { copyRow, impl<Modes::SourceOver, false>, impl<Modes::PremultipliedSourceOver, false>, impl<Modes::Additive, false> }, \
+    { copyFill, impl<Modes::SourceOver, true>, impl<Modes::PremultipliedSourceOver, true>, impl<Modes::Additive, true> } }
+
+static KernelTable selectKernels()
+{
+#if defined(BLEND_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return BLEND_TABLE(blendRowAvx2);
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return BLEND_TABLE(blendRowSse2);
+    }
+#elif defined(BLEND_KERNELS_NEON)
+    return BLEND_TABLE(blendRowNeon);
+#endif
+    return BLEND_TABLE(blendRowScalar);
+}
+
+static const KernelTable& kernels()
+{
+    static const KernelTable table = selectKernels();
+    return table;
+}
+
+void BlendRow(uint32_t *apDst, const uint32_t *apSrc, std::size_t aCount, Canvas::BlendModes aMode)
+{
+    kernels().row[static_cast<int>(aMode)](apDst, apSrc, 0, aCount);
+}
+
+void BlendFill(uint32_t *apDst, uint32_t aColor, std::size_t aCount, Canvas::BlendModes aMode)
+{
+    kernels().fill[static_cast<int>(aMode)](apDst, nullptr, aColor, aCount);
+}
+
+void BlendMask(uint32_t *apDst, const uint8_t *apCoverage, uint32_t aColor, std::size_t aCount, Canvas::BlendModes aMode)
+{
+    constexpr std::size_t cChunk = 64;
+    uint32_t src[cChunk];
+    uint32_t alpha = aColor >> 24;
+
+    // Copy ignores the alpha of the color, so only the coverage decides the opacity
+    if (aMode == Modes::Copy) {
+        alpha = 255;
+        aMode = Modes::SourceOver;
+    }
+
+    // Turn the coverage values into a row of source pixels, then blend those in chunks
+    while (aCount) {
+        std::size_t n = std::min(aCount, cChunk);
+        for (std::size_t i = 0; i < n; i++) {
+            uint32_t coverage = apCoverage[i];
+            if (aMode == Modes::PremultipliedSourceOver) {
+                src[i] = div255(alpha * coverage) << 24
+                    | div255(((aColor >> 16) & 0xFF) * coverage) << 16
+                    | div255(((aColor >> 8) & 0xFF) * coverage) << 8
+                    | div255((aColor & 0xFF) * coverage);
+            }
+            else {
+                src[i] = (aColor & ~cAlphaMask) | (div255(alpha * coverage) << 24);
+            }
+        }
+        BlendRow(apDst, src, n, aMode);
+        apDst += n;
+        apCoverage += n;
+        aCount -= n;
+    }
+}
+
+uint32_t BlendPixel(uint32_t aDst, uint32_t aSrc, Canvas::BlendModes aMode)
+{
+    switch (aMode) {
+        case Modes::SourceOver:
+            return blendScalar<Modes::SourceOver>(aDst, aSrc);
+        case Modes::PremultipliedSourceOver:
+            return blendScalar<Modes::PremultipliedSourceOver>(aDst, aSrc);
+        case Modes::Additive:
+            return blendScalar<Modes::Additive>(aDst, aSrc);
+        case Modes::Copy:
+        default:
+            return aSrc;
+    }
+}
+
+} /* namespace rsp::graphics::BlendKernels */
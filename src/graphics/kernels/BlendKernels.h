@@ -0,0 +1,78 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef SRC_GRAPHICS_KERNELS_BLENDKERNELS_H_
+#define SRC_GRAPHICS_KERNELS_BLENDKERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <graphics/primitives/Canvas.h>
+
+/**
+ * Row oriented alpha blending kernels for 32 bit ARGB pixels.
+ *
+ * All implementations (AVX2, SSE2, NEON and plain C++) give bit exact
+ * identical results. The best one for the running CPU is selected on first use.
+ *
+ * With alpha a, source s and destination d, each channel is computed as:
+ *  SourceOver:              (s * a + d * (255 - a)) / 255
+ *  PremultipliedSourceOver: s + d * (255 - a) / 255, saturated
+ *  Additive:                d + s * a / 255, saturated
+ * The alpha channel itself always ends up as a + d.a * (255 - a) / 255,
+ * or saturated a + d.a for Additive.
+ */
+namespace rsp::graphics::BlendKernels {
+
+/**
+ * Blend a row of source pixels onto the destination row.
+ *
+ * \param apDst
+ * \param apSrc
+ * \param aCount Number of pixels
+ * \param aMode
+ */
+void BlendRow(uint32_t *apDst, const uint32_t *apSrc, std::size_t aCount, Canvas::BlendModes aMode);
+
+/**
+ * Blend a single color onto the destination row.
+ *
+ * \param apDst
+ * \param aColor
+ * \param aCount Number of pixels
+ * \param aMode
+ */
+void BlendFill(uint32_t *apDst, uint32_t aColor, std::size_t aCount, Canvas::BlendModes aMode);
+
+/**
+ * Blend a single color onto the destination row, using 8 bit coverage values
+ * (e.g. from anti aliased glyphs) to scale the alpha of the color.
+ * With BlendModes::Copy the color is treated as opaque and blended as SourceOver,
+ * so the coverage alone decides the opacity.
+ *
+ * \param apDst
+ * \param apCoverage
+ * \param aColor
+ * \param aCount Number of pixels
+ * \param aMode
+ */
+void BlendMask(uint32_t *apDst, const uint8_t *apCoverage, uint32_t aColor, std::size_t aCount, Canvas::BlendModes aMode);
+
+/**
+ * Blend a single pixel.
+ *
+ * \param aDst
+ * \param aSrc
+ * \param aMode
+ * \return Resulting pixel value
+ */
+uint32_t BlendPixel(uint32_t aDst, uint32_t aSrc, Canvas::BlendModes aMode);
+
+} /* namespace rsp::graphics::BlendKernels */
+
+#endif /* SRC_GRAPHICS_KERNELS_BLENDKERNELS_H_ */
@@ -0,0 +1,83 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef SRC_GRAPHICS_KERNELS_PIXELFORMATTRAITS_H_
+#define SRC_GRAPHICS_KERNELS_PIXELFORMATTRAITS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace rsp::graphics::PixelKernels {
+
+/*
+ * Pixel format traits. Each format knows its size and how to convert
+ * a single pixel, the row kernels and the inlined raster loops are generated from these.
+ */
+struct Xrgb8888 {
+    static constexpr std::size_t cBytes = 4;
+
+    static inline void Store(uint8_t *apDst, uint32_t aColor)
+    {
+        std::memcpy(apDst, &aColor, sizeof(aColor));
+    }
+
+    static inline uint32_t Load(const uint8_t *apSrc)
+    {
+        uint32_t color;
+        std::memcpy(&color, apSrc, sizeof(color));
+        return color;
+    }
+};
+
+struct Rgb888 {
+    static constexpr std::size_t cBytes = 3;
+
+    static inline void Store(uint8_t *apDst, uint32_t aColor)
+    {
+        apDst[0] = static_cast<uint8_t>(aColor);
+        apDst[1] = static_cast<uint8_t>(aColor >> 8);
+        apDst[2] = static_cast<uint8_t>(aColor >> 16);
+    }
+
+    static inline uint32_t Load(const uint8_t *apSrc)
+    {
+        return 0xFF000000u | (uint32_t(apSrc[2]) << 16) | (uint32_t(apSrc[1]) << 8) | apSrc[0];
+    }
+};
+
+struct Rgb565 {
+    static constexpr std::size_t cBytes = 2;
+
+    static inline uint16_t ToNative(uint32_t aColor)
+    {
+        return static_cast<uint16_t>(((aColor >> 8) & 0xF800) | ((aColor >> 5) & 0x07E0) | ((aColor >> 3) & 0x001F));
+    }
+
+    static inline void Store(uint8_t *apDst, uint32_t aColor)
+    {
+        uint16_t pixel = ToNative(aColor);
+        std::memcpy(apDst, &pixel, sizeof(pixel));
+    }
+
+    static inline uint32_t Load(const uint8_t *apSrc)
+    {
+        uint16_t pixel;
+        std::memcpy(&pixel, apSrc, sizeof(pixel));
+        uint32_t r = (pixel >> 11) & 0x1F;
+        uint32_t g = (pixel >> 5) & 0x3F;
+        uint32_t b = pixel & 0x1F;
+        // Replicate the high bits, so full intensity stays full intensity
+        return 0xFF000000u | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+    }
+};
+
+} /* namespace rsp::graphics::PixelKernels */
+
+#endif /* SRC_GRAPHICS_KERNELS_PIXELFORMATTRAITS_H_ */
@@ -0,0 +1,227 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include "PixelKernels.h"
+#include "PixelFormatTraits.h"
+#include "RowKernels.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define PIXEL_KERNELS_X86
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define PIXEL_KERNELS_NEON
+#endif
+
+namespace rsp::graphics::PixelKernels {
+
+template <class T>
+static void storePixel(uint8_t *apDst, uint32_t aColor)
+{
+    T::Store(apDst, aColor);
+}
+
+template <class T>
+static uint32_t loadPixel(const uint8_t *apSrc)
+{
+    return T::Load(apSrc);
+}
+
+template <class T>
+static void fromArgb(uint8_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+{
+    for (std::size_t i = 0; i < aCount; i++) {
+        T::Store(apDst + i * T::cBytes, apSrc[i]);
+    }
+}
+
+template <class T>
+static void toArgb(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount)
+{
+    for (std::size_t i = 0; i < aCount; i++) {
+        apDst[i] = T::Load(apSrc + i * T::cBytes);
+    }
+}
+
+static void fillXrgb8888(uint8_t *apDst, uint32_t aColor, std::size_t aCount)
+{
+    RowKernels::Fill32(reinterpret_cast<uint32_t*>(apDst), aColor, aCount);
+}
+
+static void copyXrgb8888(uint8_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+{
+    std::memcpy(apDst, apSrc, aCount * sizeof(uint32_t));
+}
+
+static void copyToArgbXrgb8888(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount)
+{
+    std::memcpy(apDst, apSrc, aCount * sizeof(uint32_t));
+}
+
+static void fillRgb888(uint8_t *apDst, uint32_t aColor, std::size_t aCount)
+{
+    // Four pixels make up three whole words
+    uint8_t pattern[12];
+    for (std::size_t i = 0; i < 4; i++) {
+        Rgb888::Store(pattern + i * 3, aColor);
+    }
+    std::size_t blocks = aCount / 4;
+    for (std::size_t i = 0; i < blocks; i++) {
+        std::memcpy(apDst, pattern, sizeof(pattern));
+        apDst += sizeof(pattern);
+    }
+    for (std::size_t i = blocks * 4; i < aCount; i++) {
+        Rgb888::Store(apDst, aColor);
+        apDst += Rgb888::cBytes;
+    }
+}
+
+static void fillRgb565(uint8_t *apDst, uint32_t aColor, std::size_t aCount)
+{
+    uint32_t pixel = Rgb565::ToNative(aColor);
+    if (aCount && (reinterpret_cast<uintptr_t>(apDst) & 2)) {
+        Rgb565::Store(apDst, aColor);
+        apDst += 2;
+        aCount--;
+    }
+    // Fill pairs of pixels with the 32 bit row kernel
+    RowKernels::Fill32(reinterpret_cast<uint32_t*>(apDst), pixel | (pixel << 16), aCount / 2);
+    if (aCount & 1) {
+        Rgb565::Store(apDst + (aCount - 1) * 2, aColor);
+    }
+}
+
+#ifdef PIXEL_KERNELS_X86
+
+static inline __m128i toRgb565Sse2(__m128i aPixels)
+{
+    __m128i r = _mm_and_si128(_mm_srli_epi32(aPixels, 8), _mm_set1_epi32(0xF800));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(aPixels, 5), _mm_set1_epi32(0x07E0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(aPixels, 3), _mm_set1_epi32(0x001F));
+    // Bias into the signed range, so the saturating pack is exact
+    return _mm_sub_epi32(_mm_or_si128(_mm_or_si128(r, g), b), _mm_set1_epi32(0x8000));
+}
+
+static void fromArgbRgb565Sse2(uint8_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+{
+    const __m128i bias = _mm_set1_epi16(-0x8000);
+    std::size_t blocks = aCount / 8;
+    for (std::size_t i = 0; i < blocks; i++) {
+        __m128i lo = toRgb565Sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(apSrc)));
+        __m128i hi = toRgb565Sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(apSrc + 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst), _mm_xor_si128(_mm_packs_epi32(lo, hi), bias));
+        apSrc += 8;
+        apDst += 16;
+    }
+    fromArgb<Rgb565>(apDst, apSrc, aCount - blocks * 8);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i toRgb565Avx2(__m256i aPixels)
+{
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(aPixels, 8), _mm256_set1_epi32(0xF800));
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(aPixels, 5), _mm256_set1_epi32(0x07E0));
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(aPixels, 3), _mm256_set1_epi32(0x001F));
+    return _mm256_or_si256(_mm256_or_si256(r, g), b);
+}
+
+__attribute__((target("avx2")))
+static void fromArgbRgb565Avx2(uint8_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+{
+    std::size_t blocks = aCount / 16;
+    for (std::size_t i = 0; i < blocks; i++) {
+        __m256i lo = toRgb565Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(apSrc)));
+        __m256i hi = toRgb565Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(apSrc + 8)));
+        // The pack works within 128 bit lanes, reorder the quad words afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(apDst), packed);
+        apSrc += 16;
+        apDst += 32;
+    }
+    fromArgbRgb565Sse2(apDst, apSrc, aCount - blocks * 16);
+}
+
+#endif /* PIXEL_KERNELS_X86 */
+
+#ifdef PIXEL_KERNELS_NEON
+
+static void fromArgbRgb565Neon(uint8_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+{
+    std::size_t blocks = aCount / 8;
+    for (std::size_t i = 0; i < blocks; i++) {
+        uint16x4_t half[2];
+        for (std::size_t j = 0; j < 2; j++) {
+            uint32x4_t p = vld1q_u32(apSrc + j * 4);
+            uint32x4_t r = vandq_u32(vshrq_n_u32(p, 8), vdupq_n_u32(0xF800));
+            uint32x4_t g = vandq_u32(vshrq_n_u32(p, 5), vdupq_n_u32(0x07E0));
+            uint32x4_t b = vandq_u32(vshrq_n_u32(p, 3), vdupq_n_u32(0x001F));
+            half[j] = vmovn_u32(vorrq_u32(vorrq_u32(r, g), b));
+        }
+        vst1q_u16(reinterpret_cast<uint16_t*>(apDst), vcombine_u16(half[0], half[1]));
+        apSrc += 8;
+        apDst += 16;
+    }
+    fromArgb<Rgb565>(apDst, apSrc, aCount - blocks * 8);
+}
+
+#endif /* PIXEL_KERNELS_NEON */
+
+struct Rgb565Converter {
+    void (*convert)(uint8_t *apDst, const uint32_t *apSrc, std::size_t aCount);
+    const char *name;
+};
+
+static Rgb565Converter selectRgb565Converter()
+{
+#if defined(PIXEL_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Rgb565Converter { fromArgbRgb565Avx2, "AVX2" };
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return Rgb565Converter { fromArgbRgb565Sse2, "SSE2" };
+    }
+#elif defined(PIXEL_KERNELS_NEON)
+    return Rgb565Converter { fromArgbRgb565Neon, "NEON" };
+#endif
+    return Rgb565Converter { fromArgb<Rgb565>, "Scalar" };
+}
+
+static const Rgb565Converter& rgb565Converter()
+{
+    static const Rgb565Converter converter = selectRgb565Converter();
+    return converter;
+}
+
+const Table& Get(BufferedCanvas::PixelFormats aFormat)
+{
+    static const Table xrgb8888 { Xrgb8888::cBytes, storePixel<Xrgb8888>, loadPixel<Xrgb8888>, fillXrgb8888, copyXrgb8888, copyToArgbXrgb8888 };
+    static const Table rgb888 { Rgb888::cBytes, storePixel<Rgb888>, loadPixel<Rgb888>, fillRgb888, fromArgb<Rgb888>, toArgb<Rgb888> };
+    static const Table rgb565 { Rgb565::cBytes, storePixel<Rgb565>, loadPixel<Rgb565>, fillRgb565, rgb565Converter().convert, toArgb<Rgb565> };
+
+    switch (aFormat) {
+        case BufferedCanvas::PixelFormats::RGB565:
+            return rgb565;
+        case BufferedCanvas::PixelFormats::RGB888:
+            return rgb888;
+        case BufferedCanvas::PixelFormats::XRGB8888:
+        default:
+            return xrgb8888;
+    }
+}
+
+const char* GetInstructionSet()
+{
+    return rgb565Converter().name;
+}
+
+} /* namespace rsp::graphics::PixelKernels */
@@ -0,0 +1,58 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef SRC_GRAPHICS_KERNELS_PIXELKERNELS_H_
+#define SRC_GRAPHICS_KERNELS_PIXELKERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <graphics/BufferedCanvas.h>
+
+/**
+ * Kernels converting between 32 bit ARGB colors and the pixel formats
+ * found in display buffers.
+ *
+ * The kernels for a format are looked up once, when the buffers are set up,
+ * so the drawing operations only pay for an indirect call per row.
+ */
+namespace rsp::graphics::PixelKernels {
+
+struct Table {
+    /** Number of bytes used by each pixel */
+    std::size_t mBytesPerPixel;
+    /** Write a single ARGB color as a pixel */
+    void (*store)(uint8_t *apDst, uint32_t aColor);
+    /** Read a single pixel as an ARGB color */
+    uint32_t (*load)(const uint8_t *apSrc);
+    /** Fill a row of pixels with an ARGB color */
+    void (*fill)(uint8_t *apDst, uint32_t aColor, std::size_t aCount);
+    /** Convert a row of ARGB colors into pixels */
+    void (*fromArgb)(uint8_t *apDst, const uint32_t *apSrc, std::size_t aCount);
+    /** Convert a row of pixels into ARGB colors */
+    void (*toArgb)(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount);
+};
+
+/**
+ * Get the kernels for the given pixel format.
+ *
+ * \param aFormat
+ * \return Reference to static kernel table
+ */
+const Table& Get(BufferedCanvas::PixelFormats aFormat);
+
+/**
+ * Get the name of the instruction set used by the RGB565 conversion.
+ *
+ * \return Zero terminated string
+ */
+const char* GetInstructionSet();
+
+} /* namespace rsp::graphics::PixelKernels */
+
+#endif /* SRC_GRAPHICS_KERNELS_PIXELKERNELS_H_ */
@@ -0,0 +1,247 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include "PngKernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define PNG_KERNELS_X86
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define PNG_KERNELS_NEON
+#endif
+
+namespace rsp::graphics::PngKernels {
+
+struct KernelTable {
+    void (*paeth)(uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel);
+    const char *name;
+};
+
+static void unfilterSub(uint8_t *apRow, std::size_t aBytes, std::size_t aBytesPerPixel)
+{
+    for (std::size_t i = aBytesPerPixel; i < aBytes; i++) {
+        apRow[i] = static_cast<uint8_t>(apRow[i] + apRow[i - aBytesPerPixel]);
+    }
+}
+
+static void unfilterUp(uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes)
+{
+    for (std::size_t i = 0; i < aBytes; i++) {
+        apRow[i] = static_cast<uint8_t>(apRow[i] + apPrevious[i]);
+    }
+}
+
+static void unfilterAverage(uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel)
+{
+    std::size_t i = 0;
+    for (; i < aBytesPerPixel && i < aBytes; i++) {
+        apRow[i] = static_cast<uint8_t>(apRow[i] + (apPrevious[i] >> 1));
+    }
+    for (; i < aBytes; i++) {
+        apRow[i] = static_cast<uint8_t>(apRow[i] + ((apRow[i - aBytesPerPixel] + apPrevious[i]) >> 1));
+    }
+}
+
+static inline uint8_t paethPredictor(int aLeft, int aUp, int aUpLeft)
+{
+    int pa = std::abs(aUp - aUpLeft);
+    int pb = std::abs(aLeft - aUpLeft);
+    int pc = std::abs(aLeft + aUp - 2 * aUpLeft);
+    if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(aLeft);
+    }
+    return static_cast<uint8_t>((pb <= pc) ? aUp : aUpLeft);
+}
+
+/**
+ * Scalar Paeth from the given byte offset, used for the tail of the vector versions.
+ */
+static void paethFrom(std::size_t aStart, uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel)
+{
+    std::size_t i = aStart;
+    for (; i < aBytesPerPixel && i < aBytes; i++) {
+        // Left and up-left are zero, so the predictor is always the byte above
+        apRow[i] = static_cast<uint8_t>(apRow[i] + apPrevious[i]);
+    }
+    for (; i < aBytes; i++) {
+        apRow[i] = static_cast<uint8_t>(apRow[i] + paethPredictor(apRow[i - aBytesPerPixel], apPrevious[i], apPrevious[i - aBytesPerPixel]));
+    }
+}
+
+void UnfilterPaethScalar(uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel)
+{
+    paethFrom(0, apRow, apPrevious, aBytes, aBytesPerPixel);
+}
+
+#if defined(PNG_KERNELS_X86)
+
+static inline __m128i load4Sse2(const uint8_t *apSrc)
+{
+    int32_t value;
+    std::memcpy(&value, apSrc, sizeof(value));
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), _mm_setzero_si128());
+}
+
+static inline __m128i absSse2(__m128i aValue)
+{
+    return _mm_max_epi16(aValue, _mm_sub_epi16(_mm_setzero_si128(), aValue));
+}
+
+static inline __m128i selectSse2(__m128i aMask, __m128i aTrue, __m128i aFalse)
+{
+    return _mm_or_si128(_mm_and_si128(aMask, aTrue), _mm_andnot_si128(aMask, aFalse));
+}
+
+/**
+ * The channels of one pixel are handled at once in 16 bit lanes,
+ * carrying the left and up-left pixels from one step to the next.
+ */
+__attribute__((target("sse2")))
+static void paethSse2(uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel)
+{
+    if (aBytesPerPixel != 3 && aBytesPerPixel != 4) {
+        paethFrom(0, apRow, apPrevious, aBytes, aBytesPerPixel);
+        return;
+    }
+
+    __m128i left = _mm_setzero_si128();
+    __m128i up_left = _mm_setzero_si128();
+    std::size_t i = 0;
+    // Four bytes are loaded per pixel, so 3 byte pixels stop one pixel early
+    for (; i + 4 <= aBytes; i += aBytesPerPixel) {
+        __m128i up = load4Sse2(apPrevious + i);
+        __m128i raw = load4Sse2(apRow + i);
+
+        __m128i pa = _mm_sub_epi16(up, up_left);
+        __m128i pb = _mm_sub_epi16(left, up_left);
+        __m128i pc = absSse2(_mm_add_epi16(pa, pb));
+        pa = absSse2(pa);
+        pb = absSse2(pb);
+
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        __m128i use_left = _mm_cmpeq_epi16(pa, smallest);
+        __m128i use_up = _mm_cmpeq_epi16(pb, smallest);
+        __m128i predictor = selectSse2(use_up, up, up_left);
+        predictor = selectSse2(use_left, left, predictor);
+
+        __m128i value = _mm_and_si128(_mm_add_epi16(raw, predictor), _mm_set1_epi16(0xFF));
+        int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(value, value));
+        std::memcpy(apRow + i, &packed, aBytesPerPixel);
+
+        left = value;
+        up_left = up;
+    }
+    paethFrom(i, apRow, apPrevious, aBytes, aBytesPerPixel);
+}
+
+#endif /* PNG_KERNELS_X86 */
+
+#if defined(PNG_KERNELS_NEON)
+
+static inline int16x8_t load4Neon(const uint8_t *apSrc)
+{
+    uint32_t value;
+    std::memcpy(&value, apSrc, sizeof(value));
+    return vreinterpretq_s16_u16(vmovl_u8(vcreate_u8(value)));
+}
+
+static void paethNeon(uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel)
+{
+    if (aBytesPerPixel != 3 && aBytesPerPixel != 4) {
+        paethFrom(0, apRow, apPrevious, aBytes, aBytesPerPixel);
+        return;
+    }
+
+    int16x8_t left = vdupq_n_s16(0);
+    int16x8_t up_left = vdupq_n_s16(0);
+    std::size_t i = 0;
+    for (; i + 4 <= aBytes; i += aBytesPerPixel) {
+        int16x8_t up = load4Neon(apPrevious + i);
+        int16x8_t raw = load4Neon(apRow + i);
+
+        int16x8_t pa = vsubq_s16(up, up_left);
+        int16x8_t pb = vsubq_s16(left, up_left);
+        int16x8_t pc = vabsq_s16(vaddq_s16(pa, pb));
+        pa = vabsq_s16(pa);
+        pb = vabsq_s16(pb);
+
+        int16x8_t smallest = vminq_s16(pc, vminq_s16(pa, pb));
+        int16x8_t predictor = vbslq_s16(vceqq_s16(pb, smallest), up, up_left);
+        predictor = vbslq_s16(vceqq_s16(pa, smallest), left, predictor);
+
+        // Narrowing keeps the low byte, which is the sum modulo 256
+        uint8x8_t narrow = vmovn_u16(vreinterpretq_u16_s16(vaddq_s16(raw, predictor)));
+        uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(narrow), 0);
+        std::memcpy(apRow + i, &packed, aBytesPerPixel);
+
+        left = vreinterpretq_s16_u16(vmovl_u8(narrow));
+        up_left = up;
+    }
+    paethFrom(i, apRow, apPrevious, aBytes, aBytesPerPixel);
+}
+
+#endif /* PNG_KERNELS_NEON */
+
+static KernelTable selectKernels()
+{
+#if defined(PNG_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        return KernelTable { paethSse2, "SSE2" };
+    }
+#elif defined(PNG_KERNELS_NEON)
+    return KernelTable { paethNeon, "NEON" };
+#endif
+    return KernelTable { UnfilterPaethScalar, "Scalar" };
+}
+
+static const KernelTable& kernels()
+{
+    static const KernelTable table = selectKernels();
+    return table;
+}
+
+bool Unfilter(uint8_t aFilter, uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel)
+{
+    switch (aFilter) {
+        case None:
+            return true;
+
+        case Sub:
+            unfilterSub(apRow, aBytes, aBytesPerPixel);
+            return true;
+
+        case Up:
+            unfilterUp(apRow, apPrevious, aBytes);
+            return true;
+
+        case Average:
+            unfilterAverage(apRow, apPrevious, aBytes, aBytesPerPixel);
+            return true;
+
+        case Paeth:
+            kernels().paeth(apRow, apPrevious, aBytes, aBytesPerPixel);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+const char* GetInstructionSet()
+{
+    return kernels().name;
+}
+
+} /* namespace rsp::graphics::PngKernels */
@@ -0,0 +1,59 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef SRC_GRAPHICS_KERNELS_PNGKERNELS_H_
+#define SRC_GRAPHICS_KERNELS_PNGKERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Kernels reversing the PNG row filters.
+ *
+ * The Paeth filter depends on the pixel to the left, so it is vectorized
+ * across the channels of a pixel for 3 and 4 byte pixels (SSE2 or NEON).
+ */
+namespace rsp::graphics::PngKernels {
+
+enum Filters : uint8_t {
+    None = 0,
+    Sub = 1,
+    Up = 2,
+    Average = 3,
+    Paeth = 4
+};
+
+/**
+ * Reverse the filter of a row in place.
+ *
+ * \param aFilter Filter type byte from the start of the row
+ * \param apRow Filtered row, without the filter type byte
+ * \param apPrevious Unfiltered previous row, all zero for the first row
+ * \param aBytes Number of bytes in the row
+ * \param aBytesPerPixel Distance to the corresponding byte of the pixel to the left, at least 1
+ * \return False if the filter type is unknown
+ */
+bool Unfilter(uint8_t aFilter, uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel);
+
+/**
+ * Get the name of the instruction set used by the Paeth filter.
+ *
+ * \return Zero terminated string
+ */
+const char* GetInstructionSet();
+
+/**
+ * Reverse the Paeth filter without vector instructions, used for
+ * verification of the vectorized version.
+ */
+void UnfilterPaethScalar(uint8_t *apRow, const uint8_t *apPrevious, std::size_t aBytes, std::size_t aBytesPerPixel);
+
+} /* namespace rsp::graphics::PngKernels */
+
+#endif /* SRC_GRAPHICS_KERNELS_PNGKERNELS_H_ */
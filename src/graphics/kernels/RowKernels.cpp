@@ -0,0 +1,314 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include "RowKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define ROW_KERNELS_X86
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define ROW_KERNELS_NEON
+#endif
+
+namespace rsp::graphics::RowKernels {
+
+struct KernelTable {
+    void (*fill)(uint32_t *apDst, uint32_t aValue, std::size_t aCount, bool aNonTemporal);
+    void (*copy)(uint8_t *apDst, const uint8_t *apSrc, std::size_t aBytes, bool aNonTemporal);
+    void (*expand24)(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount, uint32_t aAlpha);
+    const char *name;
+};
+
+static void fillScalar(uint32_t *apDst, uint32_t aValue, std::size_t aCount, bool /*aNonTemporal*/)
+{
+    std::fill_n(apDst, aCount, aValue);
+}
+
+static void copyScalar(uint8_t *apDst, const uint8_t *apSrc, std::size_t aBytes, bool /*aNonTemporal*/)
+{
+    std::memcpy(apDst, apSrc, aBytes);
+}
+
+static void expand24Scalar(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount, uint32_t aAlpha)
+{
+    for (std::size_t i = 0; i < aCount; i++) {
+        apDst[i] = aAlpha | (uint32_t(apSrc[2]) << 16) | (uint32_t(apSrc[1]) << 8) | apSrc[0];
+        apSrc += 3;
+    }
+}
+
+#ifdef ROW_KERNELS_X86
+
+__attribute__((target("ssse3")))
+static void expand24Ssse3(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount, uint32_t aAlpha)
+{
+    // Each 16 byte load holds 4 pixels in its first 12 bytes, so stop
+    // while the load still fits inside the source row
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(aAlpha));
+    std::size_t i = 0;
+    for (; i + 6 <= aCount; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apSrc + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst + i), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    expand24Scalar(apDst + i, apSrc + i * 3, aCount - i, aAlpha);
+}
+
+static void fillSse2(uint32_t *apDst, uint32_t aValue, std::size_t aCount, bool aNonTemporal)
+{
+    // Align destination to 16 bytes
+    while (aCount && (reinterpret_cast<uintptr_t>(apDst) & 15)) {
+        *apDst++ = aValue;
+        aCount--;
+    }
+
+    __m128i v = _mm_set1_epi32(static_cast<int>(aValue));
+    __m128i *dst = reinterpret_cast<__m128i*>(apDst);
+    std::size_t blocks = aCount / 16;
+    if (aNonTemporal) {
+        for (std::size_t i = 0; i < blocks; i++) {
+            _mm_stream_si128(dst++, v);
+            _mm_stream_si128(dst++, v);
+            _mm_stream_si128(dst++, v);
+            _mm_stream_si128(dst++, v);
+        }
+        _mm_sfence();
+    }
+    else {
+        for (std::size_t i = 0; i < blocks; i++) {
+            _mm_store_si128(dst++, v);
+            _mm_store_si128(dst++, v);
+            _mm_store_si128(dst++, v);
+            _mm_store_si128(dst++, v);
+        }
+    }
+
+    apDst = reinterpret_cast<uint32_t*>(dst);
+    aCount -= blocks * 16;
+    while (aCount--) {
+        *apDst++ = aValue;
+    }
+}
+
+static void copySse2(uint8_t *apDst, const uint8_t *apSrc, std::size_t aBytes, bool aNonTemporal)
+{
+    if (!aNonTemporal) {
+        std::memcpy(apDst, apSrc, aBytes);
+        return;
+    }
+
+    std::size_t head = (16 - (reinterpret_cast<uintptr_t>(apDst) & 15)) & 15;
+    head = std::min(head, aBytes);
+    std::memcpy(apDst, apSrc, head);
+    apDst += head;
+    apSrc += head;
+    aBytes -= head;
+
+    __m128i *dst = reinterpret_cast<__m128i*>(apDst);
+    const __m128i *src = reinterpret_cast<const __m128i*>(apSrc);
+    std::size_t blocks = aBytes / 64;
+    for (std::size_t i = 0; i < blocks; i++) {
+        __m128i a = _mm_loadu_si128(src++);
+        __m128i b = _mm_loadu_si128(src++);
+        __m128i c = _mm_loadu_si128(src++);
+        __m128i d = _mm_loadu_si128(src++);
+        _mm_stream_si128(dst++, a);
+        _mm_stream_si128(dst++, b);
+        _mm_stream_si128(dst++, c);
+        _mm_stream_si128(dst++, d);
+    }
+    _mm_sfence();
+
+    std::size_t done = blocks * 64;
+    std::memcpy(apDst + done, apSrc + done, aBytes - done);
+}
+
+__attribute__((target("avx2")))
+static void fillAvx2(uint32_t *apDst, uint32_t aValue, std::size_t aCount, bool aNonTemporal)
+{
+    // Align destination to 32 bytes
+    while (aCount && (reinterpret_cast<uintptr_t>(apDst) & 31)) {
+        *apDst++ = aValue;
+        aCount--;
+    }
+
+    __m256i v = _mm256_set1_epi32(static_cast<int>(aValue));
+    __m256i *dst = reinterpret_cast<__m256i*>(apDst);
+    std::size_t blocks = aCount / 32;
+    if (aNonTemporal) {
+        for (std::size_t i = 0; i < blocks; i++) {
+            _mm256_stream_si256(dst++, v);
+            _mm256_stream_si256(dst++, v);
+            _mm256_stream_si256(dst++, v);
+            _mm256_stream_si256(dst++, v);
+        }
+        _mm_sfence();
+    }
+    else {
+        for (std::size_t i = 0; i < blocks; i++) {
+            _mm256_store_si256(dst++, v);
+            _mm256_store_si256(dst++, v);
+            _mm256_store_si256(dst++, v);
+            _mm256_store_si256(dst++, v);
+        }
+    }
+
+    apDst = reinterpret_cast<uint32_t*>(dst);
+    aCount -= blocks * 32;
+    while (aCount--) {
+        *apDst++ = aValue;
+    }
+}
+
+__attribute__((target("avx2")))
+static void copyAvx2(uint8_t *apDst, const uint8_t *apSrc, std::size_t aBytes, bool aNonTemporal)
+{
+    if (!aNonTemporal) {
+        std::memcpy(apDst, apSrc, aBytes);
+        return;
+    }
+
+    std::size_t head = (32 - (reinterpret_cast<uintptr_t>(apDst) & 31)) & 31;
+    head = std::min(head, aBytes);
+    std::memcpy(apDst, apSrc, head);
+    apDst += head;
+    apSrc += head;
+    aBytes -= head;
+
+    __m256i *dst = reinterpret_cast<__m256i*>(apDst);
+    const __m256i *src = reinterpret_cast<const __m256i*>(apSrc);
+    std::size_t blocks = aBytes / 128;
+    for (std::size_t i = 0; i < blocks; i++) {
+        __m256i a = _mm256_loadu_si256(src++);
+        __m256i b = _mm256_loadu_si256(src++);
+        __m256i c = _mm256_loadu_si256(src++);
+        __m256i d = _mm256_loadu_si256(src++);
+        _mm256_stream_si256(dst++, a);
+        _mm256_stream_si256(dst++, b);
+        _mm256_stream_si256(dst++, c);
+        _mm256_stream_si256(dst++, d);
+    }
+    _mm_sfence();
+
+    std::size_t done = blocks * 128;
+    std::memcpy(apDst + done, apSrc + done, aBytes - done);
+}
+
+#endif /* ROW_KERNELS_X86 */
+
+#ifdef ROW_KERNELS_NEON
+
+static void fillNeon(uint32_t *apDst, uint32_t aValue, std::size_t aCount, bool /*aNonTemporal*/)
+{
+    uint32x4_t v = vdupq_n_u32(aValue);
+    std::size_t blocks = aCount / 16;
+    for (std::size_t i = 0; i < blocks; i++) {
+        vst1q_u32(apDst, v);
+        vst1q_u32(apDst + 4, v);
+        vst1q_u32(apDst + 8, v);
+        vst1q_u32(apDst + 12, v);
+        apDst += 16;
+    }
+    aCount -= blocks * 16;
+    while (aCount--) {
+        *apDst++ = aValue;
+    }
+}
+
+static void expand24Neon(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount, uint32_t aAlpha)
+{
+    uint8x16_t alpha = vdupq_n_u8(static_cast<uint8_t>(aAlpha >> 24));
+    std::size_t i = 0;
+    for (; i + 16 <= aCount; i += 16) {
+        uint8x16x3_t bgr = vld3q_u8(apSrc + i * 3);
+        uint8x16x4_t bgra = {{ bgr.val[0], bgr.val[1], bgr.val[2], alpha }};
+        vst4q_u8(reinterpret_cast<uint8_t*>(apDst + i), bgra);
+    }
+    expand24Scalar(apDst + i, apSrc + i * 3, aCount - i, aAlpha);
+}
+
+#endif /* ROW_KERNELS_NEON */
+
+static KernelTable selectKernels()
+{
+#if defined(ROW_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return KernelTable { fillAvx2, copyAvx2, expand24Ssse3, "AVX2" };
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return KernelTable { fillSse2, copySse2, __builtin_cpu_supports("ssse3") ? expand24Ssse3 : expand24Scalar, "SSE2" };
+    }
+#elif defined(ROW_KERNELS_NEON)
+    return KernelTable { fillNeon, copyScalar, expand24Neon, "NEON" };
+#endif
+    return KernelTable { fillScalar, copyScalar, expand24Scalar, "Scalar" };
+}
+
+static const KernelTable& kernels()
+{
+    static const KernelTable table = selectKernels();
+    return table;
+}
+
+void Expand24To32(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount, uint32_t aAlpha)
+{
+    kernels().expand24(apDst, apSrc, aCount, aAlpha);
+}
+
+void Fill32(uint32_t *apDst, uint32_t aValue, std::size_t aCount)
+{
+    kernels().fill(apDst, aValue, aCount, (aCount * sizeof(uint32_t)) >= cNonTemporalThreshold);
+}
+
+void FillRect32(uint8_t *apDst, std::size_t aStride, uint32_t aValue, std::size_t aWidth, std::size_t aHeight)
+{
+    std::size_t row_bytes = aWidth * sizeof(uint32_t);
+    bool non_temporal = (row_bytes * aHeight) >= cNonTemporalThreshold;
+
+    // Rows without padding are filled in one go
+    if (row_bytes == aStride) {
+        kernels().fill(reinterpret_cast<uint32_t*>(apDst), aValue, aWidth * aHeight, non_temporal);
+        return;
+    }
+
+    for (std::size_t y = 0; y < aHeight; y++) {
+        kernels().fill(reinterpret_cast<uint32_t*>(apDst), aValue, aWidth, non_temporal);
+        apDst += aStride;
+    }
+}
+
+void CopyRect(uint8_t *apDst, const uint8_t *apSrc, std::size_t aStride, std::size_t aRowBytes, std::size_t aHeight)
+{
+    bool non_temporal = (aRowBytes * aHeight) >= cNonTemporalThreshold;
+
+    // Rows without padding are copied in one go
+    if (aRowBytes == aStride) {
+        kernels().copy(apDst, apSrc, aRowBytes * aHeight, non_temporal);
+        return;
+    }
+
+    for (std::size_t y = 0; y < aHeight; y++) {
+        kernels().copy(apDst, apSrc, aRowBytes, non_temporal);
+        apDst += aStride;
+        apSrc += aStride;
+    }
+}
+
+const char* GetInstructionSet()
+{
+    return kernels().name;
+}
+
+} /* namespace rsp::graphics::RowKernels */
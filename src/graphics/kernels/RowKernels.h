@@ -0,0 +1,81 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef SRC_GRAPHICS_KERNELS_ROWKERNELS_H_
+#define SRC_GRAPHICS_KERNELS_ROWKERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Row oriented pixel kernels used by the canvas implementations.
+ *
+ * The best implementation for the running CPU (AVX2, SSE2, NEON or plain C++)
+ * is selected once on first use.
+ */
+namespace rsp::graphics::RowKernels {
+
+/**
+ * Copies larger than this number of bytes are written with non-temporal
+ * stores, to avoid evicting the working set from the cache.
+ */
+constexpr std::size_t cNonTemporalThreshold = 256 * 1024;
+
+/**
+ * Fill a row of 32 bit pixels with the given value.
+ *
+ * \param apDst
+ * \param aValue
+ * \param aCount Number of pixels
+ */
+void Fill32(uint32_t *apDst, uint32_t aValue, std::size_t aCount);
+
+/**
+ * Fill a rectangular area of 32 bit pixels with the given value.
+ *
+ * \param apDst Pointer to the top left pixel
+ * \param aStride Number of bytes between rows
+ * \param aValue
+ * \param aWidth Number of pixels in each row
+ * \param aHeight Number of rows
+ */
+void FillRect32(uint8_t *apDst, std::size_t aStride, uint32_t aValue, std::size_t aWidth, std::size_t aHeight);
+
+/**
+ * Copy a rectangular area between two buffers with the same stride.
+ *
+ * \param apDst Pointer to the top left byte in destination
+ * \param apSrc Pointer to the top left byte in source
+ * \param aStride Number of bytes between rows
+ * \param aRowBytes Number of bytes to copy from each row
+ * \param aHeight Number of rows
+ */
+void CopyRect(uint8_t *apDst, const uint8_t *apSrc, std::size_t aStride, std::size_t aRowBytes, std::size_t aHeight);
+
+/**
+ * Expand a row of 24 bit pixels, stored as blue, green, red bytes like
+ * in BMP files, into 32 bit ARGB pixels.
+ *
+ * \param apDst
+ * \param apSrc
+ * \param aCount Number of pixels
+ * \param aAlpha Value of the alpha byte, in the top byte
+ */
+void Expand24To32(uint32_t *apDst, const uint8_t *apSrc, std::size_t aCount, uint32_t aAlpha);
+
+/**
+ * Get the name of the instruction set used by the kernels.
+ *
+ * \return Zero terminated string
+ */
+const char* GetInstructionSet();
+
+} /* namespace rsp::graphics::RowKernels */
+
+#endif /* SRC_GRAPHICS_KERNELS_ROWKERNELS_H_ */
@@ -0,0 +1,410 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include "TransformKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define TRANSFORM_KERNELS_X86
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define TRANSFORM_KERNELS_NEON
+#endif
+
+namespace rsp::graphics::TransformKernels {
+
+struct KernelTable {
+    void (*blendRows)(uint32_t *apDst, const uint32_t *apTop, const uint32_t *apBottom, std::size_t aCount, uint32_t aWeight);
+    void (*bilinearRow)(uint32_t *apDst, const uint32_t *apSrc, std::size_t aSrcWidth, std::size_t aCount, int64_t aX, int64_t aStep);
+    void (*rotate)(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::size_t aSrcStride,
+        std::size_t aWidth, std::size_t aHeight, unsigned aQuarterTurns);
+    const char *name;
+};
+
+// Quarter turns are done in square blocks of this many destination pixels,
+// 16KB of destination, and source lines touched within the block.
+static constexpr std::size_t cBlock = 64;
+
+/**
+ * Interpolate all four channels at once, two channels in each half word.
+ * The sums fit in 16 bits, so the same result as the vector versions.
+ */
+static inline uint32_t lerpPixel(uint32_t aA, uint32_t aB, uint32_t aWeight)
+{
+    uint32_t inverse = 256 - aWeight;
+    uint32_t rb = ((aA & 0x00FF00FF) * inverse + (aB & 0x00FF00FF) * aWeight + 0x00800080) >> 8;
+    uint32_t ag = ((aA >> 8) & 0x00FF00FF) * inverse + ((aB >> 8) & 0x00FF00FF) * aWeight + 0x00800080;
+    return (rb & 0x00FF00FF) | (ag & 0xFF00FF00);
+}
+
+/**
+ * Clamp a source position to the row, giving the index of the left pixel
+ * and the weight of the pixel to the right of it.
+ */
+static inline std::size_t samplePosition(int64_t aX, std::size_t aLast, uint32_t &arWeight)
+{
+    if (aX <= 0) {
+        arWeight = 0;
+        return 0;
+    }
+    std::size_t index = static_cast<std::size_t>(aX >> 16);
+    if (index >= aLast) {
+        arWeight = 0;
+        return aLast;
+    }
+    arWeight = static_cast<uint32_t>(aX >> 8) & 0xFF;
+    return index;
+}
+
+static inline const uint32_t* sourcePixel(const uint32_t *apSrc, std::size_t aSrcStride, std::size_t aWidth, std::size_t aHeight,
+    unsigned aQuarterTurns, std::size_t aX, std::size_t aY)
+{
+    switch (aQuarterTurns & 3) {
+        case 1:
+            return apSrc + (aHeight - 1 - aX) * aSrcStride + aY;
+        case 2:
+            return apSrc + (aHeight - 1 - aY) * aSrcStride + (aWidth - 1 - aX);
+        case 3:
+            return apSrc + aX * aSrcStride + (aWidth - 1 - aY);
+        default:
+            return apSrc + aY * aSrcStride + aX;
+    }
+}
+
+void NearestRow(uint32_t *apDst, const uint32_t *apSrc, std::size_t aCount, int64_t aX, int64_t aStep)
+{
+    // Gathers are no faster than scalar loads on the targets we use
+    for (std::size_t i = 0; i < aCount; i++, aX += aStep) {
+        apDst[i] = apSrc[static_cast<std::size_t>(aX >> 16)];
+    }
+}
+
+void BlendRowsScalar(uint32_t *apDst, const uint32_t *apTop, const uint32_t *apBottom, std::size_t aCount, uint32_t aWeight)
+{
+    for (std::size_t i = 0; i < aCount; i++) {
+        apDst[i] = lerpPixel(apTop[i], apBottom[i], aWeight);
+    }
+}
+
+void BilinearRowScalar(uint32_t *apDst, const uint32_t *apSrc, std::size_t aSrcWidth, std::size_t aCount, int64_t aX, int64_t aStep)
+{
+    uint32_t weight;
+    for (std::size_t i = 0; i < aCount; i++, aX += aStep) {
+        std::size_t x = samplePosition(aX, aSrcWidth - 1, weight);
+        apDst[i] = lerpPixel(apSrc[x], apSrc[x + 1], weight);
+    }
+}
+
+void RotateScalar(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::size_t aSrcStride,
+    std::size_t aWidth, std::size_t aHeight, unsigned aQuarterTurns)
+{
+    bool odd = (aQuarterTurns & 1) != 0;
+    std::size_t width = odd ? aHeight : aWidth;
+    std::size_t height = odd ? aWidth : aHeight;
+    for (std::size_t y = 0; y < height; y++) {
+        for (std::size_t x = 0; x < width; x++) {
+            apDst[y * aDstStride + x] = *sourcePixel(apSrc, aSrcStride, aWidth, aHeight, aQuarterTurns, x, y);
+        }
+    }
+}
+
+/**
+ * Rotation driver, Ops gives the 4x4 tile transpose and the row reversal.
+ *
+ * For odd turns each destination tile is four runs of four contiguous source
+ * pixels, one for each destination column, read forwards for clockwise turns
+ * and backwards for counter clockwise turns.
+ */
+template <class Ops>
+static void rotateBlocked(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::size_t aSrcStride,
+    std::size_t aWidth, std::size_t aHeight, unsigned aQuarterTurns)
+{
+    aQuarterTurns &= 3;
+    if (aQuarterTurns == 0) {
+        for (std::size_t y = 0; y < aHeight; y++) {
+            std::memcpy(apDst + y * aDstStride, apSrc + y * aSrcStride, aWidth * sizeof(uint32_t));
+        }
+        return;
+    }
+    if (aQuarterTurns == 2) {
+        for (std::size_t y = 0; y < aHeight; y++) {
+            Ops::reverse(apDst + y * aDstStride, apSrc + (aHeight - 1 - y) * aSrcStride, aWidth);
+        }
+        return;
+    }
+
+    // The destination is aHeight pixels wide and aWidth pixels high
+    std::ptrdiff_t src_stride = static_cast<std::ptrdiff_t>(aSrcStride);
+    for (std::size_t by = 0; by < aWidth; by += cBlock) {
+        std::size_t ey = std::min(by + cBlock, aWidth);
+        for (std::size_t bx = 0; bx < aHeight; bx += cBlock) {
+            std::size_t ex = std::min(bx + cBlock, aHeight);
+            std::size_t y = by;
+            for (; y + 4 <= ey; y += 4) {
+                std::size_t x = bx;
+                for (; x + 4 <= ex; x += 4) {
+                    uint32_t *dst = apDst + y * aDstStride + x;
+                    if (aQuarterTurns == 1) {
+                        Ops::template tile<false>(dst, aDstStride, apSrc + (aHeight - 1 - x) * aSrcStride + y, -src_stride);
+                    }
+                    else {
+                        Ops::template tile<true>(dst, aDstStride, apSrc + x * aSrcStride + (aWidth - 4 - y), src_stride);
+                    }
+                }
+                for (; x < ex; x++) {
+                    for (std::size_t r = y; r < y + 4; r++) {
+                        apDst[r * aDstStride + x] = *sourcePixel(apSrc, aSrcStride, aWidth, aHeight, aQuarterTurns, x, r);
+                    }
+                }
+            }
+            for (; y < ey; y++) {
+                for (std::size_t x = bx; x < ex; x++) {
+                    apDst[y * aDstStride + x] = *sourcePixel(apSrc, aSrcStride, aWidth, aHeight, aQuarterTurns, x, y);
+                }
+            }
+        }
+    }
+}
+
+struct ScalarOps {
+    template <bool Reverse>
+    static void tile(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::ptrdiff_t aSrcStep)
+    {
+        for (std::ptrdiff_t c = 0; c < 4; c++) {
+            for (std::ptrdiff_t r = 0; r < 4; r++) {
+                apDst[static_cast<std::size_t>(r) * aDstStride + static_cast<std::size_t>(c)] = apSrc[c * aSrcStep + (Reverse ? 3 - r : r)];
+            }
+        }
+    }
+
+    static void reverse(uint32_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+    {
+        std::reverse_copy(apSrc, apSrc + aCount, apDst);
+    }
+};
+
+#if defined(TRANSFORM_KERNELS_X86)
+
+__attribute__((target("sse2")))
+static inline __m128i lerpSse2(__m128i aA, __m128i aB, __m128i aWeightA, __m128i aWeightB)
+{
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(aA, aWeightA), _mm_mullo_epi16(aB, aWeightB));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+}
+
+__attribute__((target("sse2")))
+static void blendRowsSse2(uint32_t *apDst, const uint32_t *apTop, const uint32_t *apBottom, std::size_t aCount, uint32_t aWeight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weight_bottom = _mm_set1_epi16(static_cast<short>(aWeight));
+    const __m128i weight_top = _mm_set1_epi16(static_cast<short>(256 - aWeight));
+    std::size_t i = 0;
+    for (; i + 4 <= aCount; i += 4) {
+        __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apTop + i));
+        __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apBottom + i));
+        __m128i low = lerpSse2(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero), weight_top, weight_bottom);
+        __m128i high = lerpSse2(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero), weight_top, weight_bottom);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst + i), _mm_packus_epi16(low, high));
+    }
+    BlendRowsScalar(apDst + i, apTop + i, apBottom + i, aCount - i, aWeight);
+}
+
+/**
+ * Interpolate two destination pixels, the pixel pairs are loaded as
+ * 64 bits and split into left and right pixels.
+ */
+__attribute__((target("sse2")))
+static inline __m128i bilinearPairSse2(const uint32_t *apSrc, std::size_t aLast, int64_t aX, int64_t aStep)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t weight0;
+    uint32_t weight1;
+    std::size_t x0 = samplePosition(aX, aLast, weight0);
+    std::size_t x1 = samplePosition(aX + aStep, aLast, weight1);
+    __m128i pair0 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(apSrc + x0)), zero);
+    __m128i pair1 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(apSrc + x1)), zero);
+    __m128i weight_right = _mm_unpacklo_epi64(_mm_set1_epi16(static_cast<short>(weight0)), _mm_set1_epi16(static_cast<short>(weight1)));
+    __m128i weight_left = _mm_sub_epi16(_mm_set1_epi16(256), weight_right);
+    return lerpSse2(_mm_unpacklo_epi64(pair0, pair1), _mm_unpackhi_epi64(pair0, pair1), weight_left, weight_right);
+}
+
+__attribute__((target("sse2")))
+static void bilinearRowSse2(uint32_t *apDst, const uint32_t *apSrc, std::size_t aSrcWidth, std::size_t aCount, int64_t aX, int64_t aStep)
+{
+    std::size_t last = aSrcWidth - 1;
+    std::size_t i = 0;
+    for (; i + 4 <= aCount; i += 4, aX += 4 * aStep) {
+        __m128i low = bilinearPairSse2(apSrc, last, aX, aStep);
+        __m128i high = bilinearPairSse2(apSrc, last, aX + 2 * aStep, aStep);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst + i), _mm_packus_epi16(low, high));
+    }
+    BilinearRowScalar(apDst + i, apSrc, aSrcWidth, aCount - i, aX, aStep);
+}
+
+struct Sse2Ops {
+    template <bool Reverse>
+    __attribute__((target("sse2")))
+    static void tile(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::ptrdiff_t aSrcStep)
+    {
+        __m128i column[4];
+        for (std::ptrdiff_t c = 0; c < 4; c++) {
+            column[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apSrc + c * aSrcStep));
+            if (Reverse) {
+                column[c] = _mm_shuffle_epi32(column[c], 0x1B);
+            }
+        }
+        __m128i t0 = _mm_unpacklo_epi32(column[0], column[1]);
+        __m128i t1 = _mm_unpacklo_epi32(column[2], column[3]);
+        __m128i t2 = _mm_unpackhi_epi32(column[0], column[1]);
+        __m128i t3 = _mm_unpackhi_epi32(column[2], column[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst), _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst + aDstStride), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst + 2 * aDstStride), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst + 3 * aDstStride), _mm_unpackhi_epi64(t2, t3));
+    }
+
+    __attribute__((target("sse2")))
+    static void reverse(uint32_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= aCount; i += 4) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apSrc + aCount - 4 - i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(apDst + i), _mm_shuffle_epi32(value, 0x1B));
+        }
+        std::reverse_copy(apSrc, apSrc + aCount - i, apDst + i);
+    }
+};
+
+#endif /* TRANSFORM_KERNELS_X86 */
+
+#if defined(TRANSFORM_KERNELS_NEON)
+
+static inline uint16x8_t lerpNeon(uint16x8_t aA, uint16x8_t aB, uint16x8_t aWeightA, uint16x8_t aWeightB)
+{
+    uint16x8_t sum = vmlaq_u16(vmulq_u16(aA, aWeightA), aB, aWeightB);
+    return vshrq_n_u16(vaddq_u16(sum, vdupq_n_u16(128)), 8);
+}
+
+static void blendRowsNeon(uint32_t *apDst, const uint32_t *apTop, const uint32_t *apBottom, std::size_t aCount, uint32_t aWeight)
+{
+    const uint16x8_t weight_bottom = vdupq_n_u16(static_cast<uint16_t>(aWeight));
+    const uint16x8_t weight_top = vdupq_n_u16(static_cast<uint16_t>(256 - aWeight));
+    std::size_t i = 0;
+    for (; i + 4 <= aCount; i += 4) {
+        uint8x16_t top = vld1q_u8(reinterpret_cast<const uint8_t*>(apTop + i));
+        uint8x16_t bottom = vld1q_u8(reinterpret_cast<const uint8_t*>(apBottom + i));
+        uint16x8_t low = lerpNeon(vmovl_u8(vget_low_u8(top)), vmovl_u8(vget_low_u8(bottom)), weight_top, weight_bottom);
+        uint16x8_t high = lerpNeon(vmovl_u8(vget_high_u8(top)), vmovl_u8(vget_high_u8(bottom)), weight_top, weight_bottom);
+        vst1q_u8(reinterpret_cast<uint8_t*>(apDst + i), vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+    BlendRowsScalar(apDst + i, apTop + i, apBottom + i, aCount - i, aWeight);
+}
+
+static void bilinearRowNeon(uint32_t *apDst, const uint32_t *apSrc, std::size_t aSrcWidth, std::size_t aCount, int64_t aX, int64_t aStep)
+{
+    std::size_t last = aSrcWidth - 1;
+    std::size_t i = 0;
+    for (; i + 2 <= aCount; i += 2, aX += 2 * aStep) {
+        uint32_t weight0;
+        uint32_t weight1;
+        std::size_t x0 = samplePosition(aX, last, weight0);
+        std::size_t x1 = samplePosition(aX + aStep, last, weight1);
+        uint16x8_t pair0 = vmovl_u8(vld1_u8(reinterpret_cast<const uint8_t*>(apSrc + x0)));
+        uint16x8_t pair1 = vmovl_u8(vld1_u8(reinterpret_cast<const uint8_t*>(apSrc + x1)));
+        uint16x8_t weight_right = vcombine_u16(vdup_n_u16(static_cast<uint16_t>(weight0)), vdup_n_u16(static_cast<uint16_t>(weight1)));
+        uint16x8_t weight_left = vsubq_u16(vdupq_n_u16(256), weight_right);
+        uint16x8_t value = lerpNeon(vcombine_u16(vget_low_u16(pair0), vget_low_u16(pair1)),
+            vcombine_u16(vget_high_u16(pair0), vget_high_u16(pair1)), weight_left, weight_right);
+        vst1_u8(reinterpret_cast<uint8_t*>(apDst + i), vmovn_u16(value));
+    }
+    BilinearRowScalar(apDst + i, apSrc, aSrcWidth, aCount - i, aX, aStep);
+}
+
+static inline uint32x4_t reverseNeon(uint32x4_t aValue)
+{
+    aValue = vrev64q_u32(aValue);
+    return vcombine_u32(vget_high_u32(aValue), vget_low_u32(aValue));
+}
+
+struct NeonOps {
+    template <bool Reverse>
+    static void tile(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::ptrdiff_t aSrcStep)
+    {
+        uint32x4_t column[4];
+        for (std::ptrdiff_t c = 0; c < 4; c++) {
+            column[c] = vld1q_u32(apSrc + c * aSrcStep);
+            if (Reverse) {
+                column[c] = reverseNeon(column[c]);
+            }
+        }
+        uint32x4x2_t t0 = vtrnq_u32(column[0], column[1]);
+        uint32x4x2_t t1 = vtrnq_u32(column[2], column[3]);
+        vst1q_u32(apDst, vcombine_u32(vget_low_u32(t0.val[0]), vget_low_u32(t1.val[0])));
+        vst1q_u32(apDst + aDstStride, vcombine_u32(vget_low_u32(t0.val[1]), vget_low_u32(t1.val[1])));
+        vst1q_u32(apDst + 2 * aDstStride, vcombine_u32(vget_high_u32(t0.val[0]), vget_high_u32(t1.val[0])));
+        vst1q_u32(apDst + 3 * aDstStride, vcombine_u32(vget_high_u32(t0.val[1]), vget_high_u32(t1.val[1])));
+    }
+
+    static void reverse(uint32_t *apDst, const uint32_t *apSrc, std::size_t aCount)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= aCount; i += 4) {
+            vst1q_u32(apDst + i, reverseNeon(vld1q_u32(apSrc + aCount - 4 - i)));
+        }
+        std::reverse_copy(apSrc, apSrc + aCount - i, apDst + i);
+    }
+};
+
+#endif /* TRANSFORM_KERNELS_NEON */
+
+static KernelTable selectKernels()
+{
+#if defined(TRANSFORM_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        return KernelTable { blendRowsSse2, bilinearRowSse2, rotateBlocked<Sse2Ops>, "SSE2" };
+    }
+#elif defined(TRANSFORM_KERNELS_NEON)
+    return KernelTable { blendRowsNeon, bilinearRowNeon, rotateBlocked<NeonOps>, "NEON" };
+#endif
+    return KernelTable { BlendRowsScalar, BilinearRowScalar, rotateBlocked<ScalarOps>, "Scalar" };
+}
+
+static const KernelTable& kernels()
+{
+    static const KernelTable table = selectKernels();
+    return table;
+}
+
+void BlendRows(uint32_t *apDst, const uint32_t *apTop, const uint32_t *apBottom, std::size_t aCount, uint32_t aWeight)
+{
+    kernels().blendRows(apDst, apTop, apBottom, aCount, aWeight);
+}
+
+void BilinearRow(uint32_t *apDst, const uint32_t *apSrc, std::size_t aSrcWidth, std::size_t aCount, int64_t aX, int64_t aStep)
+{
+    kernels().bilinearRow(apDst, apSrc, aSrcWidth, aCount, aX, aStep);
+}
+
+void Rotate(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::size_t aSrcStride,
+    std::size_t aWidth, std::size_t aHeight, unsigned aQuarterTurns)
+{
+    kernels().rotate(apDst, aDstStride, apSrc, aSrcStride, aWidth, aHeight, aQuarterTurns);
+}
+
+const char* GetInstructionSet()
+{
+    return kernels().name;
+}
+
+} /* namespace rsp::graphics::TransformKernels */
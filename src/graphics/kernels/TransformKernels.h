@@ -0,0 +1,94 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef SRC_GRAPHICS_KERNELS_TRANSFORMKERNELS_H_
+#define SRC_GRAPHICS_KERNELS_TRANSFORMKERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Kernels resampling and rotating 32 bit pixels.
+ *
+ * Source positions are 16.16 fixed point, and bilinear weights are the top
+ * 8 bits of the fraction, so all channels are interpolated in 16 bit lanes
+ * (SSE2 or NEON). Quarter turns are done as a transpose of 4x4 pixel tiles,
+ * within blocks small enough to keep the source and destination lines cached.
+ */
+namespace rsp::graphics::TransformKernels {
+
+/**
+ * Sample a row at the nearest source pixels.
+ *
+ * \param apDst Destination row of aCount pixels
+ * \param apSrc Source row
+ * \param aCount Number of pixels to write
+ * \param aX Source position of the first pixel, 16.16 fixed point, not negative
+ * \param aStep Distance between the source positions, 16.16 fixed point
+ */
+void NearestRow(uint32_t *apDst, const uint32_t *apSrc, std::size_t aCount, int64_t aX, int64_t aStep);
+
+/**
+ * Interpolate between two rows, channel by channel.
+ *
+ * \param apDst Destination row, may be the same as apTop
+ * \param apTop
+ * \param apBottom
+ * \param aCount Number of pixels
+ * \param aWeight Weight of apBottom, 0 to 255
+ */
+void BlendRows(uint32_t *apDst, const uint32_t *apTop, const uint32_t *apBottom, std::size_t aCount, uint32_t aWeight);
+
+/**
+ * Sample a row by interpolating between the two nearest source pixels.
+ * Positions outside the source are clamped to the first or last pixel.
+ *
+ * \param apDst Destination row of aCount pixels
+ * \param apSrc Source row of aSrcWidth pixels, followed by one more readable pixel
+ * \param aSrcWidth Number of pixels in the source row
+ * \param aCount Number of pixels to write
+ * \param aX Source position of the first pixel, 16.16 fixed point
+ * \param aStep Distance between the source positions, 16.16 fixed point
+ */
+void BilinearRow(uint32_t *apDst, const uint32_t *apSrc, std::size_t aSrcWidth, std::size_t aCount, int64_t aX, int64_t aStep);
+
+/**
+ * Rotate pixels clockwise in quarter turns.
+ * The destination is aHeight pixels wide and aWidth pixels high for odd turns.
+ *
+ * \param apDst Destination, must not overlap the source
+ * \param aDstStride Number of pixels between destination rows
+ * \param apSrc Source
+ * \param aSrcStride Number of pixels between source rows
+ * \param aWidth Source width
+ * \param aHeight Source height
+ * \param aQuarterTurns Number of clockwise quarter turns
+ */
+void Rotate(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::size_t aSrcStride,
+    std::size_t aWidth, std::size_t aHeight, unsigned aQuarterTurns);
+
+/**
+ * Get the name of the instruction set used.
+ *
+ * \return Zero terminated string
+ */
+const char* GetInstructionSet();
+
+/**
+ * Versions without vector instructions or blocking, used for
+ * verification of the optimized versions.
+ */
+void BlendRowsScalar(uint32_t *apDst, const uint32_t *apTop, const uint32_t *apBottom, std::size_t aCount, uint32_t aWeight);
+void BilinearRowScalar(uint32_t *apDst, const uint32_t *apSrc, std::size_t aSrcWidth, std::size_t aCount, int64_t aX, int64_t aStep);
+void RotateScalar(uint32_t *apDst, std::size_t aDstStride, const uint32_t *apSrc, std::size_t aSrcStride,
+    std::size_t aWidth, std::size_t aHeight, unsigned aQuarterTurns);
+
+} /* namespace rsp::graphics::TransformKernels */
+
+#endif /* SRC_GRAPHICS_KERNELS_TRANSFORMKERNELS_H_ */
@@ -9,10 +9,15 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <graphics/primitives/Bitmap.h>
 #include <graphics/primitives/raster/BmpLoader.h>
 #include <graphics/primitives/raster/PngLoader.h>
+#include <graphics/primitives/raster/RawLoader.h>
+#include <graphics/kernels/RowKernels.h>
+#include <graphics/kernels/BlendKernels.h>
+#include <graphics/kernels/TransformKernels.h>
 
 #include <utils/CoreException.h>
 
@@ -23,42 +28,163 @@ namespace rsp::graphics
 
 std::unordered_map<std::string, std::function<std::shared_ptr<ImgLoader>()>> Bitmap::filetypeMap = {
     {".bmp", std::function<std::shared_ptr<ImgLoader>()>([]() { return std::make_shared<BmpLoader>(); })},
-    {".png", std::function<std::shared_ptr<ImgLoader>()>([]() { return std::make_shared<PngLoader>(); })}};
+    {".png", std::function<std::shared_ptr<ImgLoader>()>([]() { return std::make_shared<PngLoader>(); })},
+    {".raw", std::function<std::shared_ptr<ImgLoader>()>([]() { return std::make_shared<RawLoader>(); })}};
 
-Bitmap::Bitmap(std::string aImgName)
-    : Canvas()
+/**
+ * Make a pointer to the pixels of a vector, owning the vector.
+ */
+static std::shared_ptr<const uint32_t> shareVector(std::shared_ptr<std::vector<uint32_t>> apVector)
 {
-    std::filesystem::path filename(aImgName.c_str());
+    const uint32_t *pixels = apVector->data();
+    return std::shared_ptr<const uint32_t>(std::move(apVector), pixels);
+}
 
-    auto loader = GetRasterLoader(filename.extension());
-    // Get raw data
-    mImagePixels = loader->LoadImg(filename);
-    mHeight = loader->GetHeight();
-    mWidth = loader->GetWidth();
+Bitmap::Bitmap(std::string aImgName)
+    : Canvas(),
+      mpImagePixels()
+{
+    ImageCache::Image image = ImageCache::Get().Load(aImgName, decode);
+    mpImagePixels = image.mpPixels;
+    mHeight = image.mHeight;
+    mWidth = image.mWidth;
 }
 
 Bitmap::Bitmap(const uint32_t *apPixels, int aHeight, int aWidth, int aBytesPerPixel)
-    : Canvas(aHeight, aWidth, aBytesPerPixel), mImagePixels(static_cast<long unsigned int>(aWidth * aHeight))
+    : Canvas(aHeight, aWidth, aBytesPerPixel),
+      mpImagePixels(shareVector(std::make_shared<std::vector<uint32_t>>(apPixels, apPixels + aWidth * aHeight))),
+      mPrivatePixels(true)
 {
-    for (int y = 0; y < mHeight; y++) {
-        for (int x = 0; x < mWidth; x++) {
-            mImagePixels[static_cast<long unsigned int>(x + (y * mWidth))] = *apPixels++;
-        }
-    }
 }
 
 Bitmap::Bitmap(int aHeight, int aWidth, int aBytesPerPixel)
-    : Canvas(aHeight, aWidth, aBytesPerPixel), mImagePixels(static_cast<long unsigned int>(aWidth * aHeight))
+    : Canvas(aHeight, aWidth, aBytesPerPixel),
+      mpImagePixels(shareVector(std::make_shared<std::vector<uint32_t>>(static_cast<std::size_t>(aWidth * aHeight)))),
+      mPrivatePixels(true)
 {
 }
 
+ImageCache::Image Bitmap::decode(const std::string &arFileName)
+{
+    std::filesystem::path filename(arFileName.c_str());
+
+    auto loader = GetRasterLoader(filename.extension());
+    ImageCache::Image image;
+    // Use the file as is if possible, otherwise decode into new pixel storage
+    image.mpPixels = loader->MapImg(filename);
+    if (!image.mpPixels) {
+        auto pixels = std::make_shared<std::vector<uint32_t>>();
+        loader->LoadImg(filename, *pixels);
+        image.mpPixels = shareVector(std::move(pixels));
+    }
+    image.mHeight = loader->GetHeight();
+    image.mWidth = loader->GetWidth();
+    return image;
+}
+
+void Bitmap::makePrivate()
+{
+    std::span<const uint32_t> pixels = GetPixels();
+    mpImagePixels = shareVector(std::make_shared<std::vector<uint32_t>>(pixels.begin(), pixels.end()));
+    mPrivatePixels = true;
+}
+
 uint32_t Bitmap::GetPixel(const Point &aPoint, const bool aFront) const
 {
     if (!IsInsideScreen(aPoint)) {
         return 0;
     }
     long location = (mWidth * aPoint.mY) + aPoint.mX;
-    return mImagePixels[static_cast<long unsigned int>(location)];
+    return mpImagePixels.get()[location];
+}
+
+Bitmap Bitmap::Scale(int aWidth, int aHeight, ScaleMethods aMethod) const
+{
+    if ((aWidth <= 0) || (aHeight <= 0)) {
+        THROW_WITH_BACKTRACE1(CoreException, "Invalid bitmap size: " + std::to_string(aWidth) + "x" + std::to_string(aHeight));
+    }
+    Bitmap result(aHeight, aWidth, mBytesPerPixel);
+    result.DrawImage(Rect(0, 0, aWidth, aHeight), *this, aMethod);
+    return result;
+}
+
+Bitmap Bitmap::Rotate(Rotations aRotation) const
+{
+    unsigned turns = static_cast<unsigned>(aRotation);
+    bool odd = (turns & 1) != 0;
+    Bitmap result(odd ? mWidth : mHeight, odd ? mHeight : mWidth, mBytesPerPixel);
+    TransformKernels::Rotate(result.writablePixels(), static_cast<std::size_t>(result.mWidth), mpImagePixels.get(),
+        static_cast<std::size_t>(mWidth), static_cast<std::size_t>(mWidth), static_cast<std::size_t>(mHeight), turns);
+    return result;
+}
+
+void Bitmap::fillPixel(int aX, int aY, const Color &arColor)
+{
+    uint32_t &pixel = writablePixels()[static_cast<size_t>(aX + (aY * mWidth))];
+    pixel = BlendKernels::BlendPixel(pixel, arColor, mBlendMode);
+}
+
+void Bitmap::blitRow(int aX, int aY, const uint32_t *apPixels, int aLength)
+{
+    // Use memmove, the source could be this bitmap
+    uint32_t *dst = &writablePixels()[static_cast<size_t>(aX + (aY * mWidth))];
+    if (mBlendMode == BlendModes::Copy) {
+        std::memmove(dst, apPixels, static_cast<size_t>(aLength) * sizeof(uint32_t));
+    }
+    else if ((apPixels < dst) && (apPixels + aLength > dst)) {
+        // Blending reads the source as it goes, take a copy if it overlaps
+        std::vector<uint32_t> src(apPixels, apPixels + aLength);
+        BlendKernels::BlendRow(dst, src.data(), static_cast<size_t>(aLength), mBlendMode);
+    }
+    else {
+        BlendKernels::BlendRow(dst, apPixels, static_cast<size_t>(aLength), mBlendMode);
+    }
+}
+
+void Bitmap::fillHSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    uint32_t *dst = &writablePixels()[static_cast<size_t>(aX + (aY * mWidth))];
+    if (mBlendMode == BlendModes::Copy) {
+        RowKernels::Fill32(dst, arColor, static_cast<size_t>(aLength));
+    }
+    else {
+        BlendKernels::BlendFill(dst, arColor, static_cast<size_t>(aLength), mBlendMode);
+    }
+}
+
+void Bitmap::fillVSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    uint32_t color = arColor;
+    uint32_t *pixels = writablePixels();
+    size_t location = static_cast<size_t>(aX + (aY * mWidth));
+    for (int i = 0; i < aLength; i++) {
+        pixels[location] = BlendKernels::BlendPixel(pixels[location], color, mBlendMode);
+        location += static_cast<size_t>(mWidth);
+    }
+}
+
+void Bitmap::blendMaskRow(int aX, int aY, const uint8_t *apCoverage, int aLength, const Color &arColor)
+{
+    BlendKernels::BlendMask(&writablePixels()[static_cast<size_t>(aX + (aY * mWidth))], apCoverage, arColor, static_cast<size_t>(aLength), mBlendMode);
+}
+
+void Bitmap::plotLine(const Raster::Line &arLine, const Color &arColor)
+{
+    uint32_t *pixels = writablePixels();
+    std::size_t width = static_cast<std::size_t>(mWidth);
+    uint32_t color = arColor;
+
+    if (mBlendMode == BlendModes::Copy) {
+        Raster::ForEachLinePixel(arLine, [=](int aX, int aY) {
+            pixels[static_cast<std::size_t>(aX) + static_cast<std::size_t>(aY) * width] = color;
+        });
+    }
+    else {
+        Raster::ForEachLinePixel(arLine, [=, this](int aX, int aY) {
+            uint32_t &pixel = pixels[static_cast<std::size_t>(aX) + static_cast<std::size_t>(aY) * width];
+            pixel = BlendKernels::BlendPixel(pixel, color, mBlendMode);
+        });
+    }
 }
 
 std::shared_ptr<ImgLoader> Bitmap::GetRasterLoader(const std::string aFileType)
@@ -10,6 +10,7 @@
 
 #include "graphics/primitives/Bitmap.h"
 
+#include <algorithm>
 #include <chrono>
 #include <fcntl.h>
 #include <linux/kd.h>
@@ -21,6 +22,8 @@
 #include <string>
 #include <vector>
 #include <logging/Logger.h>
+#include <graphics/kernels/BlendKernels.h>
+#include <graphics/kernels/TransformKernels.h>
 
 namespace rsp::graphics
 {
@@ -31,91 +34,143 @@ void Canvas::DrawArc(const Point &aCenter, int aRadius1, int aRadius2, int aStar
 
 void Canvas::DrawCircle(const Point &aCenter, int aRadius, const Color &aColor)
 {
-    int error = -aRadius;
-    int y = 0;
-
-    while (aRadius >= y) {
-        plot8Points(aCenter.mX, aCenter.mY, aRadius, y, aColor);
-        error += y;
-        y++;
-        error += y;
-
-        if (error >= 0) {
-            error += -aRadius;
-            aRadius--;
-            error += -aRadius;
-        }
+    if (aRadius < 0) {
+        return;
     }
+    Invalidate(Rect(Point(aCenter.mX - aRadius, aCenter.mY - aRadius), Point(aCenter.mX + aRadius + 1, aCenter.mY + aRadius + 1)).Intersection(GetClipRect()));
+
+    Raster::ForEachCircleRun(aRadius, [&](int aRunRadius, int aY0, int aY1) {
+        plotCircleRuns(aCenter.mX, aCenter.mY, aRunRadius, aY0, aY1, aColor);
+    });
 }
 
 void Canvas::DrawLine(const Point &aA, const Point &aB, const Color &aColor)
 {
     int deltaX = aB.mX - aA.mX;
     int deltaY = aB.mY - aA.mY;
-    int absDeltaX = abs(deltaX);
-    int absDeltaY = abs(deltaY);
-    int signumX = (deltaX > 0) ? 1 : -1;
-    int signumY = (deltaY > 0) ? 1 : -1;
-    int x = absDeltaX >> 1;
-    int y = absDeltaY >> 1;
-    int px = aA.mX;
-    int py = aA.mY;
-
-    SetPixel(aA, aColor);
-    if (absDeltaX >= absDeltaY) {
-        for (int i = 0; i < absDeltaX; i++) {
-            y += absDeltaY;
-            if (y >= absDeltaX) {
-                y -= absDeltaX;
-                py += signumY;
-            }
-            px += signumX;
-            SetPixel(Point(px, py), aColor);
-        }
+    Rect clip = GetClipRect();
+
+    Invalidate(Rect(Point(std::min(aA.mX, aB.mX), std::min(aA.mY, aB.mY)), Point(std::max(aA.mX, aB.mX) + 1, std::max(aA.mY, aB.mY) + 1)).Intersection(clip));
+
+    if (deltaY == 0) {
+        drawHSpan(std::min(aA.mX, aB.mX), aA.mY, abs(deltaX) + 1, aColor);
+    }
+    else if (deltaX == 0) {
+        drawVSpan(aA.mX, std::min(aA.mY, aB.mY), abs(deltaY) + 1, aColor);
+    }
+    else if (abs(deltaX) >= abs(deltaY)) {
+        rasterLine(aA.mX, aA.mY, deltaX, deltaY, clip.mLeftTop.mX, clip.mRightBottom.mX, clip.mLeftTop.mY, clip.mRightBottom.mY, false, aColor);
     }
     else {
-        for (int i = 0; i < absDeltaY; i++) {
-            x += absDeltaX;
-            if (x >= absDeltaY) {
-                x -= absDeltaY;
-                px += signumX;
-            }
-            py += signumY;
-            SetPixel(Point(px, py), aColor);
-        }
+        rasterLine(aA.mY, aA.mX, deltaY, deltaX, clip.mLeftTop.mY, clip.mRightBottom.mY, clip.mLeftTop.mX, clip.mRightBottom.mX, true, aColor);
     }
 }
 
 void Canvas::DrawRectangle(const Rect &aRect, const Color &aColor, bool aFilled)
 {
+    Rect clip = GetClipRect();
+    Rect area = Rect(aRect.mLeftTop, Point(aRect.mRightBottom.mX + 1, aRect.mRightBottom.mY + 1)).Intersection(clip);
+    Invalidate(area);
+
     if (aFilled) {
-        for (int y = aRect.mLeftTop.mY; y <= aRect.mRightBottom.mY; y++) {
-            for (int x = aRect.mLeftTop.mX; x <= aRect.mRightBottom.mX; x++) {
-                SetPixel(Point(x, y), aColor);
-            }
+        for (int y = area.mLeftTop.mY; y < area.mRightBottom.mY; y++) {
+            fillHSpan(area.mLeftTop.mX, y, area.GetWidth(), aColor);
         }
     }
     else {
-        for (int i = aRect.mLeftTop.mX; i <= aRect.mRightBottom.mX; i++) {
-            SetPixel(Point(i, aRect.mLeftTop.mY), aColor);     // top
-            SetPixel(Point(i, aRect.mRightBottom.mY), aColor); // bottom
+        // Every pixel is drawn once, so translucent corners match the edges
+        int width = aRect.GetWidth() + 1;
+        int height = aRect.GetHeight() + 1;
+        drawHSpan(aRect.mLeftTop.mX, aRect.mLeftTop.mY, width, aColor);     // top
+        if (height > 1) {
+            drawHSpan(aRect.mLeftTop.mX, aRect.mRightBottom.mY, width, aColor); // bottom
         }
-        for (int i = aRect.mLeftTop.mY; i <= aRect.mRightBottom.mY; i++) {
-            SetPixel(Point(aRect.mLeftTop.mX, i), aColor);     // left
-            SetPixel(Point(aRect.mRightBottom.mX, i), aColor); // right
+        if (height > 2) {
+            drawVSpan(aRect.mLeftTop.mX, aRect.mLeftTop.mY + 1, height - 2, aColor); // left
+            if (width > 1) {
+                drawVSpan(aRect.mRightBottom.mX, aRect.mLeftTop.mY + 1, height - 2, aColor); // right
+            }
         }
     }
 }
 
 void Canvas::DrawImage(const Point &aLeftTop, const Bitmap &aBitmap)
 {
-    long unsigned int iter = 0;
-    auto pixels = aBitmap.GetPixels();
-    for (int h = 0; h < aBitmap.GetHeight(); h++) {
-        for (int w = 0; w < aBitmap.GetWidth(); w++) {
-            SetPixel(Point(aLeftTop.mX + w, aLeftTop.mY + h), pixels[iter]);
-            iter++;
+    DrawImage(aLeftTop, aBitmap, Rect(0, 0, aBitmap.GetWidth(), aBitmap.GetHeight()));
+}
+
+void Canvas::DrawImage(const Point &arLeftTop, const Bitmap &arBitmap, const Rect &arSourceRect)
+{
+    // Clip the source to the bitmap, then the resulting destination to the clip area
+    Rect src = arSourceRect.Intersection(Rect(0, 0, arBitmap.GetWidth(), arBitmap.GetHeight()));
+    Point offset(arLeftTop.mX - arSourceRect.mLeftTop.mX, arLeftTop.mY - arSourceRect.mLeftTop.mY);
+    Rect area = Rect(Point(src.mLeftTop.mX + offset.mX, src.mLeftTop.mY + offset.mY), src.GetWidth(), src.GetHeight()).Intersection(GetClipRect());
+    if (area.IsEmpty()) {
+        return;
+    }
+    Invalidate(area);
+
+    const uint32_t *pixels = arBitmap.GetPixels().data()
+        + (area.mLeftTop.mY - offset.mY) * arBitmap.GetWidth() + (area.mLeftTop.mX - offset.mX);
+    for (int y = area.mLeftTop.mY; y < area.mRightBottom.mY; y++) {
+        blitRow(area.mLeftTop.mX, y, pixels, area.GetWidth());
+        pixels += arBitmap.GetWidth();
+    }
+}
+
+void Canvas::DrawImage(const Rect &arDestination, const Bitmap &arBitmap, ScaleMethods aMethod)
+{
+    Rect area = arDestination.Intersection(GetClipRect());
+    if (area.IsEmpty() || (arBitmap.GetWidth() <= 0) || (arBitmap.GetHeight() <= 0)) {
+        return;
+    }
+    Invalidate(area);
+
+    // Destination pixel centers are mapped to source positions in 16.16 fixed point
+    std::size_t src_width = static_cast<std::size_t>(arBitmap.GetWidth());
+    std::size_t src_last_row = static_cast<std::size_t>(arBitmap.GetHeight() - 1);
+    int64_t step_x = (int64_t(arBitmap.GetWidth()) << 16) / arDestination.GetWidth();
+    int64_t step_y = (int64_t(arBitmap.GetHeight()) << 16) / arDestination.GetHeight();
+    int64_t x = (area.mLeftTop.mX - arDestination.mLeftTop.mX) * step_x + step_x / 2;
+    int64_t y = (area.mLeftTop.mY - arDestination.mLeftTop.mY) * step_y + step_y / 2;
+    int left = area.mLeftTop.mX;
+    int top = area.mLeftTop.mY;
+    int rows = area.GetHeight();
+    std::size_t count = static_cast<std::size_t>(area.GetWidth());
+    const uint32_t *pixels = arBitmap.GetPixels().data();
+    std::vector<uint32_t> row(count);
+
+    if (aMethod == ScaleMethods::Nearest) {
+        std::size_t previous = SIZE_MAX;
+        for (int i = 0; i < rows; i++, y += step_y) {
+            // Rows repeat when enlarging
+            std::size_t sy = static_cast<std::size_t>(y >> 16);
+            if (sy != previous) {
+                TransformKernels::NearestRow(row.data(), pixels + sy * src_width, count, x, step_x);
+                previous = sy;
+            }
+            blitRow(left, top + i, row.data(), area.GetWidth());
+        }
+        return;
+    }
+
+    // Interpolation is between source pixel centers, half a pixel in. Each source row pair
+    // is interpolated into a row with one extra pixel, for the horizontal interpolation.
+    std::vector<uint32_t> source(src_width + 1);
+    const int64_t cHalf = 0x8000;
+    int64_t last_center = (int64_t(src_last_row) << 16) + cHalf;
+    int64_t previous = -1;
+    for (int i = 0; i < rows; i++, y += step_y) {
+        int64_t position = std::clamp<int64_t>(y, cHalf, last_center) - cHalf;
+        if (position != previous) {
+            std::size_t sy = static_cast<std::size_t>(position >> 16);
+            TransformKernels::BlendRows(source.data(), pixels + sy * src_width, pixels + std::min(sy + 1, src_last_row) * src_width,
+                src_width, static_cast<uint32_t>(position >> 8) & 0xFF);
+            source[src_width] = source[src_width - 1];
+            previous = position;
         }
+        TransformKernels::BilinearRow(row.data(), source.data(), src_width, count, x - cHalf, step_x);
+        blitRow(left, top + i, row.data(), area.GetWidth());
     }
 }
 
@@ -126,19 +181,224 @@ void Canvas::DrawText(Text &arText)
 
 void Canvas::DrawText(const Text &arText, const Color &arColor)
 {
+    Rect clip = arText.GetArea().Intersection(GetClipRect());
+    if (clip.IsEmpty()) {
+        return;
+    }
+    Invalidate(clip);
+
+    int left = arText.GetArea().GetLeft();
+    int top = arText.GetArea().GetTop();
+    // Overlapping glyphs merged in the surface only blend like two separate glyphs
+    // when each blend is a lerp towards the same opaque color
+    bool merged_is_exact = (mBlendMode == BlendModes::Copy)
+        || (((mBlendMode == BlendModes::SourceOver) || (mBlendMode == BlendModes::PremultipliedSourceOver)) && (arColor.GetAlpha() == 0xFF));
+    const Text::Surface *surface = merged_is_exact ? arText.GetSurface() : nullptr;
+    if (surface) {
+        // All glyphs are already merged, blend the visible part of each surface row
+        int sx = surface->mArea.GetLeft() + left;
+        int sy = surface->mArea.GetTop() + top;
+        int x0 = std::max(sx, clip.mLeftTop.mX);
+        int x1 = std::min(sx + surface->mArea.GetWidth(), clip.mRightBottom.mX);
+        int y0 = std::max(sy, clip.mLeftTop.mY);
+        int y1 = std::min(sy + surface->mArea.GetHeight(), clip.mRightBottom.mY);
+        const std::size_t stride = std::size_t(surface->mArea.GetWidth());
+        for (int y = y0; (x0 < x1) && (y < y1); y++) {
+            blendMaskRow(x0, y, surface->mCoverage.data() + std::size_t(y - sy) * stride + std::size_t(x0 - sx), x1 - x0, arColor);
+        }
+        return;
+    }
+
     for (const Glyph &glyph : arText.GetGlyphs()) {
-        for (int y = 0; y < glyph.mHeight; y++) {
-            long unsigned int index = static_cast<long unsigned int>(y * glyph.mWidth);
-            for (int x = 0; x < glyph.mWidth; x++) {
-                uint8_t c = glyph.mPixels[index++];
-                auto p = Point(x + glyph.mLeft + arText.GetArea().GetLeft(), y + glyph.mTop + arText.GetArea().GetTop());
-                if (c && arText.GetArea().IsHit(p)) {
-                    SetPixel(p, arColor);
-                }
-            }
+        // Clip the glyph box once, then blend the visible part of each atlas row
+        int gx = glyph.mLeft + left;
+        int gy = glyph.mTop + top;
+        int x0 = std::max(gx, clip.mLeftTop.mX);
+        int x1 = std::min(gx + glyph.mBitmapWidth, clip.mRightBottom.mX);
+        int y0 = std::max(gy, clip.mLeftTop.mY);
+        int y1 = std::min(gy + glyph.mHeight, clip.mRightBottom.mY);
+        if ((x1 <= x0) || (y1 <= y0)) {
+            continue;
         }
+
+        for (int y = y0; y < y1; y++) {
+            blendMaskRow(x0, y, glyph.GetCoverage(y - gy) + (x0 - gx), x1 - x0, arColor);
+        }
+    }
+}
+
+void Canvas::PushClipRect(const Rect &arRect)
+{
+    mClipStack.push_back(arRect.Intersection(GetClipRect()));
+}
+
+void Canvas::PopClipRect()
+{
+    if (mClipStack.empty()) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PopClipRect called without matching PushClipRect");
     }
+    mClipStack.pop_back();
 }
 
+Rect Canvas::GetClipRect() const
+{
+    if (mClipStack.empty()) {
+        return Rect(0, 0, mWidth, mHeight);
+    }
+    return mClipStack.back();
+}
+
+void Canvas::plotCircleRuns(int aCenterX, int aCenterY, int aRadius, int aY0, int aY1, const Color &arColor)
+{
+    if (aRadius == 0) {
+        drawHSpan(aCenterX, aCenterY, 1, arColor);
+        return;
+    }
+
+    // The octants share the pixels on the axes and on the diagonal, draw those only once
+    int length = aY1 - aY0 + 1;
+    int mirrored = (aY0 == 0) ? length - 1 : length;
+    int diagonal = (aY1 == aRadius) ? 1 : 0;
+
+    drawVSpan(aCenterX + aRadius, aCenterY + aY0, length, arColor);
+    drawVSpan(aCenterX - aRadius, aCenterY + aY0, length, arColor);
+    drawVSpan(aCenterX + aRadius, aCenterY - aY1, mirrored, arColor);
+    drawVSpan(aCenterX - aRadius, aCenterY - aY1, mirrored, arColor);
+    drawHSpan(aCenterX + aY0, aCenterY + aRadius, length - diagonal, arColor);
+    drawHSpan(aCenterX - aY1 + diagonal, aCenterY + aRadius, mirrored - diagonal, arColor);
+    drawHSpan(aCenterX + aY0, aCenterY - aRadius, length - diagonal, arColor);
+    drawHSpan(aCenterX - aY1 + diagonal, aCenterY - aRadius, mirrored - diagonal, arColor);
+}
+
+/**
+ * Integer division rounding towards negative infinity, aDivisor must be positive.
+ */
+static inline int64_t floorDiv(int64_t aDividend, int64_t aDivisor)
+{
+    int64_t q = aDividend / aDivisor;
+    return ((aDividend % aDivisor) < 0) ? q - 1 : q;
+}
+
+void Canvas::rasterLine(int aMajor, int aMinor, int aDeltaMajor, int aDeltaMinor, int aMajorLow, int aMajorHigh,
+                        int aMinorLow, int aMinorHigh, bool aSwapped, const Color &arColor)
+{
+    int64_t major_len = abs(aDeltaMajor);
+    int64_t minor_len = abs(aDeltaMinor);
+    int major_sign = (aDeltaMajor > 0) ? 1 : -1;
+    int minor_sign = (aDeltaMinor > 0) ? 1 : -1;
+    int64_t bias = minor_len >> 1;
+
+    // Range of steps where the major coordinate is inside the clip area
+    int64_t first = 0;
+    int64_t last = major_len;
+    if (major_sign > 0) {
+        first = std::max<int64_t>(first, aMajorLow - aMajor);
+        last = std::min<int64_t>(last, aMajorHigh - 1 - aMajor);
+    }
+    else {
+        first = std::max<int64_t>(first, aMajor - (aMajorHigh - 1));
+        last = std::min<int64_t>(last, aMajor - aMajorLow);
+    }
+
+    // After i steps the minor coordinate has moved floor((bias + i * minor_len) / major_len) pixels,
+    // narrow the range to the steps where that is inside the clip area as well.
+    int64_t moved_min = (minor_sign > 0) ? (aMinorLow - aMinor) : (aMinor - (aMinorHigh - 1));
+    int64_t moved_max = (minor_sign > 0) ? (aMinorHigh - 1 - aMinor) : (aMinor - aMinorLow);
+    first = std::max(first, -floorDiv(bias - moved_min * major_len, minor_len));
+    last = std::min(last, floorDiv((moved_max + 1) * major_len - bias - 1, minor_len));
+    if (first > last) {
+        return;
+    }
+
+    int64_t acc = bias + first * minor_len;
+    Raster::Line line {
+        aMajor + major_sign * static_cast<int>(first),
+        aMinor + minor_sign * static_cast<int>(acc / major_len),
+        major_sign,
+        minor_sign,
+        acc % major_len,
+        major_len,
+        minor_len,
+        last - first + 1,
+        aSwapped
+    };
+    plotLine(line, arColor);
+}
+
+void Canvas::plotLine(const Raster::Line &arLine, const Color &arColor)
+{
+    Raster::ForEachLinePixel(arLine, [this, &arColor](int aX, int aY) {
+        fillPixel(aX, aY, arColor);
+    });
+}
+
+void Canvas::drawHSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    Rect clip = GetClipRect();
+    if ((aY < clip.mLeftTop.mY) || (aY >= clip.mRightBottom.mY)) {
+        return;
+    }
+    int x0 = std::max(aX, clip.mLeftTop.mX);
+    int x1 = std::min(aX + aLength, clip.mRightBottom.mX);
+    if (x1 > x0) {
+        fillHSpan(x0, aY, x1 - x0, arColor);
+    }
+}
+
+void Canvas::drawVSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    Rect clip = GetClipRect();
+    if ((aX < clip.mLeftTop.mX) || (aX >= clip.mRightBottom.mX)) {
+        return;
+    }
+    int y0 = std::max(aY, clip.mLeftTop.mY);
+    int y1 = std::min(aY + aLength, clip.mRightBottom.mY);
+    if (y1 > y0) {
+        fillVSpan(aX, y0, y1 - y0, arColor);
+    }
+}
+
+void Canvas::fillPixel(int aX, int aY, const Color &arColor)
+{
+    SetPixel(Point(aX, aY), blendPixel(aX, aY, arColor));
+}
+
+void Canvas::blitRow(int aX, int aY, const uint32_t *apPixels, int aLength)
+{
+    for (int x = aX; x < aX + aLength; x++) {
+        fillPixel(x, aY, *apPixels++);
+    }
+}
+
+void Canvas::fillHSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    for (int x = aX; x < aX + aLength; x++) {
+        SetPixel(Point(x, aY), blendPixel(x, aY, arColor));
+    }
+}
+
+void Canvas::fillVSpan(int aX, int aY, int aLength, const Color &arColor)
+{
+    for (int y = aY; y < aY + aLength; y++) {
+        SetPixel(Point(aX, y), blendPixel(aX, y, arColor));
+    }
+}
+
+void Canvas::blendMaskRow(int aX, int aY, const uint8_t *apCoverage, int aLength, const Color &arColor)
+{
+    for (int x = aX; x < aX + aLength; x++) {
+        uint32_t pixel = GetPixel(Point(x, aY), false);
+        BlendKernels::BlendMask(&pixel, apCoverage++, arColor, 1, mBlendMode);
+        SetPixel(Point(x, aY), pixel);
+    }
+}
+
+uint32_t Canvas::blendPixel(int aX, int aY, uint32_t aColor) const
+{
+    if (mBlendMode == BlendModes::Copy) {
+        return aColor;
+    }
+    return BlendKernels::BlendPixel(GetPixel(Point(aX, aY), false), aColor, mBlendMode);
+}
 
 } // namespace rsp::graphics
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <graphics/primitives/Font.h>
 #include <graphics/primitives/FontRawInterface.h>
+#include <graphics/primitives/GlyphAtlas.h>
 #include <logging/Logger.h>
 
 #ifdef USE_FREETYPE
@@ -22,6 +23,11 @@
 namespace rsp::graphics {
 
 
+const uint8_t* Glyph::GetCoverage(int aRow) const
+{
+    return mpAtlas->GetPixels(mAtlasLeft, mAtlasTop + aRow);
+}
+
 std::ostream& operator <<(std::ostream &os, const Glyph &arGlyph)
 {
     os << "Symbol: ";
@@ -98,5 +104,10 @@ std::vector<Glyph> Font::MakeGlyphs(const std::string &arText, int aLineSpacing)
     return mpImpl->MakeGlyphs(arText, aLineSpacing);
 }
 
+std::vector<Glyph> Font::MeasureGlyphs(const std::string &arText, int aLineSpacing) const
+{
+    return mpImpl->MeasureGlyphs(arText, aLineSpacing);
+}
+
 
 }
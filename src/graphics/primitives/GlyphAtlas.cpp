@@ -0,0 +1,65 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <cstring>
+#include <graphics/primitives/GlyphAtlas.h>
+
+namespace rsp::graphics {
+
+GlyphAtlas::GlyphAtlas(int aWidth, int aHeight)
+    : mWidth(aWidth),
+      mHeight(aHeight),
+      mPixels(static_cast<std::size_t>(aWidth * aHeight), 0)
+{
+}
+
+bool GlyphAtlas::Insert(const uint8_t *apPixels, int aWidth, int aHeight, int aPitch, Point &arPosition)
+{
+    if ((aWidth > mWidth) || (aHeight > mHeight)) {
+        return false;
+    }
+
+    // Best fit: the shelf with room that wastes the least height
+    Shelf *shelf = nullptr;
+    for (Shelf &s : mShelves) {
+        if ((s.mHeight >= aHeight) && ((mWidth - s.mUsedWidth) >= aWidth)) {
+            if (!shelf || (s.mHeight < shelf->mHeight)) {
+                shelf = &s;
+            }
+        }
+    }
+
+    if (!shelf) {
+        int top = mShelves.empty() ? 0 : (mShelves.back().mTop + mShelves.back().mHeight);
+        if ((top + aHeight) > mHeight) {
+            return false;
+        }
+        mShelves.push_back(Shelf { top, aHeight, 0 });
+        shelf = &mShelves.back();
+    }
+
+    arPosition = Point(shelf->mUsedWidth, shelf->mTop);
+    shelf->mUsedWidth += aWidth;
+    mUsedArea += aWidth * aHeight;
+
+    // A negative pitch means the rows are stored bottom up, so the top row is the last one in memory
+    const uint8_t *src = apPixels;
+    if (aPitch < 0) {
+        src += static_cast<std::ptrdiff_t>(aHeight - 1) * -aPitch;
+    }
+    uint8_t *dst = mPixels.data() + static_cast<std::size_t>(shelf->mTop * mWidth + arPosition.GetX());
+    for (int y = 0; y < aHeight; y++) {
+        std::memcpy(dst + static_cast<std::ptrdiff_t>(y) * mWidth,
+            src + static_cast<std::ptrdiff_t>(y) * aPitch, static_cast<std::size_t>(aWidth));
+    }
+    return true;
+}
+
+} /* namespace rsp::graphics */
@@ -0,0 +1,134 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <sys/stat.h>
+#include <graphics/primitives/ImageCache.h>
+
+namespace rsp::graphics
+{
+
+ImageCache& ImageCache::Get()
+{
+    static ImageCache instance;
+    return instance;
+}
+
+ImageCache::ImageCache(std::size_t aBudget)
+    : mBudget(aBudget)
+{
+}
+
+ImageCache::Image ImageCache::Load(const std::string &arFileName, const std::function<Image(const std::string&)> &arDecoder)
+{
+    struct stat info{};
+    if (stat(arFileName.c_str(), &info) != 0) {
+        // Let the decoder report the error
+        return arDecoder(arFileName);
+    }
+    int64_t modified = int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    int64_t file_size = int64_t(info.st_size);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mIndex.find(arFileName);
+        if ((it != mIndex.end()) && (it->second->mModified == modified) && (it->second->mFileSize == file_size)) {
+            mHits++;
+            mEntries.splice(mEntries.begin(), mEntries, it->second);
+            return it->second->mImage;
+        }
+        mMisses++;
+    }
+
+    Image image = arDecoder(arFileName);
+    std::size_t bytes = static_cast<std::size_t>(image.mWidth) * static_cast<std::size_t>(image.mHeight) * sizeof(uint32_t);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mIndex.find(arFileName);
+    if (it != mIndex.end()) {
+        // Outdated, or decoded by another thread meanwhile
+        erase(it->second);
+    }
+    if (bytes > mBudget) {
+        return image;
+    }
+    evict(mBudget - bytes);
+    mEntries.push_front(Entry{arFileName, modified, file_size, bytes, image});
+    mIndex[arFileName] = mEntries.begin();
+    mUsage += bytes;
+    return image;
+}
+
+void ImageCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+    mIndex.clear();
+    mUsage = 0;
+}
+
+void ImageCache::SetBudget(std::size_t aBytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBudget = aBytes;
+    evict(mBudget);
+}
+
+std::size_t ImageCache::GetBudget() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mBudget;
+}
+
+std::size_t ImageCache::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+std::size_t ImageCache::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mUsage;
+}
+
+std::size_t ImageCache::GetHits() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHits;
+}
+
+std::size_t ImageCache::GetMisses() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMisses;
+}
+
+void ImageCache::ResetStatistics()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mHits = 0;
+    mMisses = 0;
+}
+
+void ImageCache::erase(List_t::iterator aIt)
+{
+    mUsage -= aIt->mBytes;
+    mIndex.erase(aIt->mFileName);
+    mEntries.erase(aIt);
+}
+
+void ImageCache::evict(std::size_t aBudget)
+{
+    while (!mEntries.empty() && (mUsage > aBudget)) {
+        erase(std::prev(mEntries.end()));
+    }
+}
+
+} // namespace rsp::graphics
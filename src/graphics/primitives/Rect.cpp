@@ -8,6 +8,7 @@
  * \author      Simon Glashoff
  */
 
+#include <algorithm>
 #include <graphics/primitives/Rect.h>
 #include <utils/CoreException.h>
 
@@ -129,6 +130,45 @@ bool Rect::IsHit(const Point &arPoint) const
     return !(arPoint.mX < mLeftTop.mX || arPoint.mY < mLeftTop.mY || arPoint.mY >= mRightBottom.mY || arPoint.mX >= mRightBottom.mX);
 }
 
+bool Rect::IsEmpty() const
+{
+    return (GetWidth() <= 0) || (GetHeight() <= 0);
+}
+
+bool Rect::Intersects(const Rect &arRect) const
+{
+    return (mLeftTop.mX < arRect.mRightBottom.mX) && (arRect.mLeftTop.mX < mRightBottom.mX)
+        && (mLeftTop.mY < arRect.mRightBottom.mY) && (arRect.mLeftTop.mY < mRightBottom.mY);
+}
+
+Rect Rect::Intersection(const Rect &arRect) const
+{
+    if (!Intersects(arRect)) {
+        return Rect(mLeftTop, 0, 0);
+    }
+
+    return Rect(Point(std::max(mLeftTop.mX, arRect.mLeftTop.mX), std::max(mLeftTop.mY, arRect.mLeftTop.mY)),
+                Point(std::min(mRightBottom.mX, arRect.mRightBottom.mX), std::min(mRightBottom.mY, arRect.mRightBottom.mY)));
+}
+
+Rect Rect::Union(const Rect &arRect) const
+{
+    if (arRect.IsEmpty()) {
+        return *this;
+    }
+    if (IsEmpty()) {
+        return arRect;
+    }
+
+    return Rect(Point(std::min(mLeftTop.mX, arRect.mLeftTop.mX), std::min(mLeftTop.mY, arRect.mLeftTop.mY)),
+                Point(std::max(mRightBottom.mX, arRect.mRightBottom.mX), std::max(mRightBottom.mY, arRect.mRightBottom.mY)));
+}
+
+int Rect::GetArea() const
+{
+    return GetWidth() * GetHeight();
+}
+
 void Rect::VerifyDimensions() const
 {
     ASSERT(GetWidth() >= 0);
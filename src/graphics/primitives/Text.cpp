@@ -8,6 +8,7 @@
  * \author      Steffen Brummer
  */
 
+#include <algorithm>
 #include <graphics/primitives/Text.h>
 #include <logging/Logger.h>
 
@@ -43,42 +44,117 @@ Text& Text::Reload()
     }
 
     loadGlyphs();
+    invalidateSurface();
+    if (mCached) {
+        renderSurface();
+    }
     return *this;
 }
 
-void Text::scaleToFit()
+Text& Text::SetCached(bool aValue)
 {
-    int width = ((mArea.GetWidth() + (mLineMaxChar/2)) / mLineMaxChar); // Texts seems to be about 1/3 of desired width
-    int height = mArea.GetHeight() / mLineCount;
-    int done;
-    int attempts = 5;
-    int w_limit = mArea.GetWidth() * 90 / 100; // >90%
-    int h_limit = mArea.GetHeight() * 90 / 100; // > 90%
-    DLOG("scaleToFit w_limit: " << w_limit << " h_limit: " << h_limit);
+    mCached = aValue;
+    if (mCached) {
+        renderSurface();
+    }
+    else {
+        mSurface = Surface();
+    }
+    return *this;
+}
 
-    do {
-        mFont.SetSize(width, height);
+const Text::Surface* Text::GetSurface() const
+{
+    if (mSurface.mCoverage.empty() || (mSurfaceFontSize != mFont.GetSize()) || (mSurfaceFontStyle != mFont.GetStyle())) {
+        return nullptr;
+    }
+    return &mSurface;
+}
 
-        mGlyphs = mFont.MakeGlyphs(mValue, mLineSpacing);
-        auto r = CalcBoundingRect(mGlyphs);
+void Text::renderSurface()
+{
+    // Bounding box of the glyph bitmaps, limited to the text area
+    int left = mArea.GetWidth();
+    int top = mArea.GetHeight();
+    int right = 0;
+    int bottom = 0;
+    for (const Glyph &glyph : mGlyphs) {
+        if ((glyph.mBitmapWidth <= 0) || (glyph.mHeight <= 0)) {
+            continue;
+        }
+        left = std::min(left, std::max(glyph.mLeft, 0));
+        top = std::min(top, std::max(glyph.mTop, 0));
+        right = std::max(right, std::min(glyph.mLeft + glyph.mBitmapWidth, mArea.GetWidth()));
+        bottom = std::max(bottom, std::min(glyph.mTop + glyph.mHeight, mArea.GetHeight()));
+    }
+    mSurface.mCoverage.clear();
+    if ((right <= left) || (bottom <= top)) {
+        return;
+    }
 
-        done = 0;
-        if ((r.GetWidth() < w_limit) || (r.GetWidth() > mArea.GetWidth())) {
-            width += ((mArea.GetWidth() - r.GetWidth()) + (mLineMaxChar/2)) / mLineMaxChar;
+    mSurface.mArea = Rect(left, top, right - left, bottom - top);
+    const std::size_t width = std::size_t(right - left);
+    mSurface.mCoverage.resize(width * std::size_t(bottom - top), 0);
+    for (const Glyph &glyph : mGlyphs) {
+        int x0 = std::max(glyph.mLeft, left);
+        int x1 = std::min(glyph.mLeft + glyph.mBitmapWidth, right);
+        int y0 = std::max(glyph.mTop, top);
+        int y1 = std::min(glyph.mTop + glyph.mHeight, bottom);
+        if ((glyph.mBitmapWidth <= 0) || (x1 <= x0) || (y1 <= y0)) {
+            continue;
         }
-        else {
-            done++;
+        for (int y = y0; y < y1; y++) {
+            // Glyph boxes may overlap, combine the coverage like two blends on top of each other
+            const uint8_t *src = glyph.GetCoverage(y - glyph.mTop) + (x0 - glyph.mLeft);
+            uint8_t *dst = mSurface.mCoverage.data() + std::size_t(y - top) * width + std::size_t(x0 - left);
+            for (int x = x0; x < x1; x++) {
+                unsigned a = *dst;
+                unsigned b = *src++;
+                *dst++ = uint8_t(a + b - (a * b + 127) / 255);
+            }
         }
-        if ((r.GetHeight() < h_limit) || (r.GetHeight() > mArea.GetHeight())) {
-            height += (mArea.GetHeight() - r.GetHeight()) / mLineCount;
+    }
+    mSurfaceFontSize = mFont.GetSize();
+    mSurfaceFontStyle = mFont.GetStyle();
+}
+
+/**
+ * Find the largest value in [1, aHigh] where aFits returns true, assuming
+ * aFits is true up to some value and false above it. Returns 1 if nothing fits.
+ */
+template <class T>
+static int bisect(int aHigh, T aFits)
+{
+    int low = 1;
+    while (low < aHigh) {
+        int mid = low + (aHigh - low + 1) / 2;
+        if (aFits(mid)) {
+            low = mid;
         }
         else {
-            done++;
+            aHigh = mid - 1;
         }
     }
-    while( (done != 2) && --attempts);
-    DLOG("scaleToFit done: " << done << " attempts: " << attempts);
+    return low;
+}
 
+void Text::scaleToFit()
+{
+    // Search the pixel sizes with measured glyph metrics, only the final size is rendered.
+    // Glyphs are usually smaller than the pixel size, so allow sizes well above the area.
+    int width = std::max(1, (mArea.GetWidth() + (mLineMaxChar/2)) / mLineMaxChar);
+    int height = bisect(std::max(1, 2 * mArea.GetHeight() / mLineCount), [&](int aHeight) {
+        mFont.SetSize(width, aHeight);
+        return CalcBoundingRect(mFont.MeasureGlyphs(mValue, mLineSpacing)).GetHeight() < mArea.GetHeight();
+    });
+    width = bisect(std::max(1, 4 * mArea.GetWidth() / mLineMaxChar), [&](int aWidth) {
+        mFont.SetSize(aWidth, height);
+        return CalcBoundingRect(mFont.MeasureGlyphs(mValue, mLineSpacing)).GetWidth() < mArea.GetWidth();
+    });
+    DLOG("scaleToFit width: " << width << " height: " << height);
+
+    mFont.SetSize(width, height);
+    mGlyphs = mFont.MakeGlyphs(mValue, mLineSpacing);
     alignGlyphs();
 }
 
@@ -35,10 +35,8 @@ FreeTypeLibrary& FreeTypeLibrary::Get()
     return instance;
 }
 
-FT_Face FreeTypeLibrary::CreateFontFace(const std::string &arFontName, Font::Styles aStyle)
+SharedFace_t FreeTypeLibrary::GetFontFace(const std::string &arFontName, Font::Styles aStyle)
 {
-    DLOG("Creating font " << arFontName << " with style " << static_cast<int>(aStyle));
-
     auto it = mFontSets. find(arFontName);
     if (it == mFontSets.end()) {
         THROW_WITH_BACKTRACE1(FontException,  StrUtils::Format("Font named %s is not installed.", arFontName.c_str()));
@@ -52,15 +50,33 @@ FT_Face FreeTypeLibrary::CreateFontFace(const std::string &arFontName, Font::Sty
         }
     }
 
-    std::string filename = mFontSets[arFontName][aStyle].FileName;
-    FT_Long id = mFontSets[arFontName][aStyle].Id;
+    auto key = std::make_pair(arFontName, aStyle);
+    auto face = mFaces.find(key);
+    if (face != mFaces.end()) {
+        SharedFace_t result = face->second.lock();
+        if (result) {
+            return result;
+        }
+    }
+
+    // Forget the faces no Font object uses anymore
+    std::erase_if(mFaces, [](const auto &arEntry) { return arEntry.second.expired(); });
+
+    DLOG("Creating font " << arFontName << " with style " << static_cast<int>(aStyle));
+
+    const FontInfo &info = mFontSets[arFontName][aStyle];
+    SharedFace_t result(newFace(*info.File, info.Id), FT_Done_Face);
+    mFaces[key] = result;
+    return result;
+}
 
+FT_Face FreeTypeLibrary::newFace(const rsp::posix::MemoryMappedFile &arFile, FT_Long aId)
+{
     FT_Face result;
-    FT_Error error = FT_New_Face(mFtLib, filename.c_str(), id, &result);
+    FT_Error error = FT_New_Memory_Face(mFtLib, arFile.GetData(), static_cast<FT_Long>(arFile.GetSize()), aId, &result);
     if (error) {
-        THROW_WITH_BACKTRACE2(FontException, "FT_New_Face() failed", error);
+        THROW_WITH_BACKTRACE2(FontException, StrUtils::Format("FT_New_Memory_Face() failed trying to open %s", arFile.GetFileName().c_str()).c_str(), error);
     }
-
     return result;
 }
 
@@ -70,8 +86,14 @@ void FreeTypeLibrary::RegisterFont(const std::string &arFileName)
     FT_Long face_idx = 0;
     FT_Long instance_idx = 0;
 
+    std::shared_ptr<rsp::posix::MemoryMappedFile> &file = mFontFiles[arFileName];
+    if (!file) {
+        file = std::make_shared<rsp::posix::MemoryMappedFile>(arFileName);
+    }
+
     FontInfo info;
     info.FileName = arFileName;
+    info.File = file;
 
     do {
         if (face) {
@@ -80,11 +102,7 @@ void FreeTypeLibrary::RegisterFont(const std::string &arFileName)
 
         FT_Long id = ( instance_idx << 16 ) + face_idx;
 
-        FT_Error error = FT_New_Face(mFtLib, arFileName.c_str(), id, &face);
-
-        if (error) {
-            THROW_WITH_BACKTRACE2(FontException, StrUtils::Format("FT_New_Face() failed trying to open %s", arFileName.c_str()).c_str(), error);
-        }
+        face = newFace(*file, id);
 
         info.Id = id;
         info.StyleName = face->style_name;
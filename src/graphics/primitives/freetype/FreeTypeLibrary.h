@@ -13,7 +13,10 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <utility>
 #include <graphics/primitives/Font.h>
+#include <posix/MemoryMappedFile.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -24,12 +27,22 @@ struct FontInfo {
     std::string FileName{};
     std::string StyleName{};
     FT_Long Id = 0;
+    std::shared_ptr<rsp::posix::MemoryMappedFile> File{};
 };
 
+/**
+ * Shared FreeType face, the face is released when the last reference is gone.
+ */
+typedef std::shared_ptr<FT_FaceRec_> SharedFace_t;
+
 /**
  * \class FreeTypeLibrary
  * \brief Simple object to load the freetype library
  *
+ * Registered font files are memory mapped once, and faces are created
+ * directly from the mapped memory. A face is shared by all users of the
+ * same family and style, each user should create its own FT_Size object
+ * on the face and activate it before use.
  */
 class FreeTypeLibrary
 {
@@ -42,7 +55,15 @@ public:
         return mFtLib;
     }
 
-    FT_Face CreateFontFace(const std::string &arFontName, Font::Styles aStyle);
+    /**
+     * Get the face for the given family and style.
+     * Falls back to the normal style if the requested style is not installed.
+     *
+     * \param arFontName
+     * \param aStyle
+     * \return Shared face
+     */
+    SharedFace_t GetFontFace(const std::string &arFontName, Font::Styles aStyle);
 
 private:
     FreeTypeLibrary(void);
@@ -53,6 +74,10 @@ private:
     FT_Library mFtLib { };
 
     std::map<std::string, std::map<Font::Styles, FontInfo> > mFontSets{ };
+    std::map<std::string, std::shared_ptr<rsp::posix::MemoryMappedFile> > mFontFiles{ };
+    std::map<std::pair<std::string, Font::Styles>, std::weak_ptr<FT_FaceRec_> > mFaces{ };
+
+    FT_Face newFace(const rsp::posix::MemoryMappedFile &arFile, FT_Long aId);
 };
 
 }
@@ -9,12 +9,14 @@
  */
 
 #include "FreeTypeRawFont.h"
+#include "GlyphCache.h"
 #include <graphics/primitives/Font.h>
 #include <logging/Logger.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_OUTLINE_H
+#include FT_SIZES_H
 
 namespace rsp::graphics {
 
@@ -37,15 +39,6 @@ FontException::FontException(const char *aMsg, FT_Error aCode)
     mMsg.append((err) ? err : "N");
 }
 
-inline static uint unsign(int aValue)
-{
-    if (aValue < 0) {
-        return 0;
-    }
-
-    return static_cast<uint>(aValue);
-}
-
 Glyph::Glyph(void* apFace)
 {
     FT_Face arFace = reinterpret_cast<FT_Face>(apFace);
@@ -55,8 +48,9 @@ Glyph::Glyph(void* apFace)
     mTop = arFace->glyph->bitmap_top;
     mLeft = arFace->glyph->bitmap_left;
 
-    mPixels.resize(static_cast<std::vector<uint8_t>::size_type>(unsign(mWidth)) * unsign(mHeight), 0xFF);
-    memcpy(mPixels.data(), arFace->glyph->bitmap.buffer, mPixels.size());
+    if (mWidth && mHeight) {
+        GlyphCache::Get().Pack(arFace->glyph->bitmap.buffer, mWidth, mHeight, arFace->glyph->bitmap.pitch, *this);
+    }
 }
 
 
@@ -75,20 +69,38 @@ std::vector<Glyph> FreeTypeRawFont::MakeGlyphs(const std::string &arText, int aL
 {
     createFace();
 
-    std::u32string unicode = stringToU32(arText);
-    int line_height = 0;
-
     std::vector<Glyph> result;
-    for (char32_t c : unicode) {
+    for (char32_t c : stringToU32(arText)) {
         result.push_back(getSymbol(c, mStyle));
-        line_height = std::max(line_height, result.back().mHeight);
-        auto rs = result.size();
-        if (rs > 1) {
-            result[rs - 2].mWidth += getKerning(result[rs - 2].mSymbolUnicode, result[rs - 1].mSymbolUnicode);
+    }
+    layoutGlyphs(result, aLineSpacing);
+    return result;
+}
+
+std::vector<Glyph> FreeTypeRawFont::MeasureGlyphs(const std::string &arText, int aLineSpacing)
+{
+    createFace();
+
+    std::vector<Glyph> result;
+    for (char32_t c : stringToU32(arText)) {
+        result.push_back(measureSymbol(c));
+    }
+    layoutGlyphs(result, aLineSpacing);
+    return result;
+}
+
+void FreeTypeRawFont::layoutGlyphs(std::vector<Glyph> &arGlyphs, int aLineSpacing) const
+{
+    int line_height = 0;
+
+    for (std::size_t i = 0 ; i < arGlyphs.size() ; i++) {
+        line_height = std::max(line_height, arGlyphs[i].mHeight);
+        if (i > 0) {
+            arGlyphs[i - 1].mWidth += getKerning(arGlyphs[i - 1].mSymbolUnicode, arGlyphs[i].mSymbolUnicode);
 
             // Space ' ' has no width, add width of next character to space character
-            if (result[rs - 2].mWidth == 0) {
-                result[rs - 2].mWidth = mSizePx;
+            if (arGlyphs[i - 1].mWidth == 0) {
+                arGlyphs[i - 1].mWidth = mSizePx;
             }
         }
     }
@@ -97,7 +109,7 @@ std::vector<Glyph> FreeTypeRawFont::MakeGlyphs(const std::string &arText, int aL
 
     int top = line_height;
     int left = 0;
-    for (Glyph &glyph : result) {
+    for (Glyph &glyph : arGlyphs) {
         if (glyph.mSymbolUnicode == static_cast<uint32_t>('\n')) {
             top += line_height + aLineSpacing;
             left = 0;
@@ -108,7 +120,6 @@ std::vector<Glyph> FreeTypeRawFont::MakeGlyphs(const std::string &arText, int aL
             left += glyph.mWidth;
         }
     }
-    return result;
 }
 
 std::string FreeTypeRawFont::GetFamilyName() const
@@ -120,10 +131,12 @@ void FreeTypeRawFont::SetSize(int aWidthPx, int aHeightPx)
 {
     createFace();
 
-    FT_Error error = FT_Set_Pixel_Sizes(mpFace, static_cast<uint32_t>(aWidthPx), static_cast<uint32_t>(aHeightPx));
+    FT_Error error = FT_Set_Pixel_Sizes(mpFace.get(), static_cast<uint32_t>(aWidthPx), static_cast<uint32_t>(aHeightPx));
     if (error) {
         THROW_WITH_BACKTRACE2(FontException, "FT_Set_Pixel_Sizes() failed", error);
     }
+    mWidthPx = aWidthPx;
+    mHeightPx = aHeightPx;
     mSizePx = std::min(aWidthPx, aHeightPx);
     DLOG("Font.SetSize(" << aWidthPx << ", " << aHeightPx << ") -> " << mSizePx);
 }
@@ -136,6 +149,19 @@ void FreeTypeRawFont::SetStyle(Font::Styles aStyle)
 
 
 Glyph FreeTypeRawFont::getSymbol(uint32_t aSymbolCode, Font::Styles aStyle) const
+{
+    GlyphCache::Key key { mFontName, aStyle, mWidthPx, mHeightPx, aSymbolCode };
+    Glyph result;
+    if (GlyphCache::Get().Lookup(key, result)) {
+        return result;
+    }
+
+    result = renderSymbol(aSymbolCode, aStyle);
+    GlyphCache::Get().Insert(key, result);
+    return result;
+}
+
+Glyph FreeTypeRawFont::renderSymbol(uint32_t aSymbolCode, Font::Styles aStyle) const
 {
 #undef FT_LOAD_TARGET_
 #define FT_LOAD_TARGET_( x )   ( static_cast<FT_Int32>(( (x) & 15 ) << 16 ) )
@@ -146,7 +172,7 @@ Glyph FreeTypeRawFont::getSymbol(uint32_t aSymbolCode, Font::Styles aStyle) cons
         return nl;
     }
 
-    FT_Error error = FT_Load_Char(mpFace, aSymbolCode, FT_LOAD_RENDER /*| FT_LOAD_TARGET_LCD_V*/);
+    FT_Error error = FT_Load_Char(mpFace.get(), aSymbolCode, FT_LOAD_RENDER /*| FT_LOAD_TARGET_LCD_V*/);
     if (error) {
         THROW_WITH_BACKTRACE2(FontException, "FT_Load_Char() failed", error);
     }
@@ -155,11 +181,39 @@ Glyph FreeTypeRawFont::getSymbol(uint32_t aSymbolCode, Font::Styles aStyle) cons
         FT_Outline_Embolden( &mpFace->glyph->outline,  (1 << 6));
     }
 
-    Glyph Result { mpFace };
+    Glyph Result { mpFace.get() };
     Result.mSymbolUnicode = aSymbolCode;
     return Result;
 }
 
+Glyph FreeTypeRawFont::measureSymbol(uint32_t aSymbolCode) const
+{
+    Glyph result;
+    result.mSymbolUnicode = aSymbolCode;
+    if (aSymbolCode == '\n') {
+        return result;
+    }
+
+    FT_Error error = FT_Load_Char(mpFace.get(), aSymbolCode, FT_LOAD_DEFAULT | FT_LOAD_NO_BITMAP);
+    if (error) {
+        THROW_WITH_BACKTRACE2(FontException, "FT_Load_Char() failed", error);
+    }
+
+    // Same pixel box as the rendered bitmap would get, from the 26.6 fixed point metrics
+    const FT_Glyph_Metrics &metrics = mpFace->glyph->metrics;
+    FT_Pos left = metrics.horiBearingX >> 6;
+    FT_Pos right = (metrics.horiBearingX + metrics.width + 63) >> 6;
+    FT_Pos top = (metrics.horiBearingY + 63) >> 6;
+    FT_Pos bottom = (metrics.horiBearingY - metrics.height) >> 6;
+    if (metrics.width && metrics.height) {
+        result.mWidth = static_cast<int>(right - left);
+        result.mHeight = static_cast<int>(top - bottom);
+    }
+    result.mLeft = static_cast<int>(left);
+    result.mTop = static_cast<int>(top);
+    return result;
+}
+
 int FreeTypeRawFont::getKerning(uint aFirst, uint aSecond, uint aKerningMode) const
 {
     if (aKerningMode == 0) {
@@ -170,10 +224,10 @@ int FreeTypeRawFont::getKerning(uint aFirst, uint aSecond, uint aKerningMode) co
         return 0;
     }
 
-    FT_UInt IndexFirst = FT_Get_Char_Index(mpFace, aFirst);
-    FT_UInt IndexSecond = FT_Get_Char_Index(mpFace, aSecond);
+    FT_UInt IndexFirst = FT_Get_Char_Index(mpFace.get(), aFirst);
+    FT_UInt IndexSecond = FT_Get_Char_Index(mpFace.get(), aSecond);
     FT_Vector delta { };
-    FT_Error error = FT_Get_Kerning(mpFace, IndexFirst, IndexSecond, aKerningMode, &delta);
+    FT_Error error = FT_Get_Kerning(mpFace.get(), IndexFirst, IndexSecond, aKerningMode, &delta);
     if (error) {
         THROW_WITH_BACKTRACE2(FontException, "FT_Get_Kerning() failed", error);
     }
@@ -184,18 +238,35 @@ int FreeTypeRawFont::getKerning(uint aFirst, uint aSecond, uint aKerningMode) co
 void FreeTypeRawFont::createFace()
 {
     if (mpFace) {
+        // The face is shared, make sure our size is the active one
+        FT_Activate_Size(mpSize);
         return;
     }
 
-    mpFace = FreeTypeLibrary::Get().CreateFontFace(mFontName, mStyle);
+    mpFace = FreeTypeLibrary::Get().GetFontFace(mFontName, mStyle);
+
+    FT_Error error = FT_New_Size(mpFace.get(), &mpSize);
+    if (error) {
+        THROW_WITH_BACKTRACE2(FontException, "FT_New_Size() failed", error);
+    }
+    FT_Activate_Size(mpSize);
+
+    // Keep the size when the face is recreated, cached glyphs are keyed by it
+    if (mWidthPx && mHeightPx) {
+        error = FT_Set_Pixel_Sizes(mpFace.get(), static_cast<uint32_t>(mWidthPx), static_cast<uint32_t>(mHeightPx));
+        if (error) {
+            THROW_WITH_BACKTRACE2(FontException, "FT_Set_Pixel_Sizes() failed", error);
+        }
+    }
 }
 
 void FreeTypeRawFont::freeFace()
 {
-    if (mpFace) {
-        FT_Done_Face(mpFace);
-        mpFace = nullptr;
+    if (mpSize) {
+        FT_Done_Size(mpSize);
+        mpSize = nullptr;
     }
+    mpFace.reset();
 }
 
 std::u32string FreeTypeRawFont::stringToU32(const std::string &arText) const
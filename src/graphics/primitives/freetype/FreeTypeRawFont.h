@@ -20,6 +20,9 @@ namespace rsp::graphics {
 /**
  * \class FreeTypeRawFont
  * \brief A FontRawInterface implementation for the FreeType library.
+ *
+ * The FreeType face is shared with other fonts of the same family and style,
+ * only the size object is owned by this font.
  */
 class FreeTypeRawFont : public FontRawInterface
 {
@@ -28,19 +31,26 @@ public:
     ~FreeTypeRawFont();
 
     std::vector<Glyph> MakeGlyphs(const std::string &arText, int aLineSpacing) override;
+    std::vector<Glyph> MeasureGlyphs(const std::string &arText, int aLineSpacing) override;
     std::string GetFamilyName() const override;
     void SetSize(int aWidthPx, int aHeightPx) override;
     void SetStyle(Font::Styles aStyle) override;
 
 protected:
-    FT_Face mpFace = nullptr;
+    SharedFace_t mpFace{};
+    FT_Size mpSize = nullptr;
     std::string mFontName{};
+    int mWidthPx = 0;
+    int mHeightPx = 0;
     FreeTypeRawFont(const FreeTypeRawFont&) = delete;
     FreeTypeRawFont& operator=(const FreeTypeRawFont&) = delete;
 
     void createFace();
     void freeFace();
     Glyph getSymbol(uint32_t aSymbolCode, Font::Styles aStyle) const;
+    Glyph renderSymbol(uint32_t aSymbolCode, Font::Styles aStyle) const;
+    Glyph measureSymbol(uint32_t aSymbolCode) const;
+    void layoutGlyphs(std::vector<Glyph> &arGlyphs, int aLineSpacing) const;
     int getKerning(uint aFirst, uint aSecond, uint aKerningMode = 0) const;
     std::u32string stringToU32(const std::string &arText) const;
 };
@@ -0,0 +1,148 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <algorithm>
+#include "GlyphCache.h"
+
+namespace rsp::graphics {
+
+bool GlyphCache::Key::operator==(const Key &arOther) const
+{
+    return (mSymbolUnicode == arOther.mSymbolUnicode)
+        && (mWidthPx == arOther.mWidthPx)
+        && (mHeightPx == arOther.mHeightPx)
+        && (mStyle == arOther.mStyle)
+        && (mFamilyName == arOther.mFamilyName);
+}
+
+std::size_t GlyphCache::KeyHash::operator()(const Key &arKey) const noexcept
+{
+    std::size_t h = std::hash<std::string>()(arKey.mFamilyName);
+    h = h * 31 + static_cast<std::size_t>(arKey.mStyle);
+    h = h * 31 + static_cast<std::size_t>(arKey.mWidthPx);
+    h = h * 31 + static_cast<std::size_t>(arKey.mHeightPx);
+    return h * 31 + arKey.mSymbolUnicode;
+}
+
+GlyphCache& GlyphCache::Get()
+{
+    static GlyphCache instance;
+    return instance;
+}
+
+GlyphCache::GlyphCache(std::size_t aCapacity)
+    : mCapacity(aCapacity)
+{
+}
+
+bool GlyphCache::Lookup(const Key &arKey, Glyph &arGlyph)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mIndex.find(arKey);
+    if (it == mIndex.end()) {
+        mMisses++;
+        return false;
+    }
+    mHits++;
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    arGlyph = it->second->second;
+    return true;
+}
+
+void GlyphCache::Insert(const Key &arKey, const Glyph &arGlyph)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mCapacity == 0) {
+        return;
+    }
+
+    auto it = mIndex.find(arKey);
+    if (it != mIndex.end()) {
+        it->second->second = arGlyph;
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+        return;
+    }
+
+    evict(mCapacity - 1);
+    mEntries.emplace_front(arKey, arGlyph);
+    mIndex[arKey] = mEntries.begin();
+}
+
+void GlyphCache::Pack(const uint8_t *apPixels, int aWidth, int aHeight, int aPitch, Glyph &arGlyph)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Point pos;
+    if (!mpAtlas || !mpAtlas->Insert(apPixels, aWidth, aHeight, aPitch, pos)) {
+        // Glyphs larger than the default size get an atlas of their own
+        mpAtlas = std::make_shared<GlyphAtlas>(std::max(aWidth, GlyphAtlas::cDefaultSize), std::max(aHeight, GlyphAtlas::cDefaultSize));
+        mpAtlas->Insert(apPixels, aWidth, aHeight, aPitch, pos);
+    }
+    arGlyph.mpAtlas = mpAtlas;
+    arGlyph.mAtlasLeft = pos.GetX();
+    arGlyph.mAtlasTop = pos.GetY();
+    arGlyph.mBitmapWidth = aWidth;
+}
+
+void GlyphCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    evict(0);
+}
+
+void GlyphCache::SetCapacity(std::size_t aCapacity)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCapacity = aCapacity;
+    evict(mCapacity);
+}
+
+std::size_t GlyphCache::GetCapacity() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCapacity;
+}
+
+std::size_t GlyphCache::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+std::size_t GlyphCache::GetHits() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHits;
+}
+
+std::size_t GlyphCache::GetMisses() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMisses;
+}
+
+void GlyphCache::ResetStatistics()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mHits = 0;
+    mMisses = 0;
+}
+
+void GlyphCache::evict(std::size_t aCapacity)
+{
+    while (mEntries.size() > aCapacity) {
+        mIndex.erase(mEntries.back().first);
+        mEntries.pop_back();
+    }
+}
+
+}
@@ -0,0 +1,124 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef SRC_GRAPHICS_PRIMITIVES_FREETYPE_GLYPHCACHE_H_
+#define SRC_GRAPHICS_PRIMITIVES_FREETYPE_GLYPHCACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <graphics/primitives/Font.h>
+#include <graphics/primitives/GlyphAtlas.h>
+
+namespace rsp::graphics {
+
+/**
+ * \class GlyphCache
+ * \brief Bounded least recently used cache of rasterized glyphs.
+ *
+ * Glyphs are identified by font family, style, pixel size and unicode symbol,
+ * so all Font objects using the same family share the cached glyphs.
+ * The cache also owns the glyph atlas new glyphs are packed into.
+ */
+class GlyphCache
+{
+public:
+    static constexpr std::size_t cDefaultCapacity = 512;
+
+    struct Key {
+        std::string mFamilyName{};
+        Font::Styles mStyle = Font::Styles::Normal;
+        int mWidthPx = 0;
+        int mHeightPx = 0;
+        uint32_t mSymbolUnicode = 0;
+
+        bool operator==(const Key &arOther) const;
+    };
+
+    /**
+     * Get the cache shared by all fonts.
+     *
+     * \return GlyphCache
+     */
+    static GlyphCache& Get();
+
+    GlyphCache(std::size_t aCapacity = cDefaultCapacity);
+
+    /**
+     * Look up a glyph, and mark it as most recently used if found.
+     *
+     * \param arKey
+     * \param arGlyph Receives a copy of the cached glyph
+     * \return True if found
+     */
+    bool Lookup(const Key &arKey, Glyph &arGlyph);
+
+    /**
+     * Insert a glyph, evicting the least recently used glyph if the cache is full.
+     *
+     * \param arKey
+     * \param arGlyph
+     */
+    void Insert(const Key &arKey, const Glyph &arGlyph);
+
+    /**
+     * Store coverage pixels of a new glyph in the current atlas.
+     * If the atlas is full, a new atlas is started. Glyphs packed into the
+     * previous atlas keep it alive for as long as they exist.
+     *
+     * \param apPixels
+     * \param aWidth
+     * \param aHeight
+     * \param aPitch Number of bytes between rows in apPixels, negative if the rows are stored bottom up
+     * \param arGlyph Receives the atlas location
+     */
+    void Pack(const uint8_t *apPixels, int aWidth, int aHeight, int aPitch, Glyph &arGlyph);
+
+    /**
+     * Remove all glyphs. The statistics are kept.
+     */
+    void Clear();
+
+    /**
+     * Set the maximum number of glyphs held by the cache.
+     *
+     * \param aCapacity
+     */
+    void SetCapacity(std::size_t aCapacity);
+    std::size_t GetCapacity() const;
+
+    std::size_t GetSize() const;
+
+    std::size_t GetHits() const;
+    std::size_t GetMisses() const;
+    void ResetStatistics();
+
+protected:
+    struct KeyHash {
+        std::size_t operator()(const Key &arKey) const noexcept;
+    };
+    typedef std::list<std::pair<Key, Glyph>> List_t;
+
+    mutable std::mutex mMutex{};
+    std::size_t mCapacity;
+    std::size_t mHits = 0;
+    std::size_t mMisses = 0;
+    List_t mEntries{}; // Most recently used first
+    std::unordered_map<Key, List_t::iterator, KeyHash> mIndex{};
+    std::shared_ptr<GlyphAtlas> mpAtlas{};
+
+    void evict(std::size_t aCapacity);
+};
+
+}
+
+#endif /* SRC_GRAPHICS_PRIMITIVES_FREETYPE_GLYPHCACHE_H_ */
@@ -10,12 +10,15 @@
 
 #include <graphics/primitives/raster/BmpLoader.h>
 
-#include <algorithm>
-//#include <cerrno>
-#include <fstream>
+#include <bit>
+#include <climits>
+#include <cstdlib>
 #include <iostream>
-#include <graphics/primitives/Color.h>
+#include <graphics/kernels/RowKernels.h>
 #include <logging/Logger.h>
+#include <posix/MemoryMappedFile.h>
+#include <utils/CoreException.h>
+#include <utils/ExceptionHelper.h>
 
 namespace rsp::graphics
 {
@@ -68,88 +71,134 @@ std::ostream& operator <<(std::ostream &os, const BmpLoader::BmpHeader_t &arHead
 }
 
 
-std::vector<uint32_t> BmpLoader::LoadImg(const std::string &aImgName)
-{
-    mImagePixels.clear();
-
-    std::ifstream file;
-
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    file.open(aImgName, std::ifstream::binary);
-
-    ReadHeader(file);
-    // TODO: Get Compression and other useful stuff
+/**
+ * Channel of a 32 bit pixel selected by a BI_BITFIELDS mask.
+ */
+struct BmpChannel {
+    uint32_t mMask;
+    unsigned mShift;
+    unsigned mBits;
+
+    BmpChannel(uint32_t aMask)
+        : mMask(aMask),
+          mShift(aMask ? static_cast<unsigned>(std::countr_zero(aMask)) : 0),
+          mBits(static_cast<unsigned>(std::popcount(aMask)))
+    {
+    }
 
-    // Height can be negative, showing the image is stored from top to bottom
-    bool normallyDrawn = true;
-    if (mBmpHeader.v1.heigth < 0) {
-        normallyDrawn = false;
+    uint32_t Extract(uint32_t aPixel) const
+    {
+        uint32_t value = (aPixel & mMask) >> mShift;
+        if (mBits >= 8) {
+            return value >> (mBits - 8);
+        }
+        if (mBits == 0) {
+            return 0;
+        }
+        return value * 255 / ((1u << mBits) - 1);
     }
-    ReadData(file);
+};
 
-    file.close();
+void BmpLoader::LoadImg(const std::string &aImgName, std::vector<uint32_t> &arPixels)
+{
+    rsp::posix::MemoryMappedFile file(aImgName);
 
-    if (normallyDrawn) {
-        std::reverse(mImagePixels.begin(), mImagePixels.end());
-    }
-    return mImagePixels;
+    ReadHeader(file.GetData(), file.GetSize());
+    ReadData(file.GetData(), file.GetSize(), arPixels);
 }
 
-void BmpLoader::ReadHeader(std::ifstream &aFile)
+void BmpLoader::ReadHeader(const uint8_t *apData, std::size_t aSize)
 {
-    // Read the 54 byte header
-    aFile.read(reinterpret_cast<char *>(&mBmpHeader), sizeof(mBmpHeader));
+    // The file header and at least a BITMAPINFOHEADER must be present
+    if (aSize < offsetof(BmpHeader_t, v1) + sizeof(BitmapInfoHeader)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "BMP file is too small");
+    }
+    std::memset(&mBmpHeader, 0, sizeof(mBmpHeader));
+    std::memcpy(&mBmpHeader, apData, std::min(aSize, sizeof(mBmpHeader)));
 
     DLOG(mBmpHeader);
 
-    mWidth = mBmpHeader.v1.width;
-    mHeight = mBmpHeader.v1.heigth;
-
-    mBytesPerPixel = mBmpHeader.v1.bitsPerPixel / 8; // Might be 1 or 4
-    if ((mBmpHeader.v1.bitsPerPixel % 8) > 0) {
-        mBytesPerPixel = mBytesPerPixel + 1;
+    if (mBmpHeader.signature != 0x4D42) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "File is not a BMP file");
+    }
+    if ((mBmpHeader.v1.width <= 0) || (mBmpHeader.v1.heigth == 0) || (mBmpHeader.v1.heigth == INT32_MIN)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid BMP dimensions");
+    }
+    if ((mBmpHeader.v1.bitsPerPixel != 24) && (mBmpHeader.v1.bitsPerPixel != 32)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Unsupported BMP format: " + std::to_string(static_cast<unsigned>(mBmpHeader.v1.bitsPerPixel)) + " bits per pixel");
     }
+    // BI_RGB, or BI_BITFIELDS and BI_ALPHABITFIELDS for 32 bit pixels
+    uint32_t compression = mBmpHeader.v1.compression;
+    if ((compression != 0) && !((mBmpHeader.v1.bitsPerPixel == 32) && ((compression == 3) || (compression == 6)))) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Unsupported BMP compression: " + std::to_string(compression));
+    }
+
+    // Height can be negative, showing the image is stored from top to bottom
+    mWidth = mBmpHeader.v1.width;
+    mHeight = std::abs(mBmpHeader.v1.heigth);
+    mBytesPerPixel = mBmpHeader.v1.bitsPerPixel / 8;
 }
 
-void BmpLoader::ReadData(std::ifstream &aFile)
+void BmpLoader::ReadData(const uint8_t *apData, std::size_t aSize, std::vector<uint32_t> &arPixels)
 {
-    // Figure out amount to read per row
-    int paddedRowSize = (mBmpHeader.v1.width * mBytesPerPixel + 3) & (~3);
-    DLOG("Padded Row size: " << paddedRowSize);
-
-    // Initialize containers for reading
-    std::vector<uint8_t> pixelRow;
-    pixelRow.resize(static_cast<unsigned long int>(paddedRowSize));
-
-    // Skip past the offset
-    aFile.seekg(mBmpHeader.dataOffset);
+    std::size_t width = static_cast<std::size_t>(mWidth);
+    std::size_t height = static_cast<std::size_t>(mHeight);
+    // Rows are padded to 4 bytes
+    std::size_t row_size = (width * mBytesPerPixel + 3) & ~std::size_t(3);
+    DLOG("Padded Row size: " << row_size);
+
+    if ((mBmpHeader.dataOffset > aSize) || ((aSize - mBmpHeader.dataOffset) / row_size < height)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "BMP file is truncated");
+    }
 
-    for (size_t i = 0; i < abs(mBmpHeader.v1.heigth); i++) {
-        // Read a Row of pixels with the padding
-        aFile.read(reinterpret_cast<char *>(pixelRow.data()), paddedRowSize);
+    arPixels.resize(width * height);
 
-        for (int j = mBmpHeader.v1.width * mBytesPerPixel; j > 0; j -= mBytesPerPixel) {
-            uint32_t combined = ReadPixel(pixelRow, static_cast<size_t>(j - mBytesPerPixel));
-            mImagePixels.push_back(combined);
+    // The masks of BI_BITFIELDS follow the info header, where the V4 header has them as well
+    BmpChannel red(0x00FF0000), green(0x0000FF00), blue(0x000000FF), alpha(0);
+    if (mBmpHeader.v1.compression != 0) {
+        red = BmpChannel(mBmpHeader.v4.RedMask);
+        green = BmpChannel(mBmpHeader.v4.GreenMask);
+        blue = BmpChannel(mBmpHeader.v4.BlueMask);
+        if ((mBmpHeader.v1.compression == 6) || (mBmpHeader.v1.size >= 56)) {
+            alpha = BmpChannel(mBmpHeader.v4.AlphaMask);
         }
     }
-}
-
-uint32_t BmpLoader::ReadPixel(const std::vector<uint8_t> &aPixelRow, const size_t &aRowPtr)
-{
-    Color pixel = 0;
-    // Reads other direction than the row loop
-    if (mBytesPerPixel == 4) {
-        pixel.SetRed(aPixelRow[aRowPtr + 3]);
-        pixel.SetGreen(aPixelRow[aRowPtr + 2]);
-        pixel.SetBlue(aPixelRow[aRowPtr + 1]);
-        pixel.SetAlpha(aPixelRow[aRowPtr + 0]);
-    }
-    else {
-        for (size_t i = 0; i < mBytesPerPixel; i++) {
-            pixel = static_cast<uint32_t>(pixel) | ((static_cast<uint32_t>(aPixelRow[aRowPtr + i])) << (8 * i));
+    bool is_argb = (red.mMask == 0x00FF0000) && (green.mMask == 0x0000FF00) && (blue.mMask == 0x000000FF) && (alpha.mMask == 0xFF000000);
+    bool is_rgba = (red.mMask == 0xFF000000) && (green.mMask == 0x00FF0000) && (blue.mMask == 0x0000FF00) && (alpha.mMask == 0x000000FF);
+    // BI_RGB stores blue, green, red and an unused byte, decoded like 24 bit pixels
+    bool is_xrgb = (red.mMask == 0x00FF0000) && (green.mMask == 0x0000FF00) && (blue.mMask == 0x000000FF) && (alpha.mMask == 0);
+
+    // Rows are stored bottom up, unless the height is negative
+    const uint8_t *src = apData + mBmpHeader.dataOffset;
+    bool bottom_up = (mBmpHeader.v1.heigth > 0);
+    for (std::size_t y = 0; y < height; y++, src += row_size) {
+        uint32_t *dst = arPixels.data() + (bottom_up ? (height - 1 - y) : y) * width;
+
+        if (mBytesPerPixel == 3) {
+            RowKernels::Expand24To32(dst, src, width, 0);
+            continue;
+        }
+        std::memcpy(dst, src, width * sizeof(uint32_t));
+        if (is_argb) {
+            continue;
+        }
+        if (is_xrgb) {
+            for (std::size_t x = 0; x < width; x++) {
+                dst[x] &= 0x00FFFFFF;
+            }
+            continue;
+        }
+        if (is_rgba) {
+            for (std::size_t x = 0; x < width; x++) {
+                dst[x] = std::rotr(dst[x], 8);
+            }
+            continue;
+        }
+        for (std::size_t x = 0; x < width; x++) {
+            uint32_t pixel = dst[x];
+            dst[x] = (alpha.Extract(pixel) << 24) | (red.Extract(pixel) << 16) | (green.Extract(pixel) << 8) | blue.Extract(pixel);
         }
     }
-    return pixel;
 }
+
 } // namespace rsp::graphics
@@ -8,170 +8,454 @@
  * \author      Simon Glashoff
  */
 
+#define ZLIB_CONST
+#include <zlib.h>
+
 #include <graphics/primitives/raster/PngLoader.h>
-#include <utils/CoreException.h>
-#include <cerrno>
-#include <iomanip>
 
-using namespace rsp::utils;
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <graphics/kernels/PngKernels.h>
+#include <posix/MemoryMappedFile.h>
+#include <utils/CoreException.h>
+#include <utils/Crc32.h>
+#include <utils/ExceptionHelper.h>
 
 namespace rsp::graphics
 {
 
+static uint32_t readBe32(const uint8_t *apData)
+{
+    return (uint32_t(apData[0]) << 24) | (uint32_t(apData[1]) << 16) | (uint32_t(apData[2]) << 8) | apData[3];
+}
+
+static uint16_t readBe16(const uint8_t *apData)
+{
+    return static_cast<uint16_t>((apData[0] << 8) | apData[1]);
+}
 
-std::vector<uint32_t> PngLoader::LoadImg(const std::string &aImgName)
+static constexpr uint32_t chunkId(const char (&arName)[5])
 {
-    throw NotImplementedException("Png file format is not supported");
-    std::cout << "Bitmap reading file: " << aImgName << std::endl;
-    errno = 0;
+    return (uint32_t(uint8_t(arName[0])) << 24) | (uint32_t(uint8_t(arName[1])) << 16)
+        | (uint32_t(uint8_t(arName[2])) << 8) | uint32_t(uint8_t(arName[3]));
+}
+
+/**
+ * Position and spacing of the pixels in a pass of an image.
+ * Images that are not interlaced have a single pass covering all pixels.
+ */
+struct PngPass {
+    uint8_t mX;
+    uint8_t mY;
+    uint8_t mStepX;
+    uint8_t mStepY;
+};
+
+static constexpr PngPass cSinglePass[1] = { {0, 0, 1, 1} };
+static constexpr PngPass cAdam7Passes[7] = {
+    {0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4}, {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}
+};
 
-    //Pass reference to the first element in string, and read as binary
-    FILE *file = fopen(aImgName.c_str(), "rb");
-    if (file == NULL) {
-        std::cout << "File is null" << std::endl;
-        std::cout << "Error: " << errno << std::endl;
+/**
+ * Inflates the image data into a single row at a time.
+ * Only the row being filled and the previous unfiltered row are kept.
+ */
+class PngLoader::IdatDecoder
+{
+  public:
+    IdatDecoder(const PngLoader &arLoader, uint32_t *apPixels)
+        : mrLoader(arLoader),
+          mpPixels(apPixels),
+          mpPasses(arLoader.mHeader.mInterlaced ? cAdam7Passes : cSinglePass),
+          mPassCount(arLoader.mHeader.mInterlaced ? 7 : 1),
+          mBitsPerPixel(arLoader.getChannels() * arLoader.mHeader.mBitDepth)
+    {
+        if (inflateInit(&mStream) != Z_OK) {
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Could not initialize PNG decompression");
+        }
+        mBytesPerPixel = std::max(std::size_t(1), std::size_t(mBitsPerPixel / 8));
+        std::size_t row_size = 1 + rowBytes(mrLoader.mHeader.mWidth);
+        mBuffer.resize(2 * row_size);
+        mpCurrent = mBuffer.data();
+        mpPrevious = mBuffer.data() + row_size;
+        startPass(0);
     }
 
-    //Read header and verify that it is a png file
-    uint8_t signature[8];
-    if (fread(signature, sizeof(signature), 1 , file) != 1) {
-        THROW_SYSTEM("Could not read signature.");
+    ~IdatDecoder()
+    {
+        inflateEnd(&mStream);
     }
-    if (!CheckSignature(signature, 8)) {
-        throw CoreException("Signature not matching"); //return;  //Some error, probably just throw exception
+
+    IdatDecoder(const IdatDecoder&) = delete;
+    IdatDecoder& operator=(const IdatDecoder&) = delete;
+
+    /**
+     * Decode the data of an IDAT chunk.
+     */
+    void Feed(const uint8_t *apData, uint32_t aLength)
+    {
+        mStream.next_in = apData;
+        mStream.avail_in = aLength;
+
+        while (!IsComplete()) {
+            std::size_t wanted = 1 + mRowBytes;
+            mStream.next_out = mpCurrent + mFilled;
+            mStream.avail_out = static_cast<uInt>(wanted - mFilled);
+
+            int result = inflate(&mStream, Z_NO_FLUSH);
+            if ((result != Z_OK) && (result != Z_STREAM_END) && (result != Z_BUF_ERROR)) {
+                THROW_WITH_BACKTRACE1(rsp::utils::CoreException,
+                    std::string("PNG image data is corrupt: ") + (mStream.msg ? mStream.msg : "unknown error"));
+            }
+            mFilled = wanted - mStream.avail_out;
+            if (mFilled < wanted) {
+                if (result == Z_STREAM_END) {
+                    THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG image data is incomplete");
+                }
+                // All input of this chunk is used
+                return;
+            }
+            processRow();
+        }
     }
 
-    // TODO: Declare structs for data handling
-    PNGChunk pngchunk;
+    bool IsComplete() const
+    {
+        return mPass >= mPassCount;
+    }
 
-    //-- Chunk reading loop begins here --
+  protected:
+    const PngLoader &mrLoader;
+    uint32_t *mpPixels;
+    const PngPass *mpPasses;
+    unsigned mPassCount;
+    unsigned mBitsPerPixel;
+    std::size_t mBytesPerPixel = 1;
+    z_stream mStream{};
+    std::vector<uint8_t> mBuffer{};
+    uint8_t *mpCurrent = nullptr;  // Filter type byte followed by the row
+    uint8_t *mpPrevious = nullptr;
+    std::size_t mFilled = 0;
+    unsigned mPass = 0;
+    std::size_t mPassWidth = 0;
+    std::size_t mPassHeight = 0;
+    std::size_t mRowBytes = 0;
+    std::size_t mRow = 0;
 
-    //Temp loop for testing
-    for (size_t i = 0; i < 3; i++) {
-        //Read length and type
-        if (fread(&pngchunk, sizeof(pngchunk.length) + sizeof(pngchunk.type), 1, file) != 1) {
-            THROW_SYSTEM("Could not read PNG chunk header.");
+    std::size_t rowBytes(std::size_t aWidth) const
+    {
+        return (aWidth * mBitsPerPixel + 7) / 8;
+    }
+
+    static std::size_t passSize(uint32_t aSize, uint8_t aStart, uint8_t aStep)
+    {
+        return (aSize > aStart) ? (aSize - aStart + aStep - 1u) / aStep : 0;
+    }
+
+    /**
+     * Start the first pass from the given one that has any pixels.
+     */
+    void startPass(unsigned aPass)
+    {
+        for (mPass = aPass; mPass < mPassCount; mPass++) {
+            const PngPass &pass = mpPasses[mPass];
+            mPassWidth = passSize(mrLoader.mHeader.mWidth, pass.mX, pass.mStepX);
+            mPassHeight = passSize(mrLoader.mHeader.mHeight, pass.mY, pass.mStepY);
+            if ((mPassWidth > 0) && (mPassHeight > 0)) {
+                break;
+            }
         }
-        //Flip length
-        pngchunk.length = be32toh(pngchunk.length);
-
-        std::cout << "Type: " << pngchunk.type << std::endl;
-        std::cout << "Length: " << pngchunk.length << std::endl;
-
-        //If critcal chunk
-        if (std::isupper(pngchunk.type[0])) {
-            std::cout << "Chunk is Critical" << std::endl;
-            //Chunk is critical
-            //If IHDR chunk
-            if (std::strcmp(pngchunk.type, "IHDR") == 0) {
-                std::cout << "IHDR chunk recognized" << std::endl;
-
-                //Allocate buffer size of chunk length plus crc
-                pngchunk.data = new uint8_t[pngchunk.length + sizeof(uint32_t)];
-
-                //Use length to read the chunks data field
-                //Read chunk and crc into data buffer
-                if (fread(pngchunk.data, pngchunk.length + sizeof(uint32_t), 1, file) != 1) { // read whole chunk
-                    THROW_SYSTEM("Could not read PNG chunk data.");
-                }
+        mRowBytes = rowBytes(mPassWidth);
+        mRow = 0;
+        mFilled = 0;
+        // The row above the first row of a pass counts as zero
+        std::memset(mpPrevious, 0, 1 + mRowBytes);
+    }
 
-                //Flip time
-                //Only flip things that are larger than a byte
-                pngchunk.ihdr->width = be32toh(pngchunk.ihdr->width);
-                pngchunk.ihdr->height = be32toh(pngchunk.ihdr->height);
-                /* TODO: Maybe, maybe not flip crc
-                 * (uint32_t*)(&pngchunk.data[pngchunk.length]) = be32toh(*(uint32_t*)(&pngchunk.data[pngchunk.length]));
-                 */
+    void processRow()
+    {
+        if (!PngKernels::Unfilter(mpCurrent[0], mpCurrent + 1, mpPrevious + 1, mRowBytes, mBytesPerPixel)) {
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid PNG filter type: " + std::to_string(static_cast<unsigned>(mpCurrent[0])));
+        }
 
-                //Set important bitmap variables
-                mWidth = static_cast<int>(pngchunk.ihdr->width);
-                mHeight = static_cast<int>(pngchunk.ihdr->height);
+        const PngPass &pass = mpPasses[mPass];
+        std::size_t y = pass.mY + mRow * pass.mStepY;
+        mrLoader.convertRow(mpCurrent + 1, mPassWidth, mpPixels + y * mrLoader.mHeader.mWidth + pass.mX, pass.mStepX);
 
-                std::cout << "Width       :" << pngchunk.ihdr->width << std::endl;
-                std::cout << "Height      :" << pngchunk.ihdr->height << std::endl;
-                std::cout << "Bit Depth   :" << +pngchunk.ihdr->bitDepth << std::endl;
-                std::cout << "Colour Type :" << +pngchunk.ihdr->colourType << std::endl;
-                std::cout << "Compression :" << +pngchunk.ihdr->compressionMethod << std::endl;
-                std::cout << "Filter      :" << +pngchunk.ihdr->filterMethod << std::endl;
-                std::cout << "Interlace   :" << +pngchunk.ihdr->interlaceMethod << std::endl;
+        std::swap(mpCurrent, mpPrevious);
+        mFilled = 0;
+        if (++mRow == mPassHeight) {
+            startPass(mPass + 1);
+        }
+    }
+};
 
-                std::cout << "Crc         :" << std::hex << *reinterpret_cast<uint32_t*>(&pngchunk.data[pngchunk.length]) << std::endl;
-                std::cout << std::dec;
+void PngLoader::LoadImg(const std::string &aImgName, std::vector<uint32_t> &arPixels)
+{
+    rsp::posix::MemoryMappedFile file(aImgName);
+    const uint8_t *data = file.GetData();
+    std::size_t size = file.GetSize();
 
-                // TODO Stuff save or use header info
+    if ((size < sizeof(cPngSignature)) || (std::memcmp(data, cPngSignature, sizeof(cPngSignature)) != 0)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "File is not a PNG file");
+    }
 
-            }
-            //If IDAT chunk
-            else if (std::strcmp(pngchunk.type, "IDAT") == 0) {
-                std::cout << "IDAT chunk recognized" << std::endl;
+    mHeader = Header{};
+    mPaletteSize = 0;
+    mHasColorKey = false;
 
-                //Allocate buffer size of chunk length plus crc
-                pngchunk.data = new uint8_t[pngchunk.length + sizeof(uint32_t)];
+    std::unique_ptr<IdatDecoder> decoder;
+    bool has_header = false;
+    bool ended = false;
+    std::size_t pos = sizeof(cPngSignature);
+    while (!ended) {
+        // Length, type, data and CRC
+        if (size - pos < 12) {
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG file is truncated");
+        }
+        uint32_t length = readBe32(data + pos);
+        if (length > size - pos - 12) {
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG file is truncated");
+        }
+        const uint8_t *type = data + pos + 4;
+        const uint8_t *chunk = type + 4;
+        if (rsp::utils::Crc32::Calc(type, length + 4) != readBe32(chunk + length)) {
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG chunk CRC mismatch");
+        }
+        pos += 12 + length;
 
-                //Use length to read the chunks data field
-                if (fread(pngchunk.data, pngchunk.length + sizeof(uint32_t), 1, file) != 1) {
-                    THROW_SYSTEM("Could not read PNG IDAT chunk.");
+        uint32_t id = readBe32(type);
+        if (!has_header && (id != chunkId("IHDR"))) {
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG file does not start with a header");
+        }
+        switch (id) {
+            case chunkId("IHDR"):
+                if (has_header) {
+                    THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG file has more than one header");
                 }
+                ReadHeader(chunk, length);
+                has_header = true;
+                break;
 
-                //Decode
+            case chunkId("PLTE"):
+                ReadPalette(chunk, length);
+                break;
 
-                /* TODO: Maybe, maybe not flip crc
-                 *(uint32_t*)(&pngchunk.data[pngchunk.length]) = be32toh(*(uint32_t*)(&pngchunk.data[pngchunk.length]));
-                 * TODO do something with crc
-                 */
-                std::cout << "Crc: " << std::hex << *reinterpret_cast<uint32_t*>(&pngchunk.data[pngchunk.length]) << std::endl;
-                std::cout << std::dec;
+            case chunkId("tRNS"):
+                ReadTransparency(chunk, length);
+                break;
 
-            }
-            //If PLTE chunk | Do i really need?
-            else if (std::strcmp(pngchunk.type, "PLTE") == 0) {
-                std::cout << "PLTE chunk recognized" << std::endl;
-                throw NotImplementedException("Don't know how to handle PLTE chunks");
-            }
-            //If IEND
-            else if (std::strcmp(pngchunk.type, "IEND") == 0) {
-                std::cout << "IEND chunk recognized" << std::endl;
-                //Stop reading
-            } else {
-                std::cout << pngchunk.type << " Chunk type not recognized" << std::endl;
-            }
-        } else {
-            std::cout << "Chunk is Non-Critical" << std::endl;
-            //Chunk is not critical
-            //Seek the chunks length of data plus its crc
-            fseek(file, static_cast<long int>(pngchunk.length + sizeof(uint32_t)), SEEK_CUR);
-            //Read next chunk
-        }
-        //Clean up memory
-        if (pngchunk.data != nullptr) {
-            delete[] pngchunk.data;
-            pngchunk.data = nullptr;
+            case chunkId("IDAT"):
+                if (!decoder) {
+                    if ((mHeader.mColorType == ColorTypes::Palette) && (mPaletteSize == 0)) {
+                        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG palette is missing");
+                    }
+                    arPixels.resize(std::size_t(mHeader.mWidth) * mHeader.mHeight);
+                    decoder = std::make_unique<IdatDecoder>(*this, arPixels.data());
+                }
+                decoder->Feed(chunk, length);
+                break;
+
+            case chunkId("IEND"):
+                ended = true;
+                break;
+
+            default:
+                // Ancillary chunks have a lower case first letter and can be skipped
+                if ((type[0] & 0x20) == 0) {
+                    THROW_WITH_BACKTRACE1(rsp::utils::CoreException,
+                        "Unsupported critical PNG chunk: " + std::string(reinterpret_cast<const char*>(type), 4));
+                }
+                break;
         }
-        std::cout << std::endl;
     }
 
-    fclose(file);
+    if (!decoder || !decoder->IsComplete()) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "PNG image data is incomplete");
+    }
+    mWidth = static_cast<int>(mHeader.mWidth);
+    mHeight = static_cast<int>(mHeader.mHeight);
+}
+
+void PngLoader::ReadHeader(const uint8_t *apData, uint32_t aLength)
+{
+    if (aLength != 13) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid PNG header size");
+    }
+    mHeader.mWidth = readBe32(apData);
+    mHeader.mHeight = readBe32(apData + 4);
+    mHeader.mBitDepth = apData[8];
+    mHeader.mColorType = static_cast<ColorTypes>(apData[9]);
+    mHeader.mInterlaced = (apData[12] == 1);
+
+    // The pixels must fit in a Bitmap, and in a 1GB buffer
+    if ((mHeader.mWidth == 0) || (mHeader.mHeight == 0) || (mHeader.mWidth > 0x7FFFFFFF) || (mHeader.mHeight > 0x7FFFFFFF)
+        || (uint64_t(mHeader.mWidth) * mHeader.mHeight > (uint64_t(1) << 28))) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid PNG dimensions");
+    }
+    if ((apData[10] != 0) || (apData[11] != 0) || (apData[12] > 1)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Unsupported PNG compression, filter or interlace method");
+    }
 
-    return mImagePixels;
+    uint8_t depth = mHeader.mBitDepth;
+    bool valid;
+    switch (mHeader.mColorType) {
+        case ColorTypes::Gray:
+            valid = (depth == 1) || (depth == 2) || (depth == 4) || (depth == 8) || (depth == 16);
+            break;
+        case ColorTypes::Palette:
+            valid = (depth == 1) || (depth == 2) || (depth == 4) || (depth == 8);
+            break;
+        case ColorTypes::Rgb:
+        case ColorTypes::GrayAlpha:
+        case ColorTypes::Rgba:
+            valid = (depth == 8) || (depth == 16);
+            break;
+        default:
+            valid = false;
+            break;
+    }
+    if (!valid) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Unsupported PNG format: color type " + std::to_string(static_cast<unsigned>(apData[9]))
+            + " with " + std::to_string(static_cast<unsigned>(depth)) + " bits");
+    }
 }
 
-bool PngLoader::CheckSignature(const uint8_t *aSig, const uint8_t &aSize)
+void PngLoader::ReadPalette(const uint8_t *apData, uint32_t aLength)
 {
-    //Do loop they decay to pointers
-    //Or use std::array
-    for (size_t i = 0; i < 8; i++) {
-        if (aSig[i] != mPngSignature[i]) {
-            return false;
-        }
+    if ((aLength == 0) || (aLength % 3 != 0) || (aLength / 3 > mPalette.size())) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid PNG palette size");
+    }
+    mPaletteSize = aLength / 3;
+    // Indexes outside the palette give opaque black
+    mPalette.fill(0xFF000000);
+    for (std::size_t i = 0; i < mPaletteSize; i++, apData += 3) {
+        mPalette[i] = 0xFF000000 | (uint32_t(apData[0]) << 16) | (uint32_t(apData[1]) << 8) | apData[2];
     }
-    return true;
 }
-void PngLoader::ReadHeader(FILE *file)
+
+void PngLoader::ReadTransparency(const uint8_t *apData, uint32_t aLength)
 {
+    switch (mHeader.mColorType) {
+        case ColorTypes::Palette:
+            // One alpha value per palette entry, the remaining entries are opaque
+            for (std::size_t i = 0; i < std::min(std::size_t(aLength), mPaletteSize); i++) {
+                mPalette[i] = (mPalette[i] & 0x00FFFFFF) | (uint32_t(apData[i]) << 24);
+            }
+            break;
+
+        case ColorTypes::Gray:
+            if (aLength >= 2) {
+                mColorKey[0] = readBe16(apData);
+                mHasColorKey = true;
+            }
+            break;
+
+        case ColorTypes::Rgb:
+            if (aLength >= 6) {
+                mColorKey = { readBe16(apData), readBe16(apData + 2), readBe16(apData + 4) };
+                mHasColorKey = true;
+            }
+            break;
+
+        default:
+            // Not allowed for images with an alpha channel, ignore it
+            break;
+    }
 }
-void PngLoader::ReadData(FILE *file)
+
+unsigned PngLoader::getChannels() const
 {
+    switch (mHeader.mColorType) {
+        case ColorTypes::Rgb:
+            return 3;
+        case ColorTypes::GrayAlpha:
+            return 2;
+        case ColorTypes::Rgba:
+            return 4;
+        default: // Gray and Palette
+            return 1;
+    }
 }
 
+void PngLoader::convertRow(const uint8_t *apRow, std::size_t aWidth, uint32_t *apDst, std::size_t aStep) const
+{
+    unsigned depth = mHeader.mBitDepth;
+    // Samples are stored big endian, the high byte is used for 16 bit samples
+    std::size_t sample_bytes = (depth == 16) ? 2 : 1;
+
+    switch (mHeader.mColorType) {
+        case ColorTypes::Rgba: {
+            std::size_t pixel_bytes = 4 * sample_bytes;
+            for (std::size_t x = 0; x < aWidth; x++, apRow += pixel_bytes, apDst += aStep) {
+                *apDst = (uint32_t(apRow[3 * sample_bytes]) << 24) | (uint32_t(apRow[0]) << 16)
+                    | (uint32_t(apRow[sample_bytes]) << 8) | apRow[2 * sample_bytes];
+            }
+            break;
+        }
+
+        case ColorTypes::Rgb: {
+            std::size_t pixel_bytes = 3 * sample_bytes;
+            for (std::size_t x = 0; x < aWidth; x++, apRow += pixel_bytes, apDst += aStep) {
+                uint32_t alpha = 0xFF000000;
+                if (mHasColorKey) {
+                    bool keyed = (sample_bytes == 2)
+                        ? (readBe16(apRow) == mColorKey[0]) && (readBe16(apRow + 2) == mColorKey[1]) && (readBe16(apRow + 4) == mColorKey[2])
+                        : (apRow[0] == mColorKey[0]) && (apRow[1] == mColorKey[1]) && (apRow[2] == mColorKey[2]);
+                    alpha = keyed ? 0 : alpha;
+                }
+                *apDst = alpha | (uint32_t(apRow[0]) << 16) | (uint32_t(apRow[sample_bytes]) << 8) | apRow[2 * sample_bytes];
+            }
+            break;
+        }
+
+        case ColorTypes::GrayAlpha: {
+            std::size_t pixel_bytes = 2 * sample_bytes;
+            for (std::size_t x = 0; x < aWidth; x++, apRow += pixel_bytes, apDst += aStep) {
+                uint32_t gray = apRow[0];
+                *apDst = (uint32_t(apRow[sample_bytes]) << 24) | (gray << 16) | (gray << 8) | gray;
+            }
+            break;
+        }
+
+        case ColorTypes::Gray: {
+            if (depth >= 8) {
+                for (std::size_t x = 0; x < aWidth; x++, apRow += sample_bytes, apDst += aStep) {
+                    unsigned sample = (depth == 16) ? readBe16(apRow) : apRow[0];
+                    uint32_t gray = apRow[0];
+                    uint32_t alpha = (mHasColorKey && (sample == mColorKey[0])) ? 0 : 0xFF000000;
+                    *apDst = alpha | (gray << 16) | (gray << 8) | gray;
+                }
+                break;
+            }
+            // Samples are packed from the most significant bit and scaled to the full range
+            unsigned max = (1u << depth) - 1;
+            for (std::size_t x = 0; x < aWidth; x++, apDst += aStep) {
+                std::size_t bit = x * depth;
+                unsigned sample = (apRow[bit / 8] >> (8 - depth - bit % 8)) & max;
+                uint32_t gray = sample * 255 / max;
+                uint32_t alpha = (mHasColorKey && (sample == mColorKey[0])) ? 0 : 0xFF000000;
+                *apDst = alpha | (gray << 16) | (gray << 8) | gray;
+            }
+            break;
+        }
+
+        default: { // ColorTypes::Palette
+            if (depth == 8) {
+                for (std::size_t x = 0; x < aWidth; x++, apDst += aStep) {
+                    *apDst = mPalette[apRow[x]];
+                }
+                break;
+            }
+            unsigned max = (1u << depth) - 1;
+            for (std::size_t x = 0; x < aWidth; x++, apDst += aStep) {
+                std::size_t bit = x * depth;
+                *apDst = mPalette[(apRow[bit / 8] >> (8 - depth - bit % 8)) & max];
+            }
+            break;
+        }
+    }
 }
 
+}
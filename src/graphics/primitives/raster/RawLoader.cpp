@@ -0,0 +1,158 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <graphics/primitives/raster/RawLoader.h>
+
+#include <cstring>
+#include <endian.h>
+#include <graphics/kernels/PixelKernels.h>
+#include <posix/FileIO.h>
+#include <posix/MemoryMappedFile.h>
+#include <utils/CoreException.h>
+#include <utils/Crc32.h>
+#include <utils/ExceptionHelper.h>
+
+namespace rsp::graphics
+{
+
+static constexpr char cRawMagic[4] = { 'R', 'S', 'P', 'R' };
+
+static BufferedCanvas::PixelFormats toPixelFormat(uint16_t aValue)
+{
+    switch (aValue) {
+        case static_cast<uint16_t>(BufferedCanvas::PixelFormats::XRGB8888):
+        case static_cast<uint16_t>(BufferedCanvas::PixelFormats::RGB888):
+        case static_cast<uint16_t>(BufferedCanvas::PixelFormats::RGB565):
+            return static_cast<BufferedCanvas::PixelFormats>(aValue);
+        default:
+            THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Unsupported raw image pixel format: " + std::to_string(unsigned(aValue)));
+    }
+}
+
+void RawLoader::LoadImg(const std::string &arImgName, std::vector<uint32_t> &arPixels)
+{
+    rsp::posix::MemoryMappedFile file(arImgName);
+    ReadHeader(file.GetData(), file.GetSize());
+    VerifyData(file.GetData());
+
+    std::size_t width = mHeader.mWidth;
+    const PixelKernels::Table &kernels = PixelKernels::Get(toPixelFormat(mHeader.mPixelFormat));
+    arPixels.resize(width * mHeader.mHeight);
+
+    const uint8_t *src = file.GetData() + mHeader.mDataOffset;
+    for (std::size_t y = 0; y < mHeader.mHeight; y++, src += mHeader.mStride) {
+        kernels.toArgb(arPixels.data() + y * width, src, width);
+    }
+}
+
+std::shared_ptr<const uint32_t> RawLoader::MapImg(const std::string &arImgName)
+{
+    auto file = std::make_shared<rsp::posix::MemoryMappedFile>(arImgName);
+    ReadHeader(file->GetData(), file->GetSize());
+
+    bool native = (mHeader.mPixelFormat == static_cast<uint16_t>(BufferedCanvas::PixelFormats::XRGB8888))
+        && (mHeader.mStride == mHeader.mWidth * sizeof(uint32_t));
+    if (!native) {
+        // LoadImg verifies and converts the pixels, so they are only read once
+        return {};
+    }
+    VerifyData(file->GetData());
+    // The pixels keep the file mapped for as long as they are used
+    return std::shared_ptr<const uint32_t>(file, reinterpret_cast<const uint32_t*>(file->GetData() + mHeader.mDataOffset));
+}
+
+void RawLoader::ReadHeader(const uint8_t *apData, std::size_t aSize)
+{
+    if (aSize < sizeof(RawHeader)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Raw image file is too small");
+    }
+    std::memcpy(&mHeader, apData, sizeof(mHeader));
+    mHeader.mVersion = le16toh(mHeader.mVersion);
+    mHeader.mPixelFormat = le16toh(mHeader.mPixelFormat);
+    mHeader.mWidth = le32toh(mHeader.mWidth);
+    mHeader.mHeight = le32toh(mHeader.mHeight);
+    mHeader.mStride = le32toh(mHeader.mStride);
+    mHeader.mDataOffset = le32toh(mHeader.mDataOffset);
+    mHeader.mDataSize = le32toh(mHeader.mDataSize);
+    mHeader.mDataCrc = le32toh(mHeader.mDataCrc);
+
+    if (std::memcmp(mHeader.mMagic, cRawMagic, sizeof(cRawMagic)) != 0) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "File is not a raw image file");
+    }
+    if (mHeader.mVersion != cVersion) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Unsupported raw image version: " + std::to_string(unsigned(mHeader.mVersion)));
+    }
+    std::size_t bytes_per_pixel = PixelKernels::Get(toPixelFormat(mHeader.mPixelFormat)).mBytesPerPixel;
+    if ((mHeader.mWidth == 0) || (mHeader.mHeight == 0) || (mHeader.mWidth > 0x7FFFFFFF) || (mHeader.mHeight > 0x7FFFFFFF)
+        || (mHeader.mStride < mHeader.mWidth * bytes_per_pixel)
+        || (uint64_t(mHeader.mStride) * mHeader.mHeight != mHeader.mDataSize)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid raw image dimensions");
+    }
+    // Rows are used in place, so 32 bit pixels must be aligned
+    if ((mHeader.mDataOffset % sizeof(uint32_t) != 0) || (mHeader.mDataOffset > aSize) || (aSize - mHeader.mDataOffset < mHeader.mDataSize)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Raw image file is truncated");
+    }
+
+    mWidth = static_cast<int>(mHeader.mWidth);
+    mHeight = static_cast<int>(mHeader.mHeight);
+}
+
+void RawLoader::VerifyData(const uint8_t *apData) const
+{
+    if (rsp::utils::Crc32::Calc(apData + mHeader.mDataOffset, mHeader.mDataSize) != mHeader.mDataCrc) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Raw image CRC mismatch");
+    }
+}
+
+void RawLoader::Save(const std::string &arFileName, const uint32_t *apPixels, int aWidth, int aHeight, BufferedCanvas::PixelFormats aFormat)
+{
+    if ((aWidth <= 0) || (aHeight <= 0)) {
+        THROW_WITH_BACKTRACE1(rsp::utils::CoreException, "Invalid raw image dimensions");
+    }
+    const PixelKernels::Table &kernels = PixelKernels::Get(aFormat);
+    std::size_t width = static_cast<std::size_t>(aWidth);
+    // Rows are padded to 4 bytes
+    std::size_t stride = (width * kernels.mBytesPerPixel + 3) & ~std::size_t(3);
+
+    RawHeader header{};
+    std::memcpy(header.mMagic, cRawMagic, sizeof(cRawMagic));
+    header.mVersion = cVersion;
+    header.mPixelFormat = static_cast<uint16_t>(aFormat);
+    header.mWidth = static_cast<uint32_t>(aWidth);
+    header.mHeight = static_cast<uint32_t>(aHeight);
+    header.mStride = static_cast<uint32_t>(stride);
+    header.mDataOffset = cDataOffset;
+    header.mDataSize = static_cast<uint32_t>(stride * static_cast<std::size_t>(aHeight));
+
+    rsp::posix::FileIO file(arFileName, std::ios_base::out | std::ios_base::trunc, 0644);
+    file.Seek(cDataOffset);
+    std::vector<uint8_t> row(stride, 0);
+    for (int y = 0; y < aHeight; y++, apPixels += width) {
+        kernels.fromArgb(row.data(), apPixels, width);
+        header.mDataCrc = rsp::utils::Crc32::Calc(row.data(), stride, header.mDataCrc);
+        file.Write(row.data(), stride);
+    }
+
+    // The header is written last, when the CRC is known
+    header.mVersion = htole16(header.mVersion);
+    header.mPixelFormat = htole16(header.mPixelFormat);
+    header.mWidth = htole32(header.mWidth);
+    header.mHeight = htole32(header.mHeight);
+    header.mStride = htole32(header.mStride);
+    header.mDataOffset = htole32(header.mDataOffset);
+    header.mDataSize = htole32(header.mDataSize);
+    header.mDataCrc = htole32(header.mDataCrc);
+    std::vector<uint8_t> head(cDataOffset, 0);
+    std::memcpy(head.data(), &header, sizeof(header));
+    file.Seek(0);
+    file.Write(head.data(), head.size());
+}
+
+} // namespace rsp::graphics
@@ -0,0 +1,81 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <sys/mman.h>
+#include <posix/FileIO.h>
+#include <posix/MemoryMappedFile.h>
+#include <utils/ExceptionHelper.h>
+
+namespace rsp::posix
+{
+
+MemoryMappedFile::MemoryMappedFile(const std::string &arFileName)
+{
+    Open(arFileName);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile &&arOther) noexcept
+    : mFileName(std::move(arOther.mFileName)),
+      mpData(arOther.mpData),
+      mSize(arOther.mSize)
+{
+    arOther.mFileName.clear();
+    arOther.mpData = nullptr;
+    arOther.mSize = 0;
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile &&arOther) noexcept
+{
+    if (this != &arOther) {
+        Close();
+        mFileName = std::move(arOther.mFileName);
+        mpData = arOther.mpData;
+        mSize = arOther.mSize;
+        arOther.mFileName.clear();
+        arOther.mpData = nullptr;
+        arOther.mSize = 0;
+    }
+    return *this;
+}
+
+void MemoryMappedFile::Open(const std::string &arFileName)
+{
+    Close();
+
+    // The mapping stays valid after the file handle is closed
+    FileIO file(arFileName, std::ios_base::in);
+    std::size_t size = file.GetSize();
+    if (size) {
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.GetHandle(), 0);
+        if (p == MAP_FAILED) {
+            THROW_SYSTEM("Error mapping file " + arFileName);
+        }
+        mpData = static_cast<const uint8_t*>(p);
+    }
+    mSize = size;
+    mFileName = arFileName;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (mpData) {
+        munmap(const_cast<uint8_t*>(mpData), mSize);
+    }
+    mpData = nullptr;
+    mSize = 0;
+    mFileName.clear();
+}
+
+} /* namespace rsp::posix */
@@ -8,6 +8,8 @@
  * \author      Steffen Brummer
  */
 
+#include <array>
+#include <cstring>
 #include <utils/Crc32.h>
 
 namespace rsp::utils {
@@ -45,14 +47,54 @@ std::uint32_t* Crc32::getTable()
 }
 
 
+/**
+ * Tables for processing 8 bytes per step. Entry k of a table is the CRC of
+ * a byte followed by k zero bytes, so the CRCs of the bytes of a 64 bit
+ * word can be looked up independently and combined.
+ */
+typedef std::array<std::array<std::uint32_t, 256>, 8> SliceTables_t;
+
+static const SliceTables_t& sliceTables()
+{
+    static const SliceTables_t tables = []() {
+        SliceTables_t result{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int j = 0; j < 8; j++) {
+                c = (c & 1) ? (cCRC32_POLY ^ (c >> 1)) : (c >> 1);
+            }
+            result[0][i] = c;
+        }
+        for (std::size_t k = 1; k < result.size(); k++) {
+            for (std::size_t i = 0; i < 256; i++) {
+                uint32_t previous = result[k - 1][i];
+                result[k][i] = (previous >> 8) ^ result[0][previous & 0xFF];
+            }
+        }
+        return result;
+    }();
+    return tables;
+}
+
 std::uint32_t Crc32::Calc(const void* aBuf, std::size_t aLen, std::uint32_t aInitial)
 {
-    std::uint32_t* table = getTable();
+    const SliceTables_t &t = sliceTables();
     uint32_t c = aInitial ^ cCRC32_XOR_MASK;
     const uint8_t* u = static_cast<const uint8_t*>(aBuf);
 
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    for (; aLen >= 8 ; aLen -= 8, u += 8) {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, u, sizeof(low));
+        std::memcpy(&high, u + 4, sizeof(high));
+        low ^= c;
+        c = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+          ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+#endif
     for (std::size_t i = 0 ; i < aLen ; i++) {
-        c = table[(c ^ u[i]) & 0xFF] ^ (c >> 8);
+        c = t[0][(c ^ u[i]) & 0xFF] ^ (c >> 8);
     }
     return c ^ cCRC32_XOR_MASK;
 }
@@ -0,0 +1,33 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+#ifndef TESTS_UNIT_GRAPHICS_CANVASCOMPARE_H_
+#define TESTS_UNIT_GRAPHICS_CANVASCOMPARE_H_
+
+#include <graphics/MemoryCanvas.h>
+
+/**
+ * Count the pixels that differ between the back buffers of two canvases of the same size.
+ *
+ * \param arA
+ * \param arB
+ * \return Number of different pixels
+ */
+inline int countDifferences(const rsp::graphics::MemoryCanvas &arA, const rsp::graphics::MemoryCanvas &arB)
+{
+    int errors = 0;
+    for (int y = 0 ; y < arA.GetHeight() ; y++) {
+        for (int x = 0 ; x < arA.GetWidth() ; x++) {
+            errors += (arA.GetPixel(rsp::graphics::Point(x, y)) != arB.GetPixel(rsp::graphics::Point(x, y)));
+        }
+    }
+    return errors;
+}
+
+#endif /* TESTS_UNIT_GRAPHICS_CANVASCOMPARE_H_ */
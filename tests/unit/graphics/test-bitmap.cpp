@@ -9,9 +9,17 @@
  */
 
 #include <doctest.h>
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+#include <functional>
+#include <fstream>
 #include <graphics/primitives/Bitmap.h>
 #include <graphics/primitives/Color.h>
+#include <graphics/primitives/raster/RawLoader.h>
 #include <utils/CoreException.h>
+#include <utils/Crc32.h>
+#include <zlib.h>
 
 using namespace rsp::utils;
 using namespace rsp::graphics;
@@ -72,9 +80,19 @@ TEST_CASE("Bitmap file loading")
         // Arrange
         std::string filepath = "testImages/testImage.png";
 
-        // Act / Assert
-        CHECK_THROWS_WITH_AS(Bitmap bitmap(filepath), "Png file format is not supported",
-                             const NotImplementedException &);
+        // Act
+        Bitmap png(filepath);
+        Bitmap bmp("testImages/testImage.bmp");
+
+        // Assert
+        REQUIRE(png.GetWidth() == 259);
+        REQUIRE(png.GetHeight() == 194);
+        std::size_t differences = 0;
+        for (std::size_t i = 0; i < png.GetPixels().size(); i++) {
+            differences += ((png.GetPixels()[i] & 0xFFFFFF) != (bmp.GetPixels()[i] & 0xFFFFFF));
+        }
+        CHECK(differences == 0);
+        CHECK((png.GetPixels()[0] >> 24) == 0xFF);
     }
     SUBCASE("Loading filetype not found")
     {
@@ -104,3 +122,592 @@ TEST_CASE("Bitmap empty construction")
         CHECK(bitmap.GetPixel(pt) == col);
     }
 }
+
+static void put16(std::vector<uint8_t> &arData, uint32_t aValue)
+{
+    arData.push_back(static_cast<uint8_t>(aValue));
+    arData.push_back(static_cast<uint8_t>(aValue >> 8));
+}
+
+static void put32(std::vector<uint8_t> &arData, uint32_t aValue)
+{
+    put16(arData, aValue);
+    put16(arData, aValue >> 16);
+}
+
+/**
+ * Write a BMP file with the given rows of pixels, in file order.
+ * A V4 header with masks is written if masks are given.
+ */
+static void writeBmp(const std::string &arName, int aWidth, int aHeight, uint16_t aBitsPerPixel,
+    const std::vector<uint32_t> &arMasks, const std::vector<uint8_t> &arPixelData)
+{
+    uint32_t header_size = arMasks.empty() ? 40 : 108;
+    std::vector<uint8_t> data;
+    put16(data, 0x4D42);
+    put32(data, static_cast<uint32_t>(14 + header_size + arPixelData.size()));
+    put32(data, 0);
+    put32(data, 14 + header_size);
+    put32(data, header_size);
+    put32(data, static_cast<uint32_t>(aWidth));
+    put32(data, static_cast<uint32_t>(aHeight));
+    put16(data, 1);
+    put16(data, aBitsPerPixel);
+    put32(data, arMasks.empty() ? 0 : 3);
+    put32(data, static_cast<uint32_t>(arPixelData.size()));
+    for (int i = 0; i < 4; i++) {
+        put32(data, 0);
+    }
+    for (uint32_t mask : arMasks) {
+        put32(data, mask);
+    }
+    data.resize(14 + header_size);
+    data.insert(data.end(), arPixelData.begin(), arPixelData.end());
+
+    std::ofstream file(arName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+TEST_CASE("Bmp pixel layouts")
+{
+    const char *cFileName = "layout.bmp";
+    // Top row first
+    const uint32_t cPixels[2][3] = {
+        { 0xFF102030, 0x80405060, 0x00708090 },
+        { 0xFFA0B0C0, 0x11D0E0F0, 0x22010203 }
+    };
+
+    auto check = [&](uint32_t aMask) {
+        // The file is rewritten faster than the resolution of its modification time
+        ImageCache::Get().Clear();
+        Bitmap bitmap(cFileName);
+        REQUIRE(bitmap.GetWidth() == 3);
+        REQUIRE(bitmap.GetHeight() == 2);
+        for (int y = 0; y < 2; y++) {
+            for (int x = 0; x < 3; x++) {
+                CHECK(bitmap.GetPixel(Point(x, y)) == (cPixels[y][x] & aMask));
+            }
+        }
+    };
+
+    auto rows24 = [&](bool aBottomUp) {
+        std::vector<uint8_t> data;
+        for (int i = 0; i < 2; i++) {
+            int y = aBottomUp ? 1 - i : i;
+            for (int x = 0; x < 3; x++) {
+                put16(data, cPixels[y][x]);
+                data.push_back(static_cast<uint8_t>(cPixels[y][x] >> 16));
+            }
+            data.resize(data.size() + 3); // Padding
+        }
+        return data;
+    };
+
+    auto rows32 = [&](uint32_t (*aEncode)(uint32_t)) {
+        std::vector<uint8_t> data;
+        for (int y = 1; y >= 0; y--) {
+            for (int x = 0; x < 3; x++) {
+                put32(data, aEncode(cPixels[y][x]));
+            }
+        }
+        return data;
+    };
+
+    SUBCASE("24 bit bottom up")
+    {
+        writeBmp(cFileName, 3, 2, 24, {}, rows24(true));
+        check(0x00FFFFFF);
+    }
+
+    SUBCASE("24 bit top down")
+    {
+        writeBmp(cFileName, 3, -2, 24, {}, rows24(false));
+        check(0x00FFFFFF);
+    }
+
+    SUBCASE("32 bit without masks")
+    {
+        // The fourth byte is unused, the pixels decode like 24 bit ones
+        writeBmp(cFileName, 3, 2, 32, {}, rows32([](uint32_t aArgb) { return aArgb; }));
+        check(0x00FFFFFF);
+    }
+
+    SUBCASE("32 bit ARGB masks")
+    {
+        writeBmp(cFileName, 3, 2, 32, { 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 },
+            rows32([](uint32_t aArgb) { return aArgb; }));
+        check(0xFFFFFFFF);
+    }
+
+    SUBCASE("32 bit RGBA masks")
+    {
+        writeBmp(cFileName, 3, 2, 32, { 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF },
+            rows32([](uint32_t aArgb) { return std::rotl(aArgb, 8); }));
+        check(0xFFFFFFFF);
+    }
+
+    SUBCASE("32 bit 10 bit masks")
+    {
+        writeBmp(cFileName, 3, 2, 32, { 0x3FF00000, 0x000FFC00, 0x000003FF, 0 },
+            rows32([](uint32_t aArgb) {
+                uint32_t r = (aArgb >> 16) & 0xFF, g = (aArgb >> 8) & 0xFF, b = aArgb & 0xFF;
+                return (r << 22) | (g << 12) | (b << 2);
+            }));
+        check(0x00FFFFFF);
+    }
+
+    SUBCASE("Truncated file")
+    {
+        std::vector<uint8_t> data = rows24(true);
+        data.resize(data.size() - 1);
+        writeBmp(cFileName, 3, 2, 24, {}, data);
+        CHECK_THROWS_AS(Bitmap bitmap(cFileName), const CoreException &);
+    }
+
+    std::filesystem::remove(cFileName);
+}
+
+/**
+ * Description of a PNG file to encode. Samples gives the samples of a pixel
+ * in file order, at the bit depth of the file.
+ */
+struct PngSpec {
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint8_t mBitDepth;
+    uint8_t mColorType;
+    bool mInterlaced;
+    std::function<std::vector<unsigned>(uint32_t, uint32_t)> mSamples;
+    std::vector<uint8_t> mPalette{};
+    std::vector<uint8_t> mTransparency{};
+};
+
+static void putBe32(std::vector<uint8_t> &arData, uint32_t aValue)
+{
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        arData.push_back(static_cast<uint8_t>(aValue >> shift));
+    }
+}
+
+static void putChunk(std::vector<uint8_t> &arFile, const char *apType, const std::vector<uint8_t> &arData)
+{
+    putBe32(arFile, static_cast<uint32_t>(arData.size()));
+    std::size_t start = arFile.size();
+    arFile.insert(arFile.end(), apType, apType + 4);
+    arFile.insert(arFile.end(), arData.begin(), arData.end());
+    putBe32(arFile, Crc32::Calc(arFile.data() + start, arData.size() + 4));
+}
+
+/**
+ * Encode the filtered rows of all passes, using every filter type in turn.
+ */
+static std::vector<uint8_t> pngScanlines(const PngSpec &arSpec)
+{
+    struct Pass { uint32_t x, y, dx, dy; };
+    const std::vector<Pass> passes = arSpec.mInterlaced
+        ? std::vector<Pass>{ {0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4}, {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2} }
+        : std::vector<Pass>{ {0, 0, 1, 1} };
+    std::size_t channels = arSpec.mSamples(0, 0).size();
+    std::size_t bpp = std::max(std::size_t(1), channels * arSpec.mBitDepth / 8);
+
+    std::vector<uint8_t> result;
+    unsigned filter = 0;
+    for (const Pass &pass : passes) {
+        uint32_t width = (arSpec.mWidth > pass.x) ? (arSpec.mWidth - pass.x + pass.dx - 1) / pass.dx : 0;
+        uint32_t height = (arSpec.mHeight > pass.y) ? (arSpec.mHeight - pass.y + pass.dy - 1) / pass.dy : 0;
+        if ((width == 0) || (height == 0)) {
+            continue;
+        }
+        std::size_t row_bytes = (width * channels * arSpec.mBitDepth + 7) / 8;
+        std::vector<uint8_t> previous(row_bytes, 0);
+        for (uint32_t py = 0; py < height; py++) {
+            std::vector<uint8_t> raw(row_bytes, 0);
+            std::size_t bit = 0;
+            for (uint32_t px = 0; px < width; px++) {
+                for (unsigned sample : arSpec.mSamples(pass.x + px * pass.dx, pass.y + py * pass.dy)) {
+                    if (arSpec.mBitDepth == 16) {
+                        raw[bit / 8] = static_cast<uint8_t>(sample >> 8);
+                        raw[bit / 8 + 1] = static_cast<uint8_t>(sample);
+                    }
+                    else {
+                        raw[bit / 8] = static_cast<uint8_t>(raw[bit / 8] | (sample << (8 - arSpec.mBitDepth - bit % 8)));
+                    }
+                    bit += arSpec.mBitDepth;
+                }
+            }
+
+            result.push_back(static_cast<uint8_t>(filter));
+            for (std::size_t i = 0; i < row_bytes; i++) {
+                int a = (i >= bpp) ? raw[i - bpp] : 0;
+                int b = previous[i];
+                int c = (i >= bpp) ? previous[i - bpp] : 0;
+                int p = a + b - c;
+                int paeth = (std::abs(p - a) <= std::abs(p - b) && std::abs(p - a) <= std::abs(p - c)) ? a
+                    : (std::abs(p - b) <= std::abs(p - c)) ? b : c;
+                const int predictors[5] = { 0, a, b, (a + b) / 2, paeth };
+                result.push_back(static_cast<uint8_t>(raw[i] - predictors[filter]));
+            }
+            filter = (filter + 1) % 5;
+            previous = raw;
+        }
+    }
+    return result;
+}
+
+/**
+ * Build a PNG file from the given scanlines, spread over small IDAT chunks.
+ */
+static std::vector<uint8_t> pngFile(const PngSpec &arSpec, const std::vector<uint8_t> &arScanlines)
+{
+    std::vector<uint8_t> file = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+    std::vector<uint8_t> header;
+    putBe32(header, arSpec.mWidth);
+    putBe32(header, arSpec.mHeight);
+    header.insert(header.end(), { arSpec.mBitDepth, arSpec.mColorType, 0, 0, static_cast<uint8_t>(arSpec.mInterlaced) });
+    putChunk(file, "IHDR", header);
+    putChunk(file, "tEXt", { 'C', 'o', 'm', 'm', 'e', 'n', 't', 0, 'x' });
+    if (!arSpec.mPalette.empty()) {
+        putChunk(file, "PLTE", arSpec.mPalette);
+    }
+    if (!arSpec.mTransparency.empty()) {
+        putChunk(file, "tRNS", arSpec.mTransparency);
+    }
+
+    uLongf size = compressBound(static_cast<uLong>(arScanlines.size()));
+    std::vector<uint8_t> compressed(size);
+    REQUIRE(compress(compressed.data(), &size, arScanlines.data(), static_cast<uLong>(arScanlines.size())) == Z_OK);
+    compressed.resize(size);
+    for (std::size_t i = 0; i < compressed.size(); i += 50) {
+        putChunk(file, "IDAT", std::vector<uint8_t>(compressed.begin() + static_cast<std::ptrdiff_t>(i),
+            compressed.begin() + static_cast<std::ptrdiff_t>(std::min(i + 50, compressed.size()))));
+    }
+    putChunk(file, "IEND", {});
+    return file;
+}
+
+static void writeFile(const std::string &arName, const std::vector<uint8_t> &arData)
+{
+    std::ofstream file(arName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(arData.data()), static_cast<std::streamsize>(arData.size()));
+}
+
+static void checkPng(const PngSpec &arSpec, const std::function<uint32_t(uint32_t, uint32_t)> &arExpected)
+{
+    const char *cFileName = "layout.png";
+    writeFile(cFileName, pngFile(arSpec, pngScanlines(arSpec)));
+
+    ImageCache::Get().Clear();
+    Bitmap bitmap(cFileName);
+    REQUIRE(bitmap.GetWidth() == static_cast<int>(arSpec.mWidth));
+    REQUIRE(bitmap.GetHeight() == static_cast<int>(arSpec.mHeight));
+    std::size_t differences = 0;
+    for (uint32_t y = 0; y < arSpec.mHeight; y++) {
+        for (uint32_t x = 0; x < arSpec.mWidth; x++) {
+            differences += (bitmap.GetPixel(Point(static_cast<int>(x), static_cast<int>(y))) != arExpected(x, y));
+        }
+    }
+    CHECK(differences == 0);
+    std::filesystem::remove(cFileName);
+}
+
+TEST_CASE("Png pixel layouts")
+{
+    // Sizes that are not a multiple of 8 leave some interlace passes short
+    const uint32_t cWidth = 13;
+    const uint32_t cHeight = 11;
+    auto red = [](uint32_t x, uint32_t y) noexcept { return (x * 37 + y * 11) & 0xFF; };
+    auto green = [](uint32_t x, uint32_t y) noexcept { return (x * 5 + y * 71) & 0xFF; };
+    auto blue = [](uint32_t x, uint32_t y) noexcept { return (x * x + y * 3) & 0xFF; };
+    auto alpha = [](uint32_t x, uint32_t y) noexcept { return (x * 13 + y * 29 + 7) & 0xFF; };
+    auto argb = [&](uint32_t x, uint32_t y) noexcept {
+        return (alpha(x, y) << 24) | (red(x, y) << 16) | (green(x, y) << 8) | blue(x, y);
+    };
+    auto rgba_samples = [&](uint32_t x, uint32_t y) {
+        return std::vector<unsigned>{ red(x, y), green(x, y), blue(x, y), alpha(x, y) };
+    };
+
+    SUBCASE("RGBA 8 bit")
+    {
+        checkPng(PngSpec{ cWidth, cHeight, 8, 6, false, rgba_samples }, argb);
+    }
+
+    SUBCASE("RGBA 8 bit interlaced")
+    {
+        checkPng(PngSpec{ cWidth, cHeight, 8, 6, true, rgba_samples }, argb);
+    }
+
+    SUBCASE("RGB 16 bit with color key")
+    {
+        // The low bytes only differ from the key in odd columns
+        auto samples = [&](uint32_t x, uint32_t y) {
+            return std::vector<unsigned>{ red(x, y) * 257, green(x, y) * 257 + (x & 1), blue(x, y) * 257 };
+        };
+        PngSpec spec{ cWidth, cHeight, 16, 2, false, samples };
+        std::vector<unsigned> key = samples(2, 3);
+        for (unsigned sample : key) {
+            spec.mTransparency.push_back(static_cast<uint8_t>(sample >> 8));
+            spec.mTransparency.push_back(static_cast<uint8_t>(sample));
+        }
+        checkPng(spec, [&](uint32_t x, uint32_t y) {
+            uint32_t opaque = (samples(x, y) == key) ? 0 : 0xFF000000;
+            return opaque | (argb(x, y) & 0xFFFFFF);
+        });
+    }
+
+    SUBCASE("Gray 1 bit interlaced")
+    {
+        checkPng(PngSpec{ cWidth, cHeight, 1, 0, true, [](uint32_t x, uint32_t y) { return std::vector<unsigned>{ (x + y) & 1 }; } },
+            [](uint32_t x, uint32_t y) noexcept { return ((x + y) & 1) ? 0xFFFFFFFFu : 0xFF000000u; });
+    }
+
+    SUBCASE("Gray 4 bit with color key")
+    {
+        PngSpec spec{ cWidth, cHeight, 4, 0, false, [](uint32_t x, uint32_t y) { return std::vector<unsigned>{ (x + y) % 16 }; } };
+        spec.mTransparency = { 0, 5 };
+        checkPng(spec, [](uint32_t x, uint32_t y) noexcept {
+            uint32_t gray = (x + y) % 16 * 17;
+            return (((x + y) % 16 == 5) ? 0 : 0xFF000000u) | (gray << 16) | (gray << 8) | gray;
+        });
+    }
+
+    SUBCASE("Gray with alpha 16 bit")
+    {
+        checkPng(PngSpec{ cWidth, cHeight, 16, 4, false,
+                [&](uint32_t x, uint32_t y) { return std::vector<unsigned>{ red(x, y) * 257, alpha(x, y) * 257 }; } },
+            [&](uint32_t x, uint32_t y) noexcept { return (alpha(x, y) << 24) | (red(x, y) * 0x010101u); });
+    }
+
+    SUBCASE("Palette 2 bit with transparency")
+    {
+        PngSpec spec{ cWidth, cHeight, 2, 3, false, [](uint32_t x, uint32_t y) { return std::vector<unsigned>{ (x * 3 + y) % 4 }; } };
+        spec.mPalette = { 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, 0x80, 0x90, 0xA0, 0xB0, 0xC0 };
+        spec.mTransparency = { 0x00, 0x80 };
+        const uint32_t cColors[4] = { 0x00102030, 0x80405060, 0xFF708090, 0xFFA0B0C0 };
+        checkPng(spec, [&](uint32_t x, uint32_t y) noexcept { return cColors[(x * 3 + y) % 4]; });
+    }
+
+    SUBCASE("Corrupt files")
+    {
+        const char *cFileName = "corrupt.png";
+        PngSpec spec{ cWidth, cHeight, 8, 6, false, rgba_samples };
+        std::vector<uint8_t> scanlines = pngScanlines(spec);
+
+        // Changed byte in the last IDAT chunk
+        std::vector<uint8_t> data = pngFile(spec, scanlines);
+        data[data.size() - 20] ^= 0x01;
+        writeFile(cFileName, data);
+        CHECK_THROWS_AS(Bitmap bitmap(cFileName), const CoreException &);
+
+        // Image data ends early
+        scanlines.resize(scanlines.size() / 2);
+        writeFile(cFileName, pngFile(spec, scanlines));
+        CHECK_THROWS_AS(Bitmap bitmap(cFileName), const CoreException &);
+
+        // No IEND chunk
+        data = pngFile(spec, pngScanlines(spec));
+        data.resize(data.size() - 12);
+        writeFile(cFileName, data);
+        CHECK_THROWS_AS(Bitmap bitmap(cFileName), const CoreException &);
+
+        std::filesystem::remove(cFileName);
+    }
+}
+
+TEST_CASE("Raw image files")
+{
+    const char *cFileName = "asset.raw";
+    Bitmap source("testImages/testImage.bmp");
+    const uint32_t *pixels = source.GetPixels().data();
+    int width = source.GetWidth();
+    int height = source.GetHeight();
+
+    auto load = [&]() {
+        // The file is rewritten faster than the resolution of its modification time
+        ImageCache::Get().Clear();
+        return Bitmap(cFileName);
+    };
+
+    SUBCASE("XRGB8888 is used without a copy")
+    {
+        // Act
+        RawLoader::Save(cFileName, pixels, width, height);
+        Bitmap bitmap = load();
+        RawLoader loader;
+
+        // Assert
+        CHECK(loader.MapImg(cFileName) != nullptr);
+        CHECK(bitmap.GetWidth() == width);
+        CHECK(bitmap.GetHeight() == height);
+        CHECK(std::ranges::equal(bitmap.GetPixels(), source.GetPixels()));
+
+        // Drawing copies the pixels, the file is not changed
+        bitmap.SetPixel(Point(0, 0), Color(0xFF123456));
+        CHECK(bitmap.GetPixel(Point(0, 0)) == 0xFF123456);
+        CHECK(load().GetPixel(Point(0, 0)) == source.GetPixel(Point(0, 0)));
+    }
+
+    SUBCASE("RGB888 and RGB565 are converted")
+    {
+        for (auto format : { BufferedCanvas::PixelFormats::RGB888, BufferedCanvas::PixelFormats::RGB565 }) {
+            // Act
+            RawLoader::Save(cFileName, pixels, width, height, format);
+            Bitmap bitmap = load();
+            RawLoader loader;
+
+            // Assert
+            CHECK(loader.MapImg(cFileName) == nullptr);
+            REQUIRE(bitmap.GetWidth() == width);
+            uint32_t mask = (format == BufferedCanvas::PixelFormats::RGB565) ? 0xF8FCF8 : 0xFFFFFF;
+            std::size_t differences = 0;
+            for (std::size_t i = 0; i < bitmap.GetPixels().size(); i++) {
+                uint32_t pixel = bitmap.GetPixels()[i];
+                differences += ((pixel >> 24) != 0xFF) || ((pixel & mask) != (pixels[i] & mask));
+            }
+            CHECK(differences == 0);
+        }
+    }
+
+    SUBCASE("Corrupt files")
+    {
+        RawLoader::Save(cFileName, pixels, width, height);
+        std::vector<uint8_t> data;
+        {
+            std::ifstream file(cFileName, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+
+        // Changed pixel
+        data[RawLoader::cDataOffset + 100] ^= 0x01;
+        writeFile(cFileName, data);
+        CHECK_THROWS_AS(load(), const CoreException &);
+        CHECK_THROWS_AS(RawLoader().MapImg(cFileName), const CoreException &);
+
+        // Missing last row
+        data[RawLoader::cDataOffset + 100] ^= 0x01;
+        data.resize(data.size() - 1);
+        writeFile(cFileName, data);
+        CHECK_THROWS_AS(load(), const CoreException &);
+
+        // Not a raw file
+        writeFile(cFileName, std::vector<uint8_t>(100, 0));
+        CHECK_THROWS_AS(load(), const CoreException &);
+
+        // Formats that are converted are verified once, by LoadImg
+        RawLoader::Save(cFileName, pixels, width, height, BufferedCanvas::PixelFormats::RGB565);
+        {
+            std::ifstream file(cFileName, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        data[RawLoader::cDataOffset + 100] ^= 0x01;
+        writeFile(cFileName, data);
+        CHECK(RawLoader().MapImg(cFileName) == nullptr);
+        std::vector<uint32_t> converted;
+        CHECK_THROWS_AS(RawLoader().LoadImg(cFileName, converted), const CoreException &);
+    }
+
+    SUBCASE("Header is little endian")
+    {
+        RawLoader::Save(cFileName, pixels, width, height);
+        std::vector<uint8_t> data;
+        {
+            std::ifstream file(cFileName, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        // Version at offset 4, width at offset 8
+        uint32_t stored_width = uint32_t(data[8]) | (uint32_t(data[9]) << 8) | (uint32_t(data[10]) << 16) | (uint32_t(data[11]) << 24);
+        CHECK(stored_width == uint32_t(width));
+        CHECK(data[4] == RawLoader::cVersion);
+        CHECK(data[5] == 0);
+    }
+
+    std::filesystem::remove(cFileName);
+}
+
+TEST_CASE("Bitmap transformations")
+{
+    // Arrange, 2x2 pixels
+    const uint32_t cPixels[] = { 0xFF000000, 0xFFFFFFFF,
+                                 0xFF0000FF, 0xFFFF0000 };
+    Bitmap bitmap(cPixels, 2, 2, 4);
+
+    SUBCASE("Nearest scaling repeats pixels")
+    {
+        // Act
+        Bitmap scaled = bitmap.Scale(4, 6, Canvas::ScaleMethods::Nearest);
+
+        // Assert
+        CHECK(scaled.GetWidth() == 4);
+        CHECK(scaled.GetHeight() == 6);
+        CHECK(scaled.GetPixel(Point(1, 2)) == cPixels[0]);
+        CHECK(scaled.GetPixel(Point(2, 2)) == cPixels[1]);
+        CHECK(scaled.GetPixel(Point(0, 3)) == cPixels[2]);
+        CHECK(scaled.GetPixel(Point(3, 5)) == cPixels[3]);
+    }
+
+    SUBCASE("Bilinear scaling interpolates")
+    {
+        // Act
+        Bitmap scaled = bitmap.Scale(4, 4);
+
+        // Assert, corners are clamped, centers are weighted 3:1
+        CHECK(scaled.GetPixel(Point(0, 0)) == cPixels[0]);
+        CHECK(scaled.GetPixel(Point(3, 3)) == cPixels[3]);
+        CHECK(scaled.GetPixel(Point(1, 0)) == 0xFF404040);
+        CHECK(scaled.GetPixel(Point(0, 1)) == 0xFF000040);
+    }
+
+    SUBCASE("Scaling to the same size is exact")
+    {
+        Bitmap image("testImages/testImage.bmp");
+        for (auto method : { Canvas::ScaleMethods::Nearest, Canvas::ScaleMethods::Bilinear }) {
+            Bitmap scaled = image.Scale(image.GetWidth(), image.GetHeight(), method);
+            CHECK(std::ranges::equal(scaled.GetPixels(), image.GetPixels()));
+        }
+        CHECK_THROWS_AS(image.Scale(0, 10), const CoreException &);
+    }
+
+    SUBCASE("Scaled drawing is clipped")
+    {
+        // Arrange
+        Bitmap canvas(10, 10, 4);
+        Bitmap expected = bitmap.Scale(8, 8);
+        canvas.PushClipRect(Rect(4, 4, 6, 6));
+
+        // Act
+        canvas.DrawImage(Rect(2, 2, 8, 8), bitmap);
+
+        // Assert
+        CHECK(canvas.GetPixel(Point(3, 3)) == 0);
+        CHECK(canvas.GetPixel(Point(4, 4)) == expected.GetPixel(Point(2, 2)));
+        CHECK(canvas.GetPixel(Point(9, 6)) == expected.GetPixel(Point(7, 4)));
+    }
+
+    SUBCASE("Rotation")
+    {
+        Bitmap image("testImages/testImage.bmp");
+        int w = image.GetWidth();
+        int h = image.GetHeight();
+
+        // Act
+        Bitmap quarter = image.Rotate(Canvas::Rotations::Clockwise90);
+        Bitmap half = image.Rotate(Canvas::Rotations::Clockwise180);
+        Bitmap three_quarters = image.Rotate(Canvas::Rotations::Clockwise270);
+
+        // Assert
+        CHECK(quarter.GetWidth() == h);
+        CHECK(quarter.GetHeight() == w);
+        CHECK(half.GetWidth() == w);
+        std::size_t differences = 0;
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                uint32_t pixel = image.GetPixel(Point(x, y));
+                differences += (quarter.GetPixel(Point(h - 1 - y, x)) != pixel);
+                differences += (half.GetPixel(Point(w - 1 - x, h - 1 - y)) != pixel);
+                differences += (three_quarters.GetPixel(Point(y, w - 1 - x)) != pixel);
+            }
+        }
+        CHECK(differences == 0);
+        CHECK(std::ranges::equal(quarter.Rotate(Canvas::Rotations::Clockwise270).GetPixels(), image.GetPixels()));
+    }
+}
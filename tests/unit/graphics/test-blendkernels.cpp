@@ -0,0 +1,150 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+#include <graphics/kernels/BlendKernels.h>
+
+using namespace rsp::graphics;
+
+/**
+ * Straightforward per channel reference, using exact rounded division.
+ */
+static uint32_t referenceBlend(uint32_t aDst, uint32_t aSrc, Canvas::BlendModes aMode)
+{
+    uint32_t a = aSrc >> 24;
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        uint32_t s = (aSrc >> shift) & 0xFF;
+        if ((shift == 24) && (aMode == Canvas::BlendModes::SourceOver || aMode == Canvas::BlendModes::Additive)) {
+            s = 255;
+        }
+        uint32_t d = (aDst >> shift) & 0xFF;
+        uint32_t c = s;
+        switch (aMode) {
+            case Canvas::BlendModes::SourceOver:
+                c = (s * a + d * (255 - a) + 127) / 255;
+                break;
+            case Canvas::BlendModes::PremultipliedSourceOver:
+                c = std::min(255u, s + (d * (255 - a) + 127) / 255);
+                break;
+            case Canvas::BlendModes::Additive:
+                c = std::min(255u, d + (s * a + 127) / 255);
+                break;
+            default:
+                break;
+        }
+        result |= c << shift;
+    }
+    return result;
+}
+
+TEST_CASE("Blend Kernels")
+{
+    const Canvas::BlendModes modes[] = {
+        Canvas::BlendModes::Copy,
+        Canvas::BlendModes::SourceOver,
+        Canvas::BlendModes::PremultipliedSourceOver,
+        Canvas::BlendModes::Additive
+    };
+    std::mt19937 rng(42);
+
+    std::vector<uint32_t> src(263);
+    std::vector<uint32_t> dst(src.size());
+    for (std::size_t i = 0 ; i < src.size() ; i++) {
+        src[i] = rng();
+        dst[i] = rng();
+    }
+    // Include the extremes of alpha
+    src[0] &= 0x00FFFFFF;
+    src[1] |= 0xFF000000;
+
+    SUBCASE("Blend rows")
+    {
+        for (Canvas::BlendModes mode : modes) {
+            for (std::size_t offset = 0 ; offset < 9 ; offset++) {
+                // Arrange
+                std::vector<uint32_t> result(dst);
+                std::size_t count = src.size() - offset;
+
+                // Act
+                BlendKernels::BlendRow(result.data() + offset, src.data(), count, mode);
+
+                // Assert
+                for (std::size_t i = 0 ; i < count ; i++) {
+                    CHECK(result[i + offset] == referenceBlend(dst[i + offset], src[i], mode));
+                }
+                for (std::size_t i = 0 ; i < offset ; i++) {
+                    CHECK(result[i] == dst[i]);
+                }
+            }
+        }
+    }
+
+    SUBCASE("Blend fill")
+    {
+        for (Canvas::BlendModes mode : modes) {
+            // Arrange
+            std::vector<uint32_t> result(dst);
+            uint32_t color = 0x80C04020;
+
+            // Act
+            BlendKernels::BlendFill(result.data() + 3, color, 250, mode);
+
+            // Assert
+            for (std::size_t i = 3 ; i < 253 ; i++) {
+                CHECK(result[i] == referenceBlend(dst[i], color, mode));
+            }
+            CHECK(result[2] == dst[2]);
+            CHECK(result[253] == dst[253]);
+        }
+    }
+
+    SUBCASE("Blend mask")
+    {
+        // Arrange
+        std::vector<uint8_t> coverage(src.size());
+        for (std::size_t i = 0 ; i < coverage.size() ; i++) {
+            coverage[i] = static_cast<uint8_t>(i);
+        }
+
+        // Copy mode ignores the alpha of the color
+        const std::pair<uint32_t, Canvas::BlendModes> cases[] = {
+            { 0xFF204080, Canvas::BlendModes::SourceOver },
+            { 0x00204080, Canvas::BlendModes::Copy }
+        };
+        for (auto [color, mode] : cases) {
+            std::vector<uint32_t> result(dst);
+
+            // Act
+            BlendKernels::BlendMask(result.data(), coverage.data(), color, coverage.size(), mode);
+
+            // Assert
+            CHECK(result[0] == dst[0]);
+            CHECK(result[255] == (color | 0xFF000000));
+            for (std::size_t i = 0 ; i < coverage.size() ; i++) {
+                uint32_t src_pixel = (color & 0x00FFFFFF) | (((coverage[i] * 255u + 127) / 255) << 24);
+                CHECK(result[i] == referenceBlend(dst[i], src_pixel, Canvas::BlendModes::SourceOver));
+            }
+        }
+    }
+
+    SUBCASE("Blend pixel")
+    {
+        CHECK(BlendKernels::BlendPixel(0xFF000000, 0x80FFFFFF, Canvas::BlendModes::SourceOver) == 0xFF808080);
+        CHECK(BlendKernels::BlendPixel(0xFF000000, 0x00FFFFFF, Canvas::BlendModes::SourceOver) == 0xFF000000);
+        CHECK(BlendKernels::BlendPixel(0xFF101010, 0x80808080, Canvas::BlendModes::PremultipliedSourceOver) == 0xFF888888);
+        CHECK(BlendKernels::BlendPixel(0xFFF0F0F0, 0xFF202020, Canvas::BlendModes::Additive) == 0xFFFFFFFF);
+        CHECK(BlendKernels::BlendPixel(0x12345678, 0x00FFFFFF, Canvas::BlendModes::Copy) == 0x00FFFFFF);
+    }
+}
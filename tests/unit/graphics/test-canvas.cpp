@@ -0,0 +1,343 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <algorithm>
+#include <vector>
+#include <graphics/primitives/Bitmap.h>
+
+using namespace rsp::graphics;
+
+/**
+ * Reference implementation of the midpoint circle, plotting single pixels.
+ */
+static void referenceCircle(Bitmap &arBitmap, const Point &arCenter, int aRadius, const Color &arColor)
+{
+    int error = -aRadius;
+    int y = 0;
+    int cx = arCenter.GetX();
+    int cy = arCenter.GetY();
+
+    while (aRadius >= y) {
+        const int xs[] = { aRadius, -aRadius, aRadius, -aRadius, y, -y, y, -y };
+        const int ys[] = { y, y, -y, -y, aRadius, aRadius, -aRadius, -aRadius };
+        for (int i = 0 ; i < 8 ; i++) {
+            arBitmap.SetPixel(Point(cx + xs[i], cy + ys[i]), arColor);
+        }
+        error += y;
+        y++;
+        error += y;
+        if (error >= 0) {
+            error += -aRadius;
+            aRadius--;
+            error += -aRadius;
+        }
+    }
+}
+
+/**
+ * Reference implementation of the Bresenham line, plotting single pixels.
+ */
+static void referenceLine(Bitmap &arBitmap, const Point &arA, const Point &arB, const Color &arColor)
+{
+    int deltaX = arB.GetX() - arA.GetX();
+    int deltaY = arB.GetY() - arA.GetY();
+    int absDeltaX = abs(deltaX);
+    int absDeltaY = abs(deltaY);
+    int signumX = (deltaX > 0) ? 1 : -1;
+    int signumY = (deltaY > 0) ? 1 : -1;
+    int x = absDeltaX >> 1;
+    int y = absDeltaY >> 1;
+    int px = arA.GetX();
+    int py = arA.GetY();
+
+    arBitmap.SetPixel(arA, arColor);
+    if (absDeltaX >= absDeltaY) {
+        for (int i = 0; i < absDeltaX; i++) {
+            y += absDeltaY;
+            if (y >= absDeltaX) {
+                y -= absDeltaX;
+                py += signumY;
+            }
+            px += signumX;
+            arBitmap.SetPixel(Point(px, py), arColor);
+        }
+    }
+    else {
+        for (int i = 0; i < absDeltaY; i++) {
+            x += absDeltaX;
+            if (x >= absDeltaY) {
+                x -= absDeltaY;
+                px += signumX;
+            }
+            py += signumY;
+            arBitmap.SetPixel(Point(px, py), arColor);
+        }
+    }
+}
+
+static int countColor(const Bitmap &arBitmap, const Color &arColor)
+{
+    return static_cast<int>(std::count(arBitmap.GetPixels().begin(), arBitmap.GetPixels().end(), static_cast<uint32_t>(arColor)));
+}
+
+TEST_CASE("Canvas Drawing Primitives")
+{
+    Bitmap bitmap(100, 120, 4);
+    const Color col(Color::Red);
+
+    SUBCASE("Circles match single pixel plotting")
+    {
+        Bitmap reference(100, 120, 4);
+        const Point centers[] = { Point(60, 50), Point(5, 5), Point(115, 95), Point(60, -20) };
+        const int radii[] = { 0, 1, 7, 30, 49, 80 };
+
+        for (const Point &center : centers) {
+            for (int radius : radii) {
+                bitmap.DrawCircle(center, radius, col);
+                referenceCircle(reference, center, radius, col);
+            }
+        }
+
+        CHECK(std::ranges::equal(bitmap.GetPixels(), reference.GetPixels()));
+    }
+
+    SUBCASE("Horizontal and vertical lines")
+    {
+        bitmap.DrawLine(Point(80, 10), Point(20, 10), col);
+        bitmap.DrawLine(Point(5, 90), Point(5, 30), col);
+        bitmap.DrawLine(Point(-10, 20), Point(200, 20), col);
+
+        CHECK(bitmap.GetPixel(Point(20, 10)) == col);
+        CHECK(bitmap.GetPixel(Point(80, 10)) == col);
+        CHECK(bitmap.GetPixel(Point(81, 10)) == 0);
+        CHECK(bitmap.GetPixel(Point(5, 30)) == col);
+        CHECK(bitmap.GetPixel(Point(5, 90)) == col);
+        CHECK(bitmap.GetPixel(Point(5, 91)) == 0);
+        CHECK(countColor(bitmap, col) == 61 + 61 + 120);
+    }
+
+    SUBCASE("Filled rectangle is clipped")
+    {
+        bitmap.DrawRectangle(Rect(Point(-10, 90), Point(9, 120)), col, true);
+
+        CHECK(countColor(bitmap, col) == 10 * 10);
+        CHECK(bitmap.GetPixel(Point(9, 99)) == col);
+        CHECK(bitmap.GetPixel(Point(10, 99)) == 0);
+    }
+
+    SUBCASE("Rectangle outline")
+    {
+        bitmap.DrawRectangle(Rect(10, 10, 20, 30), col);
+
+        CHECK(countColor(bitmap, col) == (2 * 21) + (2 * 29));
+        CHECK(bitmap.GetPixel(Point(30, 40)) == col);
+        CHECK(bitmap.GetPixel(Point(20, 20)) == 0);
+    }
+
+    SUBCASE("Lines match single pixel plotting")
+    {
+        Bitmap reference(100, 120, 4);
+        srand(42);
+        for (int i = 0 ; i < 500 ; i++) {
+            Point a(rand() % 300 - 90, rand() % 300 - 100);
+            Point b(rand() % 300 - 90, rand() % 300 - 100);
+            bitmap.DrawLine(a, b, Color(static_cast<uint32_t>(i + 1)));
+            referenceLine(reference, a, b, Color(static_cast<uint32_t>(i + 1)));
+        }
+
+        CHECK(std::ranges::equal(bitmap.GetPixels(), reference.GetPixels()));
+    }
+}
+
+TEST_CASE("Canvas Clipping")
+{
+    Bitmap bitmap(100, 120, 4);
+    const Color col(Color::Red);
+    const Rect clip(20, 30, 40, 25);
+
+    SUBCASE("Nested clip rects")
+    {
+        bitmap.PushClipRect(clip);
+        bitmap.PushClipRect(Rect(0, 0, 30, 40));
+        Rect r = bitmap.GetClipRect();
+        CHECK(r.GetLeft() == 20);
+        CHECK(r.GetTop() == 30);
+        CHECK(r.GetRight() == 30);
+        CHECK(r.GetBottom() == 40);
+
+        bitmap.PopClipRect();
+        bitmap.PopClipRect();
+        CHECK(bitmap.GetClipRect().GetWidth() == 120);
+        CHECK_THROWS_AS(bitmap.PopClipRect(), const rsp::utils::CoreException &);
+    }
+
+    SUBCASE("Primitives stay inside clip rect")
+    {
+        Bitmap reference(100, 120, 4);
+        bitmap.PushClipRect(clip);
+        srand(7);
+        for (int i = 0 ; i < 200 ; i++) {
+            Point a(rand() % 140 - 10, rand() % 120 - 10);
+            Point b(rand() % 140 - 10, rand() % 120 - 10);
+            bitmap.DrawLine(a, b, col);
+            referenceLine(reference, a, b, col);
+        }
+        bitmap.DrawCircle(Point(40, 40), 15, col);
+        referenceCircle(reference, Point(40, 40), 15, col);
+
+        // Clipping must not move the pixels that are inside the clip rect
+        for (int y = 0 ; y < 100 ; y++) {
+            for (int x = 0 ; x < 120 ; x++) {
+                Point p(x, y);
+                if (clip.IsHit(p)) {
+                    if (bitmap.GetPixel(p) != reference.GetPixel(p)) {
+                        FAIL_CHECK("Clipped primitive differs from reference at " << p);
+                    }
+                }
+                else if (bitmap.GetPixel(p) != 0) {
+                    FAIL_CHECK("Pixel drawn outside clip rect at " << p);
+                }
+            }
+        }
+
+        bitmap.DrawRectangle(Rect(0, 0, 119, 99), col, true);
+        bitmap.PopClipRect();
+
+        for (int y = 0 ; y < 100 ; y++) {
+            for (int x = 0 ; x < 120 ; x++) {
+                Point p(x, y);
+                if (clip.IsHit(p)) {
+                    CHECK(bitmap.GetPixel(p) == col);
+                }
+                else if (bitmap.GetPixel(p) != 0) {
+                    FAIL_CHECK("Pixel drawn outside clip rect at " << p);
+                }
+            }
+        }
+    }
+
+    SUBCASE("Images are clipped")
+    {
+        Bitmap image(50, 50, 4);
+        image.DrawRectangle(Rect(0, 0, 49, 49), col, true);
+
+        bitmap.PushClipRect(clip);
+        bitmap.DrawImage(Point(0, 0), image);
+        bitmap.PopClipRect();
+
+        CHECK(countColor(bitmap, col) == 30 * 20);
+        CHECK(bitmap.GetPixel(Point(49, 49)) == col);
+        CHECK(bitmap.GetPixel(Point(50, 49)) == 0);
+    }
+
+    SUBCASE("Sub rectangle of image")
+    {
+        // Sprite sheet with four 10x10 tiles in different colors
+        Bitmap sheet(10, 40, 4);
+        const Color tiles[] = { Color::Red, Color::Green, Color::Blue, Color::Yellow };
+        for (int i = 0 ; i < 4 ; i++) {
+            sheet.DrawRectangle(Rect(i * 10, 0, 9, 9), tiles[i], true);
+        }
+
+        bitmap.DrawImage(Point(5, 5), sheet, Rect(20, 0, 10, 10));
+        bitmap.DrawImage(Point(-5, 50), sheet, Rect(10, 0, 10, 10));
+        bitmap.DrawImage(Point(70, 70), sheet, Rect(35, -5, 10, 10));
+
+        CHECK(countColor(bitmap, Color::Blue) == 100);
+        CHECK(bitmap.GetPixel(Point(5, 5)) == Color::Blue);
+        CHECK(bitmap.GetPixel(Point(14, 14)) == Color::Blue);
+        CHECK(countColor(bitmap, Color::Green) == 50);
+        CHECK(bitmap.GetPixel(Point(4, 59)) == Color::Green);
+        CHECK(countColor(bitmap, Color::Yellow) == 25);
+        CHECK(bitmap.GetPixel(Point(70, 75)) == Color::Yellow);
+        CHECK(bitmap.GetPixel(Point(70, 74)) == 0);
+    }
+}
+
+TEST_CASE("Canvas Blending")
+{
+    Bitmap bitmap(100, 100, 4);
+    bitmap.DrawRectangle(Rect(0, 0, 99, 99), Color(0xFF000000), true);
+
+    SUBCASE("Copy is default and ignores alpha")
+    {
+        CHECK(bitmap.GetBlendMode() == Canvas::BlendModes::Copy);
+        bitmap.DrawRectangle(Rect(10, 10, 9, 9), Color(0x40FF0000), true);
+        CHECK(bitmap.GetPixel(Point(10, 10)) == 0x40FF0000);
+    }
+
+    SUBCASE("Translucent rectangle")
+    {
+        bitmap.SetBlendMode(Canvas::BlendModes::SourceOver);
+        bitmap.DrawRectangle(Rect(10, 10, 9, 9), Color(0x80FFFFFF), true);
+        bitmap.DrawRectangle(Rect(15, 15, 9, 9), Color(0x80FFFFFF), true);
+
+        CHECK(bitmap.GetPixel(Point(10, 10)) == 0xFF808080);
+        CHECK(bitmap.GetPixel(Point(19, 19)) == 0xFFC0C0C0);
+        CHECK(bitmap.GetPixel(Point(9, 9)) == 0xFF000000);
+    }
+
+    SUBCASE("Blended image")
+    {
+        Bitmap image(20, 20, 4);
+        image.DrawRectangle(Rect(0, 0, 19, 19), Color(0x00FFFFFF), true);
+        image.DrawRectangle(Rect(0, 0, 9, 19), Color(0xFF0000FF), true);
+
+        bitmap.SetBlendMode(Canvas::BlendModes::SourceOver);
+        bitmap.DrawImage(Point(50, 50), image);
+
+        CHECK(bitmap.GetPixel(Point(50, 50)) == 0xFF0000FF);
+        CHECK(bitmap.GetPixel(Point(69, 69)) == 0xFF000000);
+    }
+
+    SUBCASE("Translucent outline")
+    {
+        bitmap.SetBlendMode(Canvas::BlendModes::SourceOver);
+        bitmap.DrawRectangle(Rect(10, 10, 9, 9), Color(0x80FFFFFF), false);
+        bitmap.DrawRectangle(Rect(30, 10, 9, 0), Color(0x80FFFFFF), false);
+        bitmap.DrawRectangle(Rect(50, 10, 0, 9), Color(0x80FFFFFF), false);
+
+        CHECK(bitmap.GetPixel(Point(10, 10)) == 0xFF808080);
+        CHECK(bitmap.GetPixel(Point(19, 19)) == bitmap.GetPixel(Point(15, 19)));
+        CHECK(bitmap.GetPixel(Point(10, 19)) == bitmap.GetPixel(Point(10, 15)));
+        CHECK(bitmap.GetPixel(Point(11, 11)) == 0xFF000000);
+        CHECK(bitmap.GetPixel(Point(30, 10)) == 0xFF808080);
+        CHECK(bitmap.GetPixel(Point(39, 10)) == 0xFF808080);
+        CHECK(bitmap.GetPixel(Point(50, 10)) == 0xFF808080);
+        CHECK(bitmap.GetPixel(Point(50, 19)) == 0xFF808080);
+    }
+
+    SUBCASE("Translucent circle")
+    {
+        bitmap.SetBlendMode(Canvas::BlendModes::SourceOver);
+        for (int radius : { 0, 1, 2, 7, 20, 35 }) {
+            bitmap.DrawRectangle(Rect(0, 0, 99, 99), Color(0xFF000000), true);
+            bitmap.DrawCircle(Point(50, 50), radius, Color(0x80FFFFFF));
+
+            // Only the background and pixels blended once
+            std::vector<uint32_t> values(bitmap.GetPixels().begin(), bitmap.GetPixels().end());
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            CHECK(values.size() == 2);
+            CHECK(bitmap.GetPixel(Point(50 + radius, 50)) == 0xFF808080);
+        }
+    }
+
+    SUBCASE("Additive lines")
+    {
+        bitmap.SetBlendMode(Canvas::BlendModes::Additive);
+        bitmap.DrawLine(Point(0, 5), Point(99, 5), Color(0xFF400000));
+        bitmap.DrawLine(Point(5, 0), Point(5, 99), Color(0xFF400000));
+
+        CHECK(bitmap.GetPixel(Point(0, 5)) == 0xFF400000);
+        CHECK(bitmap.GetPixel(Point(5, 5)) == 0xFF800000);
+    }
+}
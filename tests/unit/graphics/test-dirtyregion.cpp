@@ -0,0 +1,66 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <graphics/DirtyRegion.h>
+
+using namespace rsp::graphics;
+
+TEST_CASE("Dirty Region")
+{
+    DirtyRegion region(0, 4);
+
+    SUBCASE("Empty rects are ignored")
+    {
+        region.Add(Rect(10, 10, 0, 5));
+        CHECK(region.IsEmpty());
+    }
+
+    SUBCASE("Separate rects are kept")
+    {
+        region.Add(Rect(0, 0, 10, 10));
+        region.Add(Rect(100, 100, 10, 10));
+
+        CHECK(region.GetRects().size() == 2);
+        CHECK(region.GetArea() == 200);
+    }
+
+    SUBCASE("Adjacent rects are merged")
+    {
+        region.Add(Rect(0, 0, 10, 10));
+        region.Add(Rect(10, 0, 10, 10));
+
+        REQUIRE(region.GetRects().size() == 1);
+        CHECK(region.GetRects()[0].GetWidth() == 20);
+        CHECK(region.GetArea() == 200);
+    }
+
+    SUBCASE("Merge threshold")
+    {
+        region.SetMergeThreshold(100);
+        region.Add(Rect(0, 0, 10, 10));
+        region.Add(Rect(0, 15, 10, 10));
+
+        REQUIRE(region.GetRects().size() == 1);
+        CHECK(region.GetArea() == 250);
+    }
+
+    SUBCASE("Collapse into bounding rect")
+    {
+        for (int i = 0 ; i < 5 ; i++) {
+            region.Add(Rect(i * 100, i * 100, 10, 10));
+        }
+
+        REQUIRE(region.GetRects().size() == 1);
+        Rect r = region.GetBoundingRect();
+        CHECK(r.GetLeft() == 0);
+        CHECK(r.GetBottom() == 410);
+    }
+}
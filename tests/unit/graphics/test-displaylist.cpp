@@ -0,0 +1,157 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <cstdlib>
+#include <graphics/DisplayList.h>
+#include <graphics/MemoryCanvas.h>
+#include <graphics/primitives/Bitmap.h>
+#include <graphics/primitives/Font.h>
+#include <graphics/primitives/Text.h>
+#include "CanvasCompare.h"
+
+using namespace rsp::graphics;
+
+TEST_CASE("Display List")
+{
+    const char* cFontFile = "fonts/Exo2-VariableFont_wght.ttf";
+    const char* cFontName = "Exo 2";
+
+    MemoryCanvas direct(200, 150);
+    MemoryCanvas replayed(200, 150);
+    direct.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color(0));
+    replayed.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color(0));
+    DisplayList list;
+
+    Bitmap image1("testImages/testImage.bmp");
+    Bitmap image2("testImages/Asset2NoAlpha.bmp");
+
+    SUBCASE("Replay gives the same result as drawing directly")
+    {
+        Font::RegisterFont(cFontFile);
+        Text text(cFontName, "Replay");
+        text.GetFont().SetSize(30);
+        text.SetArea(Rect(20, 40, 150, 60)).Reload();
+
+        srand(7);
+        for (int i = 0 ; i < 60 ; i++) {
+            Point a(rand() % 260 - 30, rand() % 200 - 25);
+            Point b(rand() % 260 - 30, rand() % 200 - 25);
+            Color color(static_cast<uint32_t>(rand()) | ((i % 4) ? 0xFF000000u : 0x80000000u));
+            Canvas::BlendModes mode = (i % 3) ? Canvas::BlendModes::Copy : Canvas::BlendModes::SourceOver;
+            const Bitmap &image = (i % 2) ? image1 : image2;
+
+            direct.SetBlendMode(mode);
+            list.SetBlendMode(mode);
+            switch (i % 6) {
+                case 0:
+                    direct.DrawLine(a, b, color);
+                    list.DrawLine(a, b, color);
+                    break;
+                case 1:
+                    direct.DrawCircle(a, i, color);
+                    list.DrawCircle(a, i, color);
+                    break;
+                case 2:
+                    direct.DrawRectangle(Rect(a, 40, 25), color, false);
+                    list.DrawRectangle(Rect(a, 40, 25), color, false);
+                    break;
+                case 3:
+                    direct.DrawRectangle(Rect(a, 50, 30), color, true);
+                    list.DrawRectangle(Rect(a, 50, 30), color, true);
+                    break;
+                case 4:
+                    direct.DrawImage(a, image, Rect(-10, 20, 100, 60));
+                    list.DrawImage(a, image, Rect(-10, 20, 100, 60));
+                    break;
+                default:
+                    direct.DrawText(text, color);
+                    list.DrawText(text, color);
+                    break;
+            }
+        }
+        direct.SetBlendMode(Canvas::BlendModes::Copy);
+
+        list.Replay(replayed);
+        CHECK(replayed.GetBlendMode() == Canvas::BlendModes::Copy);
+        CHECK(countDifferences(direct, replayed) == 0);
+
+        std::size_t count = list.GetCommandCount();
+        list.Optimize();
+        CHECK(list.GetCommandCount() < count);
+
+        replayed.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color(0));
+        list.Replay(replayed);
+        CHECK(countDifferences(direct, replayed) == 0);
+    }
+
+    SUBCASE("Covered operations are dropped")
+    {
+        list.DrawLine(Point(10, 10), Point(20, 20), Color::White);
+        list.DrawImage(Point(0, 0), image1, Rect(0, 0, 30, 30));
+        list.SetBlendMode(Canvas::BlendModes::SourceOver);
+        list.DrawRectangle(Rect(5, 5, 10, 10), Color(0x80FF0000), true);
+        list.DrawRectangle(Rect(0, 0, 30, 30), Color(0xFF00FF00), true);
+        list.DrawCircle(Point(15, 15), 5, Color::White);
+
+        list.Optimize();
+        REQUIRE(list.GetCommandCount() == 2);
+        CHECK(list.GetCommands()[0].mOperation == DisplayList::Operations::FilledRectangle);
+        CHECK(list.GetCommands()[1].mOperation == DisplayList::Operations::Circle);
+    }
+
+    SUBCASE("Adjacent fills are merged")
+    {
+        for (int x = 0 ; x < 100 ; x += 10) {
+            list.DrawRectangle(Rect(x, 20, 9, 4), Color::White, true);
+        }
+        list.DrawRectangle(Rect(0, 25, 99, 4), Color::White, true);
+        list.DrawRectangle(Rect(0, 30, 99, 4), Color::Red, true);
+
+        list.Optimize();
+        REQUIRE(list.GetCommandCount() == 2);
+        const DisplayList::Command &cmd = list.GetCommands()[0];
+        CHECK(cmd.mLeft == 0);
+        CHECK(cmd.mTop == 20);
+        CHECK(cmd.mRight == 100);
+        CHECK(cmd.mBottom == 30);
+    }
+
+    SUBCASE("Images are grouped by bitmap")
+    {
+        list.DrawImage(Point(0, 0), image1, Rect(0, 0, 10, 10));
+        list.DrawImage(Point(20, 0), image2, Rect(0, 0, 10, 10));
+        list.DrawImage(Point(40, 0), image1, Rect(0, 0, 10, 10));
+        list.DrawImage(Point(15, 5), image2, Rect(0, 0, 10, 10));
+        list.DrawImage(Point(60, 0), image1, Rect(0, 0, 10, 10));
+
+        list.Optimize();
+        REQUIRE(list.GetCommandCount() == 5);
+        auto &cmds = list.GetCommands();
+        CHECK(cmds[0].mLeft == 0);
+        CHECK(cmds[1].mLeft == 40);
+        CHECK(cmds[2].mLeft == 60);
+        CHECK(cmds[3].mLeft == 20);
+        // Overlaps the image at 20,0, so it can not move ahead of it
+        CHECK(cmds[4].mLeft == 15);
+    }
+
+    SUBCASE("Damage")
+    {
+        list.DrawRectangle(Rect(10, 10, 9, 9), Color::White, true);
+        list.DrawLine(Point(100, 100), Point(90, 120), Color::White);
+
+        DirtyRegion region(0);
+        list.AddDamage(region);
+        REQUIRE(region.GetRects().size() == 2);
+        CHECK(region.GetArea() == 100 + 11 * 21);
+        CHECK(region.GetBoundingRect().GetRight() == 101);
+    }
+}
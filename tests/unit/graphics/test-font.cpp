@@ -9,10 +9,13 @@
  */
 
 #include <doctest.h>
+#include <algorithm>
+#include <graphics/primitives/Bitmap.h>
 #include <graphics/primitives/Font.h>
 #include <graphics/primitives/Rect.h>
 #include <graphics/primitives/Text.h>
 #include <graphics/primitives/freetype/FreeTypeLibrary.h>
+#include <graphics/primitives/freetype/GlyphCache.h>
 
 using namespace rsp::graphics;
 
@@ -75,5 +78,167 @@ TEST_CASE("Font Primitive")
         CHECK(r.GetHeight() < dst.GetHeight());
         CHECK(r.GetWidth() < dst.GetWidth());
     }
-}
 
+    SUBCASE("Glyphs are cached") {
+        CHECK_NOTHROW(Font::RegisterFont(cFontFile));
+        Font font1(cFontName);
+        Font font2(cFontName);
+        font1.SetSize(21);
+        font2.SetSize(21);
+        GlyphCache::Get().Clear();
+        GlyphCache::Get().ResetStatistics();
+
+        auto first = font1.MakeGlyphs("0123456789");
+        CHECK(GlyphCache::Get().GetMisses() == 10);
+        CHECK(GlyphCache::Get().GetHits() == 0);
+
+        auto second = font2.MakeGlyphs("0123456789");
+        CHECK(GlyphCache::Get().GetMisses() == 10);
+        CHECK(GlyphCache::Get().GetHits() == 10);
+
+        REQUIRE(first.size() == second.size());
+        for (std::size_t i = 0 ; i < first.size() ; i++) {
+            CHECK(first[i].mpAtlas == second[i].mpAtlas);
+            CHECK(first[i].mAtlasLeft == second[i].mAtlasLeft);
+            CHECK(first[i].mAtlasTop == second[i].mAtlasTop);
+            CHECK(first[i].mLeft == second[i].mLeft);
+            CHECK(first[i].mWidth == second[i].mWidth);
+        }
+
+        font2.SetStyle(Font::Styles::Bold);
+        font2.MakeGlyphs("0");
+        CHECK(GlyphCache::Get().GetMisses() == 11);
+    }
+
+    SUBCASE("Text is drawn anti aliased") {
+        CHECK_NOTHROW(Font::RegisterFont(cFontFile));
+        Text text(cFontName, "O");
+        text.GetFont().SetSize(30);
+        text.SetArea(Rect(0, 0, 40, 40)).Reload();
+        Bitmap bitmap(40, 40, 4);
+
+        bitmap.DrawText(text, Color(0x00FFFFFF));
+
+        int solid = 0;
+        int partial = 0;
+        int grey = 0;
+        for (uint32_t pixel : bitmap.GetPixels()) {
+            uint32_t c = pixel & 0xFF;
+            solid += (c == 0xFF);
+            partial += (c > 0) && (c < 0xFF);
+            grey += ((pixel & 0xFF) == ((pixel >> 8) & 0xFF));
+        }
+        CHECK(grey == 40 * 40);
+        CHECK(solid > 0);
+        CHECK(partial > 0);
+    }
+
+    SUBCASE("Measured glyphs match rendered glyphs") {
+        CHECK_NOTHROW(Font::RegisterFont(cFontFile));
+        Font font(cFontName);
+        font.SetSize(23);
+
+        auto measured = font.MeasureGlyphs("Hello World\n0123456789", 2);
+        auto rendered = font.MakeGlyphs("Hello World\n0123456789", 2);
+
+        REQUIRE(measured.size() == rendered.size());
+        for (std::size_t i = 0 ; i < measured.size() ; i++) {
+            CHECK(measured[i].mpAtlas == nullptr);
+            CHECK(measured[i].mTop == rendered[i].mTop);
+            CHECK(measured[i].mLeft == rendered[i].mLeft);
+            CHECK(measured[i].mWidth == rendered[i].mWidth);
+            CHECK(measured[i].mHeight == rendered[i].mHeight);
+        }
+    }
+
+    SUBCASE("Scale to fit renders once") {
+        CHECK_NOTHROW(Font::RegisterFont(cFontFile));
+        Text text(cFontName, "Hello World");
+        GlyphCache::Get().Clear();
+        GlyphCache::Get().ResetStatistics();
+
+        text.SetScaleToFit(true).SetArea(Rect(0, 0, 300, 80)).Reload();
+
+        CHECK(GlyphCache::Get().GetHits() + GlyphCache::Get().GetMisses() == text.GetValue().size());
+        Rect r = text.CalcBoundingRect(text.GetGlyphs());
+        CHECK(r.GetWidth() < 300);
+        CHECK(r.GetWidth() > 270);
+        CHECK(r.GetHeight() < 80);
+        CHECK(r.GetHeight() > 72);
+    }
+
+    SUBCASE("Cached text is drawn from one surface") {
+        CHECK_NOTHROW(Font::RegisterFont(cFontFile));
+        Text text(cFontName, "Hello World\nAVATAR Wave");
+        text.GetFont().SetSize(24);
+        text.SetArea(Rect(10, 10, 150, 70)).Reload();
+        Bitmap expected(160, 80, 4);
+        Bitmap cached(160, 80, 4);
+        expected.DrawText(text, Color(0x00FFFFFF));
+
+        CHECK(text.GetSurface() == nullptr);
+        text.SetCached().Reload();
+        REQUIRE(text.GetSurface() != nullptr);
+        CHECK(text.GetSurface()->mArea.GetWidth() <= 150);
+        CHECK(text.GetSurface()->mArea.GetHeight() <= 70);
+        cached.DrawText(text, Color(0x00FFFFFF));
+        CHECK(std::ranges::equal(cached.GetPixels(), expected.GetPixels()));
+
+        // Clipped by the canvas
+        Bitmap small(80, 40, 4);
+        Bitmap small_expected(80, 40, 4);
+        small.DrawText(text, Color(0x00FFFFFF));
+        text.SetCached(false);
+        small_expected.DrawText(text, Color(0x00FFFFFF));
+        CHECK(std::ranges::equal(small.GetPixels(), small_expected.GetPixels()));
+        text.SetCached(true);
+
+        // Overlapping glyphs blend differently when merged, those modes draw glyph by glyph
+        for (auto mode : { Canvas::BlendModes::Additive, Canvas::BlendModes::SourceOver }) {
+            Bitmap blended(160, 80, 4);
+            Bitmap blended_expected(160, 80, 4);
+            blended.SetBlendMode(mode);
+            blended_expected.SetBlendMode(mode);
+            blended.DrawText(text, Color(0x80FFFFFF));
+            text.SetCached(false);
+            blended_expected.DrawText(text, Color(0x80FFFFFF));
+            text.SetCached(true);
+            CHECK(std::ranges::equal(blended.GetPixels(), blended_expected.GetPixels()));
+        }
+
+        text.SetValue("Hello");
+        CHECK(text.GetSurface() == nullptr);
+        text.Reload();
+        CHECK(text.GetSurface() != nullptr);
+        text.SetHAlignment(Text::HAlign::Left);
+        CHECK(text.GetSurface() == nullptr);
+        text.Reload();
+        text.SetArea(Rect(0, 0, 100, 40));
+        CHECK(text.GetSurface() == nullptr);
+        text.Reload();
+        text.GetFont().SetSize(20);
+        CHECK(text.GetSurface() == nullptr);
+        text.Reload();
+        CHECK(text.GetSurface() != nullptr);
+        text.GetFont().SetStyle(Font::Styles::Bold);
+        CHECK(text.GetSurface() == nullptr);
+    }
+
+    SUBCASE("Fonts share the face but not the size") {
+        CHECK_NOTHROW(Font::RegisterFont(cFontFile));
+        CHECK(FreeTypeLibrary::Get().GetFontFace(cFontName, Font::Styles::Normal) == FreeTypeLibrary::Get().GetFontFace(cFontName, Font::Styles::Normal));
+
+        Font small(cFontName);
+        Font large(cFontName);
+        small.SetSize(10);
+        large.SetSize(40);
+
+        auto small_glyphs = small.MakeGlyphs("M");
+        auto large_glyphs = large.MakeGlyphs("M");
+        auto small_again = small.MeasureGlyphs("M");
+
+        CHECK(small_glyphs[0].mHeight < 10);
+        CHECK(large_glyphs[0].mHeight > 20);
+        CHECK(small_again[0].mHeight == small_glyphs[0].mHeight);
+    }
+}
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <doctest.h>
 #include <graphics/Framebuffer.h>
+#include <graphics/kernels/PixelKernels.h>
 #include <graphics/primitives/Bitmap.h>
 #include <thread>
 #include <filesystem>
@@ -433,3 +434,123 @@ TEST_CASE("Framebuffer Drawing Primitives")
         fb.SwapBuffer(BufferedCanvas::SwapOperations::Clear);
     }
 }
+
+TEST_CASE("Framebuffer Threaded Presentation")
+{
+    std::filesystem::path p = rsp::posix::FileSystem::GetCharacterDeviceByDriverName("vfb2", std::filesystem::path{"/dev/fb?"});
+
+    Framebuffer fb(p.empty() ? nullptr : p.string().c_str(), Framebuffer::PresentModes::Threaded, true);
+
+    fb.SwapBuffer(BufferedCanvas::SwapOperations::Clear);
+    fb.SwapBuffer(BufferedCanvas::SwapOperations::Clear);
+    fb.SwapBuffer(BufferedCanvas::SwapOperations::Clear);
+
+    SUBCASE("Copy keeps every frame drawn so far")
+    {
+        // Each new back buffer must be caught up with the frames it missed
+        for (int i = 0; i < 20; i++) {
+            fb.DrawRectangle(Rect(10 + i * 10, 10, 5, 5), Color::White, true);
+            fb.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+
+            for (int j = 0; j <= i; j++) {
+                CHECK(fb.GetPixel(Point(12 + j * 10, 12), true) == Color::White);
+                CHECK(fb.GetPixel(Point(12 + j * 10, 12), false) == Color::White);
+            }
+            CHECK(fb.GetPixel(Point(12 + (i + 1) * 10, 12), false) == Color::Black);
+        }
+    }
+
+    SUBCASE("Clear")
+    {
+        fb.DrawRectangle(Rect(10, 10, 50, 50), Color::White, true);
+        fb.SwapBuffer(BufferedCanvas::SwapOperations::Clear);
+        CHECK(fb.GetPixel(Point(20, 20), true) == Color::White);
+        CHECK(fb.GetPixel(Point(20, 20), false) == Color::Black);
+    }
+}
+
+/**
+ * Framebuffer giving access to the pixels on the display
+ */
+class TestRotatedFramebuffer : public Framebuffer
+{
+  public:
+    using Framebuffer::Framebuffer;
+
+    uint32_t GetDisplayPixel(int aX, int aY) const
+    {
+        const PixelKernels::Table &kernels = PixelKernels::Get(mDisplayFormat);
+        const uint8_t *buffer = mBuffers[static_cast<std::size_t>(mDisplayed)];
+        return kernels.load(buffer + static_cast<std::size_t>(aY) * mDisplayStride + static_cast<std::size_t>(aX) * kernels.mBytesPerPixel);
+    }
+};
+
+TEST_CASE("Framebuffer Rotated Presentation")
+{
+    std::filesystem::path p = rsp::posix::FileSystem::GetCharacterDeviceByDriverName("vfb2", std::filesystem::path{"/dev/fb?"});
+    std::string device = p.string();
+    const char *path = p.empty() ? nullptr : device.c_str();
+    int display_width;
+    int display_height;
+    {
+        Framebuffer fb(path);
+        display_width = fb.GetWidth();
+        display_height = fb.GetHeight();
+    }
+
+    for (auto rotation : { Canvas::Rotations::Clockwise90, Canvas::Rotations::Clockwise180, Canvas::Rotations::Clockwise270 }) {
+        // Arrange
+        TestRotatedFramebuffer fb(path, Framebuffer::PresentModes::Synchronous, false, rotation);
+        int w = fb.GetWidth();
+        int h = fb.GetHeight();
+        auto display = [&](int aX, int aY) {
+            switch (rotation) {
+                case Canvas::Rotations::Clockwise90:
+                    return fb.GetDisplayPixel(h - 1 - aY, aX) & 0xE0E0E0;
+                case Canvas::Rotations::Clockwise180:
+                    return fb.GetDisplayPixel(w - 1 - aX, h - 1 - aY) & 0xE0E0E0;
+                default:
+                    return fb.GetDisplayPixel(aY, w - 1 - aX) & 0xE0E0E0;
+            }
+        };
+        const Color red(0xFFFF0000);
+        const Color green(0xFF00FF00);
+
+        // Assert
+        CHECK(fb.GetRotation() == rotation);
+        CHECK(fb.GetPixelFormat() == BufferedCanvas::PixelFormats::XRGB8888);
+        if (rotation == Canvas::Rotations::Clockwise180) {
+            CHECK(w == display_width);
+            CHECK(h == display_height);
+        }
+        else {
+            CHECK(w == display_height);
+            CHECK(h == display_width);
+        }
+
+        // Act, rectangles include the right and bottom edge
+        fb.SwapBuffer(BufferedCanvas::SwapOperations::Clear);
+        fb.DrawRectangle(Rect(10, 20, 5, 3), red, true);
+        fb.SwapBuffer();
+
+        // Assert
+        CHECK(display(10, 20) == 0xE00000);
+        CHECK(display(15, 23) == 0xE00000);
+        CHECK(display(16, 23) == 0);
+        CHECK(display(9, 20) == 0);
+
+        // Act, both display buffers must show every frame drawn so far
+        fb.DrawRectangle(Rect(w - 8, h - 6, 8, 6), green, true);
+        fb.SwapBuffer();
+        fb.DrawRectangle(Rect(0, 0, 1, 1), green, true);
+        fb.SwapBuffer();
+
+        // Assert
+        CHECK(display(12, 21) == 0xE00000);
+        CHECK(display(w - 1, h - 1) == 0x00E000);
+        CHECK(display(w - 8, h - 6) == 0x00E000);
+        CHECK(display(0, 0) == 0x00E000);
+        CHECK(display(2, 2) == 0);
+        CHECK(fb.GetPixel(Point(12, 21), true) == red);
+    }
+}
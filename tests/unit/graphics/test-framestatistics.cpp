@@ -0,0 +1,144 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <graphics/FrameStatistics.h>
+#include <graphics/MemoryCanvas.h>
+#include <graphics/TileRenderer.h>
+#include <utils/json/Json.h>
+#include <utils/json/JsonArray.h>
+#include <utils/json/JsonObject.h>
+
+using namespace rsp::graphics;
+using namespace rsp::utils::json;
+
+TEST_CASE("Frame Statistics")
+{
+    FrameStatistics stats;
+
+    SUBCASE("Percentiles")
+    {
+        CHECK(stats.GetPercentile(FrameStatistics::Timings::Draw, 0.5) == 0);
+
+        // 1..1000 us draw, 5 us swap
+        for (uint64_t i = 1; i <= 1000; i++) {
+            stats.Record(FrameStatistics::Frame{0, i, 5, 0, 0});
+        }
+        CHECK(stats.GetFrameCount() == 1000);
+
+        FrameStatistics::Summary draw = stats.GetSummary(FrameStatistics::Timings::Draw);
+        CHECK(draw.mCount == 1000);
+        CHECK(draw.mMax == 1000);
+        // Values are within one bucket, 1/16 of the value
+        CHECK(draw.mP50 >= 500);
+        CHECK(draw.mP50 <= 500 + 500 / 16);
+        CHECK(draw.mP95 >= 950);
+        CHECK(draw.mP95 <= 950 + 950 / 16);
+        CHECK(draw.mP99 >= 990);
+        CHECK(draw.mP99 <= 1000);
+
+        CHECK(stats.GetPercentile(FrameStatistics::Timings::Swap, 0.99) == 5);
+        CHECK(stats.GetSummary(FrameStatistics::Timings::Frame).mMax == 1005);
+        CHECK(stats.GetPercentile(FrameStatistics::Timings::Draw, 0.0) == 1);
+        CHECK(stats.GetPercentile(FrameStatistics::Timings::Draw, 1.0) == 1000);
+    }
+
+    SUBCASE("Large values")
+    {
+        stats.Record(FrameStatistics::Frame{0, uint64_t(1) << 50, 0, 0, 0});
+        CHECK(stats.GetSummary(FrameStatistics::Timings::Draw).mMax == uint64_t(1) << 50);
+        CHECK(stats.GetPercentile(FrameStatistics::Timings::Draw, 0.5) == uint64_t(1) << 50);
+    }
+
+    SUBCASE("Recent frames")
+    {
+        for (uint64_t i = 1; i <= FrameStatistics::cRecentFrames + 10; i++) {
+            stats.Record(FrameStatistics::Frame{0, i, 0, i * 2, i * 3});
+        }
+        std::vector<FrameStatistics::Frame> frames = stats.GetRecentFrames();
+        REQUIRE(frames.size() == FrameStatistics::cRecentFrames);
+        CHECK(frames.front().mNumber == 11);
+        CHECK(frames.front().mDrawTime == 11);
+        CHECK(frames.back().mNumber == FrameStatistics::cRecentFrames + 10);
+        CHECK(frames.back().mPixels == (FrameStatistics::cRecentFrames + 10) * 2);
+        CHECK(frames.back().mDirtyArea == (FrameStatistics::cRecentFrames + 10) * 3);
+
+        stats.Reset();
+        CHECK(stats.GetFrameCount() == 0);
+        CHECK(stats.GetRecentFrames().empty());
+        CHECK(stats.GetSummary(FrameStatistics::Timings::Draw).mCount == 0);
+    }
+
+    SUBCASE("Json")
+    {
+        stats.Record(FrameStatistics::Frame{0, 100, 20, 300, 400});
+        stats.Record(FrameStatistics::Frame{0, 200, 40, 500, 600});
+
+        Json json;
+        json.Decode(stats.ToJson());
+        JsonObject &o = json->AsObject();
+        CHECK(static_cast<int>(o["frames"]) == 2);
+        CHECK(static_cast<int>(o["draw_us"].AsObject()["max"]) == 200);
+        CHECK(static_cast<int>(o["frame_us"].AsObject()["p50"]) >= 120);
+        CHECK(static_cast<int>(o["frame_us"].AsObject()["p50"]) <= 123);
+        REQUIRE(o["recent"].AsArray().GetCount() == 2);
+        CHECK(static_cast<int>(o["recent"].AsArray()[1].AsObject()["pixels"]) == 500);
+        CHECK(static_cast<int>(o["recent"].AsArray()[1].AsObject()["dirty_area"]) == 600);
+    }
+
+    SUBCASE("Canvas")
+    {
+        MemoryCanvas canvas(100, 80);
+        const FrameStatistics &stats = canvas.GetFrameStatistics();
+        CHECK_FALSE(canvas.IsFrameStatisticsEnabled());
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+        CHECK(stats.GetFrameCount() == 0);
+        canvas.EnableFrameStatistics();
+        CHECK(canvas.IsFrameStatisticsEnabled());
+
+        canvas.DrawRectangle(Rect(10, 10, 9, 9), Color::White, true);
+        canvas.DrawLine(Point(0, 0), Point(99, 0), Color::White);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+
+        std::vector<FrameStatistics::Frame> frames = stats.GetRecentFrames();
+        REQUIRE(frames.size() == 2);
+        CHECK(frames[0].mPixels == 200);
+        CHECK(frames[0].mDirtyArea == 200);
+        CHECK(frames[1].mPixels == 0);
+        CHECK(frames[1].mDirtyArea == 0);
+
+        // Readers keep a valid object while recording is stopped
+        canvas.EnableFrameStatistics(false);
+        CHECK_FALSE(canvas.IsFrameStatisticsEnabled());
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+        CHECK(stats.GetFrameCount() == 2);
+        canvas.EnableFrameStatistics();
+        CHECK(stats.GetFrameCount() == 0);
+    }
+
+    SUBCASE("Tile renderer")
+    {
+        MemoryCanvas canvas(100, 80);
+        const FrameStatistics &stats = canvas.GetFrameStatistics();
+        canvas.EnableFrameStatistics();
+        TileRenderer renderer(canvas, 2, 16);
+
+        renderer.DrawRectangle(Rect(10, 10, 49, 29), Color::White, true);
+        renderer.Render();
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+
+        std::vector<FrameStatistics::Frame> frames = stats.GetRecentFrames();
+        REQUIRE(frames.size() == 2);
+        CHECK(frames[0].mPixels == 50 * 30);
+        CHECK(frames[1].mPixels == 0);
+    }
+}
@@ -0,0 +1,74 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <vector>
+#include <graphics/primitives/GlyphAtlas.h>
+
+using namespace rsp::graphics;
+
+TEST_CASE("Glyph Atlas")
+{
+    GlyphAtlas atlas(32, 32);
+
+    SUBCASE("Pixels are copied row by row")
+    {
+        // 3x2 bitmap with a pitch of 4
+        const uint8_t pixels[] = { 1, 2, 3, 99, 4, 5, 6, 99 };
+        Point pos;
+
+        CHECK(atlas.Insert(pixels, 3, 2, 4, pos));
+
+        CHECK(atlas.GetPixels(pos.GetX(), pos.GetY())[2] == 3);
+        CHECK(atlas.GetPixels(pos.GetX(), pos.GetY() + 1)[0] == 4);
+        CHECK(atlas.GetPixels(pos.GetX(), pos.GetY() + 1)[2] == 6);
+        CHECK(atlas.GetUsedArea() == 6);
+    }
+
+    SUBCASE("Bottom up bitmaps are flipped")
+    {
+        // 3x2 bitmap stored bottom up, as FreeType does for a negative pitch
+        const uint8_t pixels[] = { 4, 5, 6, 99, 1, 2, 3, 99 };
+        Point pos;
+
+        CHECK(atlas.Insert(pixels, 3, 2, -4, pos));
+
+        CHECK(atlas.GetPixels(pos.GetX(), pos.GetY())[0] == 1);
+        CHECK(atlas.GetPixels(pos.GetX(), pos.GetY())[2] == 3);
+        CHECK(atlas.GetPixels(pos.GetX(), pos.GetY() + 1)[0] == 4);
+        CHECK(atlas.GetPixels(pos.GetX(), pos.GetY() + 1)[2] == 6);
+    }
+
+    SUBCASE("Glyphs share shelves without overlap")
+    {
+        std::vector<uint8_t> pixels(100, 0xFF);
+        std::vector<int> owner(32 * 32, -1);
+        Point pos;
+        int count = 0;
+
+        // Mix of heights, until the atlas is full
+        const int heights[] = { 5, 6, 7, 8 };
+        while (atlas.Insert(pixels.data(), 7, heights[count % 4], 7, pos)) {
+            int overlaps = 0;
+            for (int dy = 0; dy < heights[count % 4]; dy++) {
+                for (int dx = 0; dx < 7; dx++) {
+                    int &pixel_owner = owner[static_cast<std::size_t>((pos.GetY() + dy) * 32 + pos.GetX() + dx)];
+                    overlaps += (pixel_owner != -1);
+                    pixel_owner = count;
+                }
+            }
+            CHECK(overlaps == 0);
+            count++;
+        }
+
+        CHECK(count >= 12);
+        CHECK_FALSE(atlas.Insert(pixels.data(), 33, 1, 33, pos));
+    }
+}
@@ -0,0 +1,80 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <graphics/primitives/Font.h>
+#include <graphics/primitives/freetype/GlyphCache.h>
+
+using namespace rsp::graphics;
+
+static GlyphCache::Key makeKey(uint32_t aSymbol, int aSize = 16)
+{
+    return GlyphCache::Key { "Exo 2", Font::Styles::Normal, aSize, aSize, aSymbol };
+}
+
+static Glyph makeGlyph(uint32_t aSymbol)
+{
+    Glyph glyph;
+    glyph.mSymbolUnicode = aSymbol;
+    glyph.mWidth = static_cast<int>(aSymbol);
+    return glyph;
+}
+
+TEST_CASE("Glyph Cache")
+{
+    GlyphCache cache(3);
+    Glyph glyph;
+
+    SUBCASE("Hit and miss")
+    {
+        CHECK_FALSE(cache.Lookup(makeKey('A'), glyph));
+        cache.Insert(makeKey('A'), makeGlyph('A'));
+
+        CHECK(cache.Lookup(makeKey('A'), glyph));
+        CHECK(glyph.mSymbolUnicode == 'A');
+        CHECK_FALSE(cache.Lookup(makeKey('A', 17), glyph));
+
+        CHECK(cache.GetHits() == 1);
+        CHECK(cache.GetMisses() == 2);
+        cache.ResetStatistics();
+        CHECK(cache.GetHits() == 0);
+        CHECK(cache.GetMisses() == 0);
+    }
+
+    SUBCASE("Least recently used is evicted")
+    {
+        cache.Insert(makeKey('A'), makeGlyph('A'));
+        cache.Insert(makeKey('B'), makeGlyph('B'));
+        cache.Insert(makeKey('C'), makeGlyph('C'));
+        CHECK(cache.Lookup(makeKey('A'), glyph));
+
+        cache.Insert(makeKey('D'), makeGlyph('D'));
+
+        CHECK(cache.GetSize() == 3);
+        CHECK(cache.Lookup(makeKey('A'), glyph));
+        CHECK_FALSE(cache.Lookup(makeKey('B'), glyph));
+        CHECK(cache.Lookup(makeKey('C'), glyph));
+        CHECK(cache.Lookup(makeKey('D'), glyph));
+        CHECK(glyph.mWidth == 'D');
+    }
+
+    SUBCASE("Capacity")
+    {
+        cache.Insert(makeKey('A'), makeGlyph('A'));
+        cache.Insert(makeKey('B'), makeGlyph('B'));
+        cache.SetCapacity(1);
+        CHECK(cache.GetSize() == 1);
+        CHECK(cache.Lookup(makeKey('B'), glyph));
+
+        cache.SetCapacity(0);
+        cache.Insert(makeKey('C'), makeGlyph('C'));
+        CHECK(cache.GetSize() == 0);
+    }
+}
@@ -0,0 +1,176 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <graphics/primitives/Bitmap.h>
+#include <graphics/primitives/ImageCache.h>
+
+using namespace rsp::graphics;
+
+static void writeFile(const std::string &arName, const std::string &arContent)
+{
+    std::ofstream file(arName, std::ios::binary);
+    file << arContent;
+}
+
+TEST_CASE("Image Cache")
+{
+    // Images of 100 pixels, 400 bytes each
+    const std::size_t cImageBytes = 400;
+    ImageCache cache(2 * cImageBytes);
+    int decodes = 0;
+    auto decoder = [&decodes](const std::string&) {
+        decodes++;
+        auto pixels = std::make_shared<std::vector<uint32_t>>(100, 0xFF000000);
+        return ImageCache::Image{ std::shared_ptr<const uint32_t>(pixels, pixels->data()), 10, 10 };
+    };
+    writeFile("cache-a.img", "a");
+    writeFile("cache-b.img", "b");
+    writeFile("cache-c.img", "c");
+
+    SUBCASE("Shares decoded pixels")
+    {
+        // Act
+        ImageCache::Image first = cache.Load("cache-a.img", decoder);
+        ImageCache::Image second = cache.Load("cache-a.img", decoder);
+
+        // Assert
+        CHECK(decodes == 1);
+        CHECK(first.mpPixels == second.mpPixels);
+        CHECK(second.mWidth == 10);
+        CHECK(cache.GetHits() == 1);
+        CHECK(cache.GetMisses() == 1);
+        CHECK(cache.GetMemoryUsage() == cImageBytes);
+    }
+
+    SUBCASE("Decodes changed files again")
+    {
+        // Arrange
+        ImageCache::Image first = cache.Load("cache-a.img", decoder);
+
+        // Act
+        writeFile("cache-a.img", "changed");
+        ImageCache::Image second = cache.Load("cache-a.img", decoder);
+
+        // Assert
+        CHECK(decodes == 2);
+        CHECK(first.mpPixels != second.mpPixels);
+        CHECK(cache.GetSize() == 1);
+    }
+
+    SUBCASE("Evicts least recently used")
+    {
+        // Act
+        cache.Load("cache-a.img", decoder);
+        cache.Load("cache-b.img", decoder);
+        cache.Load("cache-a.img", decoder);
+        cache.Load("cache-c.img", decoder);
+
+        // Assert
+        CHECK(cache.GetSize() == 2);
+        CHECK(cache.GetMemoryUsage() == 2 * cImageBytes);
+        CHECK(decodes == 3);
+        cache.Load("cache-a.img", decoder);
+        CHECK(decodes == 3);
+        cache.Load("cache-b.img", decoder);
+        CHECK(decodes == 4);
+    }
+
+    SUBCASE("Budget")
+    {
+        // Act
+        cache.Load("cache-a.img", decoder);
+        cache.Load("cache-b.img", decoder);
+        cache.SetBudget(cImageBytes);
+
+        // Assert
+        CHECK(cache.GetSize() == 1);
+        cache.SetBudget(cImageBytes - 1);
+        CHECK(cache.GetSize() == 0);
+        ImageCache::Image image = cache.Load("cache-a.img", decoder);
+        CHECK(image.mpPixels);
+        CHECK(cache.GetSize() == 0);
+    }
+
+    SUBCASE("Failures are not cached")
+    {
+        // Arrange
+        auto failing = [&decodes](const std::string&) -> ImageCache::Image {
+            decodes++;
+            throw std::runtime_error("Decode failed");
+        };
+
+        // Act / Assert
+        CHECK_THROWS_AS(cache.Load("cache-a.img", failing), const std::runtime_error &);
+        CHECK_THROWS_AS(cache.Load("cache-a.img", failing), const std::runtime_error &);
+        CHECK(decodes == 2);
+        CHECK(cache.GetSize() == 0);
+        CHECK_THROWS_AS(cache.Load("missing.img", failing), const std::runtime_error &);
+    }
+
+    std::filesystem::remove("cache-a.img");
+    std::filesystem::remove("cache-b.img");
+    std::filesystem::remove("cache-c.img");
+}
+
+TEST_CASE("Bitmap shared pixels")
+{
+    // Arrange
+    const std::string cFileName = "testImages/testImage.bmp";
+    Bitmap first(cFileName);
+    Bitmap second(cFileName);
+    Color color(0xFF123456);
+    Point point(10, 10);
+
+    // Assert
+    CHECK(first.GetPixels().data() == second.GetPixels().data());
+
+    SUBCASE("Drawing copies the pixels")
+    {
+        // Act
+        uint32_t original = first.GetPixel(point);
+        second.SetPixel(point, color);
+
+        // Assert
+        CHECK(first.GetPixels().data() != second.GetPixels().data());
+        CHECK(second.GetPixel(point) == color);
+        CHECK(first.GetPixel(point) == original);
+        CHECK(Bitmap(cFileName).GetPixel(point) == original);
+    }
+
+    SUBCASE("Copies share until drawn on")
+    {
+        // Act
+        Bitmap copy = first;
+        CHECK(copy.GetPixels().data() == first.GetPixels().data());
+        copy.DrawRectangle(Rect(0, 0, 20, 20), color, true);
+
+        // Assert
+        CHECK(copy.GetPixels().data() != first.GetPixels().data());
+        CHECK(copy.GetPixel(point) == color);
+        CHECK(std::ranges::equal(first.GetPixels(), second.GetPixels()));
+    }
+
+    SUBCASE("Private pixels are drawn in place")
+    {
+        // Act
+        Bitmap bitmap(20, 20, 4);
+        const uint32_t *pixels = bitmap.GetPixels().data();
+        bitmap.DrawRectangle(Rect(0, 0, 5, 5), color, true);
+
+        // Assert
+        CHECK(bitmap.GetPixels().data() == pixels);
+        CHECK(bitmap.GetPixel(Point(2, 2)) == color);
+    }
+}
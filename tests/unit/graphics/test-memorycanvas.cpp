@@ -0,0 +1,138 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <filesystem>
+#include <graphics/MemoryCanvas.h>
+#include <graphics/primitives/Bitmap.h>
+#include <utils/CoreException.h>
+
+using namespace rsp::graphics;
+
+TEST_CASE("Memory Canvas")
+{
+    const Color red(0xFF, 0x00, 0x00, 0xFF);
+    const Color blue(0x00, 0x00, 0xFF, 0xFF);
+    MemoryCanvas canvas(40, 30);
+    canvas.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color::Black);
+
+    CHECK(canvas.GetWidth() == 40);
+    CHECK(canvas.GetHeight() == 30);
+
+    SUBCASE("Drawing goes to the back buffer")
+    {
+        canvas.DrawRectangle(Rect(5, 5, 10, 10), red, true);
+
+        CHECK(canvas.GetPixel(Point(5, 5)) == uint32_t(red));
+        CHECK(canvas.GetPixel(Point(14, 14)) == uint32_t(red));
+        CHECK(canvas.GetPixel(Point(15, 15)) == uint32_t(red));
+        CHECK(canvas.GetPixel(Point(16, 16)) == uint32_t(Color::Black));
+        CHECK(canvas.GetPixel(Point(5, 5), true) == uint32_t(Color::Black));
+
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::NoOp);
+        CHECK(canvas.GetPixel(Point(5, 5), true) == uint32_t(red));
+        CHECK(canvas.GetFrameCount() == 2);
+    }
+
+    SUBCASE("Swap operations")
+    {
+        canvas.DrawRectangle(Rect(0, 0, 4, 4), red, true);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+        CHECK(canvas.GetPixel(Point(2, 2)) == uint32_t(red));
+
+        // Only the dirty area is copied once the buffers are in sync
+        canvas.DrawRectangle(Rect(10, 10, 4, 4), blue, true);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+        CHECK(canvas.GetPixel(Point(2, 2)) == uint32_t(red));
+        CHECK(canvas.GetPixel(Point(12, 12)) == uint32_t(blue));
+        CHECK(canvas.GetPixel(Point(12, 12), true) == uint32_t(blue));
+
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Clear, blue);
+        CHECK(canvas.GetPixel(Point(2, 2)) == uint32_t(blue));
+        CHECK(canvas.GetPixel(Point(2, 2), true) == uint32_t(red));
+    }
+
+    SUBCASE("Set pixels survive copy swaps")
+    {
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+
+        canvas.SetPixel(Point(7, 8), red);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+        canvas.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+
+        CHECK(canvas.GetPixel(Point(7, 8)) == uint32_t(red));
+        CHECK(canvas.GetPixel(Point(7, 8), true) == uint32_t(red));
+    }
+
+    SUBCASE("Padded rows")
+    {
+        MemoryCanvas padded(10, 10, 64);
+        padded.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color::Black);
+        padded.DrawRectangle(Rect(0, 0, 10, 10), red, true);
+        padded.SetPixel(Point(9, 9), blue);
+
+        CHECK(padded.GetPixel(Point(0, 1)) == uint32_t(red));
+        CHECK(padded.GetPixel(Point(9, 8)) == uint32_t(red));
+        CHECK(padded.GetPixel(Point(9, 9)) == uint32_t(blue));
+
+        CHECK_THROWS_AS(MemoryCanvas(10, 10, 20), const rsp::utils::CoreException &);
+    }
+
+    SUBCASE("16 and 24 bit pixel formats")
+    {
+        for (auto format : { BufferedCanvas::PixelFormats::RGB565, BufferedCanvas::PixelFormats::RGB888 }) {
+            MemoryCanvas native(33, 20, 0, format);
+            native.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color::Black);
+
+            CHECK(native.GetPixelFormat() == format);
+            CHECK(native.GetPixel(Point(32, 19)) == 0xFF000000);
+
+            native.DrawRectangle(Rect(1, 1, 30, 10), red, true);
+            native.DrawLine(Point(0, 15), Point(32, 15), blue);
+            CHECK(native.GetPixel(Point(1, 1)) == 0xFFFF0000);
+            CHECK(native.GetPixel(Point(31, 11)) == 0xFFFF0000);
+            CHECK(native.GetPixel(Point(32, 11)) == 0xFF000000);
+            CHECK(native.GetPixel(Point(32, 15)) == 0xFF0000FF);
+
+            // Blending goes through 32 bit colors
+            native.SetBlendMode(Canvas::BlendModes::SourceOver);
+            native.DrawRectangle(Rect(0, 0, 32, 19), Color(0x00, 0x00, 0xFF, 0x80), true);
+            native.SetBlendMode(Canvas::BlendModes::Copy);
+            uint32_t mixed = native.GetPixel(Point(5, 5));
+            CHECK(((mixed >> 16) & 0xFF) > 0x70);
+            CHECK(((mixed >> 16) & 0xFF) < 0x90);
+            CHECK((mixed & 0xFF) > 0x70);
+            CHECK((mixed & 0xFF) < 0x90);
+
+            native.SwapBuffer(BufferedCanvas::SwapOperations::Copy);
+            CHECK(native.GetPixel(Point(5, 5), true) == mixed);
+            CHECK(native.GetPixel(Point(5, 5)) == mixed);
+        }
+    }
+
+    SUBCASE("Frames can be saved as BMP")
+    {
+        const char *cFileName = "memorycanvas.bmp";
+        canvas.DrawRectangle(Rect(0, 0, 39, 29), red, true);
+        canvas.DrawRectangle(Rect(0, 0, 5, 3), blue, true);
+        canvas.SwapBuffer();
+        canvas.SaveBmp(cFileName);
+
+        Bitmap bitmap(cFileName);
+        CHECK(bitmap.GetWidth() == 40);
+        CHECK(bitmap.GetHeight() == 30);
+        CHECK((bitmap.GetPixel(Point(0, 0)) & 0xFFFFFF) == (uint32_t(blue) & 0xFFFFFF));
+        CHECK((bitmap.GetPixel(Point(5, 3)) & 0xFFFFFF) == (uint32_t(blue) & 0xFFFFFF));
+        CHECK((bitmap.GetPixel(Point(6, 4)) & 0xFFFFFF) == (uint32_t(red) & 0xFFFFFF));
+        CHECK((bitmap.GetPixel(Point(39, 29)) & 0xFFFFFF) == (uint32_t(red) & 0xFFFFFF));
+
+        std::filesystem::remove(cFileName);
+    }
+}
@@ -0,0 +1,133 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <vector>
+#include <graphics/kernels/PixelKernels.h>
+
+using namespace rsp::graphics;
+
+using PixelFormats = BufferedCanvas::PixelFormats;
+
+static uint16_t toRgb565(uint32_t aColor)
+{
+    uint32_t r = (aColor >> 19) & 0x1F;
+    uint32_t g = (aColor >> 10) & 0x3F;
+    uint32_t b = (aColor >> 3) & 0x1F;
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+TEST_CASE("Pixel Kernels")
+{
+    MESSAGE("RGB565 instruction set: " << PixelKernels::GetInstructionSet());
+
+    std::vector<uint32_t> colors(301);
+    for (std::size_t i = 0 ; i < colors.size() ; i++) {
+        colors[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+
+    SUBCASE("Pixel sizes")
+    {
+        CHECK(PixelKernels::Get(PixelFormats::XRGB8888).mBytesPerPixel == 4);
+        CHECK(PixelKernels::Get(PixelFormats::RGB888).mBytesPerPixel == 3);
+        CHECK(PixelKernels::Get(PixelFormats::RGB565).mBytesPerPixel == 2);
+    }
+
+    SUBCASE("RGB565 conversion matches scalar reference")
+    {
+        const PixelKernels::Table &k = PixelKernels::Get(PixelFormats::RGB565);
+        std::vector<uint16_t> buf(colors.size() + 2, 0xBEEF);
+
+        // Act, convert at every alignment and length around the vector widths
+        for (std::size_t offset = 0 ; offset < 2 ; offset++) {
+            for (std::size_t count : { 1u, 7u, 8u, 15u, 16u, 17u, 299u }) {
+                std::fill(buf.begin(), buf.end(), 0xBEEF);
+                k.fromArgb(reinterpret_cast<uint8_t*>(buf.data() + offset), colors.data(), count);
+
+                // Assert
+                int errors = 0;
+                for (std::size_t i = 0 ; i < buf.size() ; i++) {
+                    bool inside = (i >= offset) && (i < offset + count);
+                    errors += (buf[i] != (inside ? toRgb565(colors[i - offset]) : 0xBEEF));
+                }
+                CHECK(errors == 0);
+            }
+        }
+    }
+
+    SUBCASE("RGB565 round trip keeps full intensity")
+    {
+        const PixelKernels::Table &k = PixelKernels::Get(PixelFormats::RGB565);
+        uint8_t pixel[2];
+
+        k.store(pixel, 0xFFFFFFFF);
+        CHECK(k.load(pixel) == 0xFFFFFFFF);
+        k.store(pixel, 0xFF000000);
+        CHECK(k.load(pixel) == 0xFF000000);
+        k.store(pixel, 0x00FF8040);
+        CHECK(k.load(pixel) == 0xFFFF8242);
+    }
+
+    SUBCASE("RGB888 stores blue first")
+    {
+        const PixelKernels::Table &k = PixelKernels::Get(PixelFormats::RGB888);
+        uint8_t pixel[3];
+
+        k.store(pixel, 0x00112233);
+        CHECK(pixel[0] == 0x33);
+        CHECK(pixel[1] == 0x22);
+        CHECK(pixel[2] == 0x11);
+        CHECK(k.load(pixel) == 0xFF112233);
+    }
+
+    SUBCASE("Fill matches store")
+    {
+        for (PixelFormats format : { PixelFormats::XRGB8888, PixelFormats::RGB888, PixelFormats::RGB565 }) {
+            const PixelKernels::Table &k = PixelKernels::Get(format);
+            const std::size_t bpp = k.mBytesPerPixel;
+
+            for (std::size_t offset = 0 ; offset < 3 ; offset++) {
+                for (std::size_t count : { 0u, 1u, 2u, 5u, 33u, 270u }) {
+                    std::vector<uint8_t> expected(300 * 4, 0xAA);
+                    std::vector<uint8_t> actual(expected);
+                    for (std::size_t i = 0 ; i < count ; i++) {
+                        k.store(expected.data() + (offset + i) * bpp, 0x00123456);
+                    }
+
+                    // Keep the 32 bit rows 32 bit aligned
+                    k.fill(actual.data() + offset * bpp, 0x00123456, count);
+
+                    CHECK(actual == expected);
+                }
+            }
+        }
+    }
+
+    SUBCASE("Rows convert back and forth")
+    {
+        for (PixelFormats format : { PixelFormats::XRGB8888, PixelFormats::RGB888, PixelFormats::RGB565 }) {
+            const PixelKernels::Table &k = PixelKernels::Get(format);
+            std::vector<uint8_t> native(colors.size() * k.mBytesPerPixel);
+            std::vector<uint32_t> argb(colors.size());
+
+            k.fromArgb(native.data(), colors.data(), colors.size());
+            k.toArgb(argb.data(), native.data(), colors.size());
+
+            int errors = 0;
+            for (std::size_t i = 0 ; i < colors.size() ; i++) {
+                errors += (argb[i] != k.load(native.data() + i * k.mBytesPerPixel));
+                std::vector<uint8_t> single(4);
+                k.store(single.data(), colors[i]);
+                errors += (k.load(single.data()) != argb[i]);
+            }
+            CHECK(errors == 0);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <vector>
+#include <graphics/kernels/PngKernels.h>
+
+using namespace rsp::graphics;
+
+static std::vector<uint8_t> pattern(std::size_t aSize, unsigned aSeed)
+{
+    std::vector<uint8_t> result(aSize);
+    for (std::size_t i = 0; i < aSize; i++) {
+        aSeed = aSeed * 1103515245u + 12345u;
+        result[i] = static_cast<uint8_t>(aSeed >> 16);
+    }
+    return result;
+}
+
+TEST_CASE("Png Kernels")
+{
+    MESSAGE("Instruction set: " << PngKernels::GetInstructionSet());
+
+    SUBCASE("Paeth matches scalar for all pixel sizes")
+    {
+        for (std::size_t bpp = 1; bpp <= 8; bpp++) {
+            for (std::size_t bytes : { bpp, 3 * bpp, 97 * bpp }) {
+                // Arrange
+                std::vector<uint8_t> previous = pattern(bytes, 1);
+                std::vector<uint8_t> row = pattern(bytes, 2);
+                std::vector<uint8_t> expected = row;
+                PngKernels::UnfilterPaethScalar(expected.data(), previous.data(), bytes, bpp);
+
+                // Act
+                CHECK(PngKernels::Unfilter(PngKernels::Paeth, row.data(), previous.data(), bytes, bpp));
+
+                // Assert
+                CHECK(row == expected);
+            }
+        }
+    }
+
+    SUBCASE("Simple filters")
+    {
+        // Arrange
+        const std::vector<uint8_t> previous = { 10, 20, 30, 40, 50, 60 };
+        const std::vector<uint8_t> filtered = { 1, 2, 3, 4, 250, 6 };
+
+        // Act / Assert
+        std::vector<uint8_t> row = filtered;
+        CHECK(PngKernels::Unfilter(PngKernels::None, row.data(), previous.data(), row.size(), 2));
+        CHECK(row == filtered);
+
+        row = filtered;
+        CHECK(PngKernels::Unfilter(PngKernels::Sub, row.data(), previous.data(), row.size(), 2));
+        CHECK(row == std::vector<uint8_t>{ 1, 2, 4, 6, 254, 12 });
+
+        row = filtered;
+        CHECK(PngKernels::Unfilter(PngKernels::Up, row.data(), previous.data(), row.size(), 2));
+        CHECK(row == std::vector<uint8_t>{ 11, 22, 33, 44, 44, 66 });
+
+        row = filtered;
+        CHECK(PngKernels::Unfilter(PngKernels::Average, row.data(), previous.data(), row.size(), 2));
+        CHECK(row == std::vector<uint8_t>{ 6, 12, 21, 30, 29, 51 });
+
+        CHECK_FALSE(PngKernels::Unfilter(5, row.data(), previous.data(), row.size(), 2));
+    }
+}
@@ -0,0 +1,86 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include <graphics/MemoryCanvas.h>
+#include <graphics/primitives/Bitmap.h>
+#include <graphics/primitives/Raster.h>
+
+using namespace rsp::graphics;
+
+TEST_CASE("Raster Algorithms")
+{
+    SUBCASE("Line pixels are visited in order")
+    {
+        // Y major line from (2, 1) to (4, 5), 5 pixels
+        Raster::Line line { 1, 2, 1, 1, 1, 4, 2, 5, true };
+        std::vector<std::pair<int, int>> points;
+
+        Raster::ForEachLinePixel(line, [&points](int aX, int aY) {
+            points.emplace_back(aX, aY);
+        });
+
+        REQUIRE(points.size() == 5);
+        CHECK(points[0] == std::make_pair(2, 1));
+        CHECK(points[1] == std::make_pair(2, 2));
+        CHECK(points[2] == std::make_pair(3, 3));
+        CHECK(points[3] == std::make_pair(3, 4));
+        CHECK(points[4] == std::make_pair(4, 5));
+    }
+
+    SUBCASE("Circle runs cover the octant")
+    {
+        for (int radius : { 0, 1, 2, 13, 100 }) {
+            int next = 0;
+            int last_radius = radius;
+            bool contiguous = true;
+
+            Raster::ForEachCircleRun(radius, [&](int aRadius, int aY0, int aY1) {
+                contiguous = contiguous && (aY0 == next) && (aY1 >= aY0) && (aRadius <= last_radius);
+                next = aY1 + 1;
+                last_radius = aRadius;
+            });
+
+            CHECK(contiguous);
+            CHECK(next >= last_radius);
+        }
+    }
+
+    SUBCASE("Surfaces plot identical lines")
+    {
+        for (auto mode : { Canvas::BlendModes::Copy, Canvas::BlendModes::SourceOver }) {
+            Bitmap bitmap(100, 120, 4);
+            MemoryCanvas canvas(120, 100);
+            canvas.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color(0));
+            bitmap.SetBlendMode(mode);
+            canvas.SetBlendMode(mode);
+
+            srand(7);
+            for (int i = 0 ; i < 300 ; i++) {
+                Point a(rand() % 300 - 90, rand() % 300 - 100);
+                Point b(rand() % 300 - 90, rand() % 300 - 100);
+                Color color(static_cast<uint32_t>(rand()) | 0x80000000u);
+                bitmap.DrawLine(a, b, color);
+                canvas.DrawLine(a, b, color);
+            }
+
+            int errors = 0;
+            for (int y = 0 ; y < 100 ; y++) {
+                for (int x = 0 ; x < 120 ; x++) {
+                    errors += (bitmap.GetPixel(Point(x, y)) != canvas.GetPixel(Point(x, y)));
+                }
+            }
+            CHECK(errors == 0);
+        }
+    }
+}
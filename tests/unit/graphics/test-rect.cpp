@@ -143,3 +143,51 @@ TEST_CASE("Rect Height and Width")
         CHECK(rect.GetWidth() != -50);
     }
 }
+
+TEST_CASE("Rect Intersection and Union")
+{
+    Rect rect(cLeft, cTop, cWidth, cHeight);
+
+    SUBCASE("Overlapping Rects")
+    {
+        // Arrange
+        Rect other(cLeft + 50, cTop + 50, cWidth, cHeight);
+
+        // Act
+        Rect inter = rect.Intersection(other);
+        Rect uni = rect.Union(other);
+
+        // Assert
+        CHECK(rect.Intersects(other));
+        CHECK(inter.GetLeft() == cLeft + 50);
+        CHECK(inter.GetTop() == cTop + 50);
+        CHECK(inter.GetRight() == cLeft + cWidth);
+        CHECK(inter.GetBottom() == cTop + cHeight);
+        CHECK(uni.GetLeft() == cLeft);
+        CHECK(uni.GetTop() == cTop);
+        CHECK(uni.GetRight() == cLeft + cWidth + 50);
+        CHECK(uni.GetBottom() == cTop + cHeight + 50);
+        CHECK(uni.GetArea() == (cWidth + 50) * (cHeight + 50));
+    }
+    SUBCASE("Separate Rects")
+    {
+        // Arrange
+        Rect other(cLeft + cWidth, cTop, 10, 10);
+
+        // Act & Assert
+        CHECK_FALSE(rect.Intersects(other));
+        CHECK(rect.Intersection(other).IsEmpty());
+    }
+    SUBCASE("Union with empty Rect")
+    {
+        // Arrange
+        Rect empty(0, 0, 0, 0);
+
+        // Act
+        Rect uni = empty.Union(rect);
+
+        // Assert
+        CHECK(empty.IsEmpty());
+        checkRect(uni);
+    }
+}
@@ -0,0 +1,81 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <algorithm>
+#include <vector>
+#include <graphics/kernels/RowKernels.h>
+
+using namespace rsp::graphics;
+
+TEST_CASE("Row Kernels")
+{
+    MESSAGE("Instruction set: " << RowKernels::GetInstructionSet());
+
+    SUBCASE("Fill unaligned rows")
+    {
+        // Arrange
+        std::vector<uint32_t> buf(300, 0);
+
+        // Act
+        for (std::size_t offset = 0 ; offset < 9 ; offset++) {
+            std::fill(buf.begin(), buf.end(), 0);
+            RowKernels::Fill32(buf.data() + offset, 0x12345678, 271);
+
+            // Assert
+            for (std::size_t i = 0 ; i < buf.size() ; i++) {
+                bool inside = (i >= offset) && (i < offset + 271);
+                CHECK(buf[i] == (inside ? 0x12345678u : 0u));
+            }
+        }
+    }
+
+    SUBCASE("Fill large rect with stride")
+    {
+        // Arrange
+        const std::size_t stride = 520 * sizeof(uint32_t);
+        std::vector<uint32_t> buf(520 * 300, 0);
+
+        // Act
+        RowKernels::FillRect32(reinterpret_cast<uint8_t*>(buf.data() + 1), stride, 0xFF00FF00, 512, 300);
+
+        // Assert
+        std::size_t count = static_cast<std::size_t>(std::count(buf.begin(), buf.end(), 0xFF00FF00u));
+        CHECK(count == 512 * 300);
+        CHECK(buf[0] == 0);
+        CHECK(buf[513] == 0);
+        CHECK(buf[520 + 512] == 0xFF00FF00u);
+    }
+
+    SUBCASE("Copy rect")
+    {
+        // Arrange
+        const std::size_t stride = 700;
+        std::vector<uint8_t> src(stride * 400);
+        std::vector<uint8_t> dst(stride * 400, 0);
+        for (std::size_t i = 0 ; i < src.size() ; i++) {
+            src[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        // Act
+        RowKernels::CopyRect(dst.data() + 3, src.data() + 3, stride, 690, 400);
+
+        // Assert
+        bool equal = true;
+        for (std::size_t y = 0 ; y < 400 ; y++) {
+            for (std::size_t x = 0 ; x < stride ; x++) {
+                std::size_t i = y * stride + x;
+                uint8_t expected = ((x >= 3) && (x < 693)) ? src[i] : 0;
+                equal = equal && (dst[i] == expected);
+            }
+        }
+        CHECK(equal);
+    }
+}
@@ -0,0 +1,113 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <cstdlib>
+#include <graphics/MemoryCanvas.h>
+#include <graphics/TileRenderer.h>
+#include <graphics/primitives/Bitmap.h>
+#include <graphics/primitives/Font.h>
+#include <graphics/primitives/Text.h>
+#include "CanvasCompare.h"
+
+using namespace rsp::graphics;
+
+static void drawRandomScene(unsigned aWorkers)
+{
+    const char* cFontFile = "fonts/Exo2-VariableFont_wght.ttf";
+    const char* cFontName = "Exo 2";
+
+    MemoryCanvas direct(200, 150);
+    MemoryCanvas tiled(200, 150);
+    direct.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color(0));
+    tiled.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color(0));
+    TileRenderer renderer(tiled, aWorkers, 16);
+    CHECK(renderer.GetWorkerCount() == aWorkers);
+
+    Bitmap image("testImages/testImage.bmp");
+    Font::RegisterFont(cFontFile);
+    Text text(cFontName, "Tiles");
+    text.GetFont().SetSize(30);
+    text.SetArea(Rect(20, 40, 150, 60)).Reload();
+
+    srand(11);
+    for (int i = 0 ; i < 50 ; i++) {
+        Point a(rand() % 260 - 30, rand() % 200 - 25);
+        Point b(rand() % 260 - 30, rand() % 200 - 25);
+        Color color(static_cast<uint32_t>(rand()) | 0x80000000u);
+        Canvas::BlendModes mode = (i % 3) ? Canvas::BlendModes::Copy : Canvas::BlendModes::SourceOver;
+
+        direct.SetBlendMode(mode);
+        renderer.SetBlendMode(mode);
+        switch (i % 5) {
+            case 0:
+                direct.DrawLine(a, b, color);
+                renderer.DrawLine(a, b, color);
+                break;
+            case 1:
+                direct.DrawCircle(a, i, color);
+                renderer.DrawCircle(a, i, color);
+                break;
+            case 2:
+                direct.DrawRectangle(Rect(a, 40, 25), color, (i % 2) == 0);
+                renderer.DrawRectangle(Rect(a, 40, 25), color, (i % 2) == 0);
+                break;
+            case 3:
+                direct.DrawImage(a, image, Rect(10, 20, 100, 60));
+                renderer.DrawImage(a, image, Rect(10, 20, 100, 60));
+                break;
+            default:
+                direct.DrawText(text, color);
+                renderer.DrawText(text, color);
+                break;
+        }
+    }
+
+    CHECK(renderer.GetCommandCount() == 50);
+    renderer.Render();
+    CHECK(renderer.GetCommandCount() == 0);
+
+    CHECK(countDifferences(direct, tiled) == 0);
+}
+
+static void drawClipped(unsigned aWorkers)
+{
+    MemoryCanvas canvas(200, 150);
+    canvas.SwapBuffer(BufferedCanvas::SwapOperations::Clear, Color(0));
+    TileRenderer renderer(canvas, aWorkers, 16);
+
+    canvas.PushClipRect(Rect(50, 50, 30, 30));
+    renderer.DrawRectangle(Rect(0, 0, 199, 149), Color(0xFFFFFFFF), true);
+    renderer.Render();
+    canvas.PopClipRect();
+
+    CHECK(canvas.GetPixel(Point(50, 50)) == 0xFFFFFFFF);
+    CHECK(canvas.GetPixel(Point(79, 79)) == 0xFFFFFFFF);
+    CHECK(canvas.GetPixel(Point(80, 80)) == 0);
+    CHECK(canvas.GetPixel(Point(49, 60)) == 0);
+    REQUIRE(canvas.GetDirtyRegion().GetRects().size() == 1);
+    CHECK(canvas.GetDirtyRegion().GetRects()[0].GetLeft() == 50);
+    CHECK(canvas.GetDirtyRegion().GetRects()[0].GetWidth() == 30);
+}
+
+TEST_CASE("Tile Renderer")
+{
+    SUBCASE("Calling thread only")
+    {
+        drawRandomScene(0);
+        drawClipped(0);
+    }
+
+    SUBCASE("Worker threads")
+    {
+        drawRandomScene(3);
+        drawClipped(3);
+    }
+}
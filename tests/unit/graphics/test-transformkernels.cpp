@@ -0,0 +1,134 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <vector>
+#include <graphics/kernels/TransformKernels.h>
+
+using namespace rsp::graphics;
+
+static std::vector<uint32_t> pattern(std::size_t aSize, unsigned aSeed)
+{
+    std::vector<uint32_t> result(aSize);
+    for (std::size_t i = 0; i < aSize; i++) {
+        aSeed = aSeed * 1103515245u + 12345u;
+        result[i] = aSeed ^ (aSeed >> 15);
+    }
+    return result;
+}
+
+TEST_CASE("Transform Kernels")
+{
+    MESSAGE("Instruction set: " << TransformKernels::GetInstructionSet());
+
+    SUBCASE("Row blending matches scalar")
+    {
+        for (uint32_t weight : { 0u, 1u, 128u, 255u }) {
+            // Arrange
+            std::vector<uint32_t> top = pattern(37, 1);
+            std::vector<uint32_t> bottom = pattern(37, 2);
+            std::vector<uint32_t> expected(top.size());
+            std::vector<uint32_t> result(top.size());
+            TransformKernels::BlendRowsScalar(expected.data(), top.data(), bottom.data(), top.size(), weight);
+
+            // Act
+            TransformKernels::BlendRows(result.data(), top.data(), bottom.data(), top.size(), weight);
+
+            // Assert
+            CHECK(result == expected);
+        }
+        // Endpoints are exact
+        std::vector<uint32_t> result(1);
+        const uint32_t top = 0xFF00FF80;
+        const uint32_t bottom = 0x00FF0000;
+        TransformKernels::BlendRows(result.data(), &top, &bottom, 1, 0);
+        CHECK(result[0] == top);
+        TransformKernels::BlendRows(result.data(), &top, &bottom, 1, 128);
+        CHECK(result[0] == 0x80808040);
+    }
+
+    SUBCASE("Bilinear rows match scalar")
+    {
+        // Arrange, one extra source pixel
+        std::vector<uint32_t> src = pattern(21, 3);
+        const std::size_t width = src.size() - 1;
+
+        for (int64_t step : { int64_t(0x4000), int64_t(0x10000), int64_t(0x2A000) }) {
+            std::size_t count = static_cast<std::size_t>((int64_t(width) << 16) / step);
+            std::vector<uint32_t> expected(count);
+            std::vector<uint32_t> result(count);
+            int64_t x = step / 2 - 0x8000;
+            TransformKernels::BilinearRowScalar(expected.data(), src.data(), width, count, x, step);
+
+            // Act
+            TransformKernels::BilinearRow(result.data(), src.data(), width, count, x, step);
+
+            // Assert
+            CHECK(result == expected);
+        }
+    }
+
+    SUBCASE("Bilinear positions are clamped")
+    {
+        // Arrange
+        const std::vector<uint32_t> src = { 0xFF000000, 0xFF0000FF, 0 };
+        std::vector<uint32_t> result(4);
+
+        // Act
+        TransformKernels::BilinearRow(result.data(), src.data(), 2, result.size(), -0x8000, 0x8000);
+
+        // Assert
+        CHECK(result == std::vector<uint32_t>{ 0xFF000000, 0xFF000000, 0xFF000080, 0xFF0000FF });
+    }
+
+    SUBCASE("Nearest row")
+    {
+        const std::vector<uint32_t> src = { 1, 2, 3 };
+        std::vector<uint32_t> result(6);
+        TransformKernels::NearestRow(result.data(), src.data(), result.size(), 0x4000, 0x8000);
+        CHECK(result == std::vector<uint32_t>{ 1, 1, 2, 2, 3, 3 });
+    }
+
+    SUBCASE("Rotation matches scalar")
+    {
+        // Sizes not multiple of the tiles or blocks, in a larger buffer
+        for (std::size_t width : { std::size_t(1), std::size_t(7), std::size_t(130) }) {
+            for (std::size_t height : { std::size_t(3), std::size_t(69) }) {
+                const std::size_t stride = 140;
+                std::vector<uint32_t> src = pattern(stride * height, 4);
+                for (unsigned turns = 0; turns < 4; turns++) {
+                    std::vector<uint32_t> expected(stride * stride, 0);
+                    std::vector<uint32_t> result(stride * stride, 0);
+                    TransformKernels::RotateScalar(expected.data(), stride, src.data(), stride, width, height, turns);
+
+                    // Act
+                    TransformKernels::Rotate(result.data(), stride, src.data(), stride, width, height, turns);
+
+                    // Assert
+                    CHECK(result == expected);
+                }
+            }
+        }
+    }
+
+    SUBCASE("Rotation directions")
+    {
+        // 1 2 3
+        // 4 5 6
+        const std::vector<uint32_t> src = { 1, 2, 3, 4, 5, 6 };
+        std::vector<uint32_t> result(6);
+        TransformKernels::RotateScalar(result.data(), 2, src.data(), 3, 3, 2, 1);
+        CHECK(result == std::vector<uint32_t>{ 4, 1, 5, 2, 6, 3 });
+        TransformKernels::RotateScalar(result.data(), 3, src.data(), 3, 3, 2, 2);
+        CHECK(result == std::vector<uint32_t>{ 6, 5, 4, 3, 2, 1 });
+        TransformKernels::RotateScalar(result.data(), 2, src.data(), 3, 3, 2, 3);
+        CHECK(result == std::vector<uint32_t>{ 3, 6, 2, 5, 1, 4 });
+    }
+}
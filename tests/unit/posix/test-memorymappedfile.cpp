@@ -0,0 +1,55 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <doctest.h>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <posix/FileIO.h>
+#include <posix/MemoryMappedFile.h>
+
+using namespace rsp::posix;
+
+TEST_CASE("Memory Mapped File") {
+    const std::string cFileName = "mapped.txt";
+    {
+        FileIO f(cFileName, std::ios_base::out | std::ios_base::trunc, 0664);
+        f.PutContents("Hello World");
+    }
+
+    SUBCASE("Map File") {
+        MemoryMappedFile m(cFileName);
+
+        CHECK(m.IsOpen());
+        CHECK(m.GetSize() == 11);
+        CHECK(std::memcmp(m.GetData(), "Hello World", 11) == 0);
+    }
+
+    SUBCASE("Move") {
+        MemoryMappedFile m(cFileName);
+        MemoryMappedFile other(std::move(m));
+
+        CHECK_FALSE(m.IsOpen());
+        CHECK(m.GetData() == nullptr);
+        CHECK(other.GetSize() == 11);
+
+        other.Close();
+        CHECK_FALSE(other.IsOpen());
+        CHECK(other.GetData() == nullptr);
+    }
+
+    SUBCASE("Missing File") {
+        MemoryMappedFile m;
+        CHECK_THROWS_AS(m.Open("no_such_file.bin"), const std::system_error &);
+        CHECK_FALSE(m.IsOpen());
+    }
+
+    std::filesystem::remove(cFileName);
+}
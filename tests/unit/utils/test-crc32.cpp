@@ -10,6 +10,7 @@
 
 #include "doctest.h"
 #include <utils/Crc32.h>
+#include <vector>
 
 TEST_CASE("CRC32") {
 
@@ -30,6 +31,27 @@ TEST_CASE("CRC32") {
         CHECK_THROWS_AS(crc.Verify(~cCorrectCRC, true), const rsp::utils::ECrcError&);
         CHECK(crc.Verify(cCorrectCRC, false));
     }
+
+    SUBCASE("Any length and alignment") {
+        std::vector<uint8_t> data(300);
+        for (std::size_t i = 0; i < data.size(); i++) {
+            data[i] = static_cast<uint8_t>(i * 131 + 7);
+        }
+        const std::size_t cLengths[] = { 0, 1, 7, 8, 9, 63, 64, 65, 291 };
+        for (std::size_t offset = 0; offset < 8; offset++) {
+            for (std::size_t length : cLengths) {
+                rsp::utils::Crc32 crc;
+                uint32_t expected = 0;
+                for (std::size_t i = 0; i < length; i++) {
+                    expected = crc.Add(data[offset + i]);
+                }
+                CHECK(rsp::utils::Crc32::Calc(data.data() + offset, length) == expected);
+            }
+        }
+        // Calculation can be continued from a previous result
+        uint32_t first = rsp::utils::Crc32::Calc(data.data(), 100);
+        CHECK(rsp::utils::Crc32::Calc(data.data() + 100, 200, first) == rsp::utils::Crc32::Calc(data.data(), 300));
+    }
 }
 
 
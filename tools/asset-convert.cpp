@@ -0,0 +1,78 @@
+/*!
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * \copyright   Copyright 2022 RSP Systems A/S. All rights reserved.
+ * \license     Mozilla Public License 2.0
+ * \author      Steffen Brummer
+ */
+
+#include <exception>
+#include <iostream>
+#include <string>
+#include <graphics/primitives/Bitmap.h>
+#include <graphics/primitives/raster/RawLoader.h>
+
+using namespace rsp::graphics;
+
+/*
+ * Convert bmp and png images to raw image assets, that are loaded
+ * by memory mapping them instead of decoding.
+ */
+
+static bool parseFormat(const std::string &arValue, BufferedCanvas::PixelFormats &arFormat)
+{
+    if (arValue == "XRGB8888") {
+        arFormat = BufferedCanvas::PixelFormats::XRGB8888;
+    }
+    else if (arValue == "RGB888") {
+        arFormat = BufferedCanvas::PixelFormats::RGB888;
+    }
+    else if (arValue == "RGB565") {
+        arFormat = BufferedCanvas::PixelFormats::RGB565;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BufferedCanvas::PixelFormats format = BufferedCanvas::PixelFormats::XRGB8888;
+    std::string input;
+    std::string output;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if ((arg == "--format") && (i + 1 < argc) && parseFormat(argv[i + 1], format)) {
+            i++;
+        }
+        else if (input.empty() && (arg.rfind("--", 0) != 0)) {
+            input = arg;
+        }
+        else if (output.empty() && (arg.rfind("--", 0) != 0)) {
+            output = arg;
+        }
+        else {
+            input.clear();
+            break;
+        }
+    }
+    if (input.empty() || output.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--format XRGB8888|RGB888|RGB565] input.bmp|input.png output.raw" << std::endl;
+        return 1;
+    }
+
+    try {
+        Bitmap bitmap(input);
+        RawLoader::Save(output, bitmap.GetPixels().data(), bitmap.GetWidth(), bitmap.GetHeight(), format);
+        std::cout << input << " -> " << output << " (" << bitmap.GetWidth() << "x" << bitmap.GetHeight() << ")" << std::endl;
+    }
+    catch (const std::exception &e) {
+        std::cerr << "Conversion of " << input << " failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}